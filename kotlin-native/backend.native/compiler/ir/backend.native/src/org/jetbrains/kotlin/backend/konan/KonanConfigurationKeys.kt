@@ -154,6 +154,8 @@ class KonanConfigKeys {
                 = CompilerConfigurationKey.create("override konan.properties values")
         val DESTROY_RUNTIME_MODE: CompilerConfigurationKey<DestroyRuntimeMode>
                 = CompilerConfigurationKey.create("when to destroy runtime")
+        val LAZY_FILE_INITIALIZATION: CompilerConfigurationKey<Boolean>
+                = CompilerConfigurationKey.create("initialize globals of a file on first access")
         val GARBAGE_COLLECTOR: CompilerConfigurationKey<GC> = CompilerConfigurationKey.create("gc")
     }
 }
@@ -468,6 +468,8 @@ internal class Llvm(val context: Context, val llvmModule: LLVMModuleRef) {
     val isInstanceOfClassFastFunction = importRtFunction("IsInstanceOfClassFast")
     val throwExceptionFunction = importRtFunction("ThrowException")
     val appendToInitalizersTail = importRtFunction("AppendToInitializersTail")
+    val callInitGlobalPossiblyLock = importRtFunction("CallInitGlobalPossiblyLock")
+    val callInitThreadLocal = importRtFunction("CallInitThreadLocal")
     val addTLSRecord = importRtFunction("AddTLSRecord")
     val lookupTLS = importRtFunction("LookupTLS")
     val initRuntimeIfNeeded = importRtFunction("Kotlin_initRuntimeIfNeeded")
@@ -578,6 +580,8 @@ internal class Llvm(val context: Context, val llvmModule: LLVMModuleRef) {
     val irStaticInitializers = mutableListOf<IrStaticInitializer>()
     val otherStaticInitializers = mutableListOf<LLVMValueRef>()
     val fileInitializers = mutableListOf<IrField>()
+    // With `-Xlazy-file-initialization`: the state words and initializers of the files, created on first use.
+    val lazyFileInitializers = mutableMapOf<IrFile, LazyFileInitializer>()
     var fileUsesThreadLocalObjects = false
     val globalSharedObjects = mutableSetOf<LLVMValueRef>()
 
@@ -622,3 +626,12 @@ internal class Llvm(val context: Context, val llvmModule: LLVMModuleRef) {
 }
 
 class IrStaticInitializer(val konanLibrary: KotlinLibrary?, val initializer: LLVMValueRef)
+
+// Globals of a file that are initialized on first access: `initializer` is passed to `CallInitGlobalPossiblyLock`
+// together with the `state` word, and `threadLocalInitializer` to `CallInitThreadLocal` with `threadLocalState`.
+class LazyFileInitializer(
+        val state: LLVMValueRef,
+        val initializer: LLVMValueRef,
+        val threadLocalState: LLVMValueRef,
+        val threadLocalInitializer: LLVMValueRef
+)
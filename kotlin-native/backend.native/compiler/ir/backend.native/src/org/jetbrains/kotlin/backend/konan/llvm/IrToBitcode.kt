@@ -323,7 +323,7 @@ internal class CodeGeneratorVisitor(val context: Context, val lifetimes: Map<IrE
         context.cAdapterGenerator.generateBindings(codegen)
     }
 
-    private fun runAndProcessInitializers(konanLibrary: KotlinLibrary?, f: () -> Unit) {
+    private fun runAndProcessInitializers(konanLibrary: KotlinLibrary?, file: IrFile?, f: () -> Unit) {
         // TODO: collect those two in one place.
         context.llvm.fileInitializers.clear()
         context.llvm.fileUsesThreadLocalObjects = false
@@ -335,8 +335,14 @@ internal class CodeGeneratorVisitor(val context: Context, val lifetimes: Map<IrE
             return
         }
 
+        val lazyInitializer = if (file != null && context.config.lazyFileInitialization && context.llvm.fileInitializers.isNotEmpty()) {
+            lazyFileInitializer(file).also { generateLazyFileInitializers(file, it) }
+        } else {
+            null
+        }
+
         // Create global initialization records.
-        val initNode = createInitNode(createInitBody())
+        val initNode = createInitNode(createInitBody(lazyInitializer))
         context.llvm.irStaticInitializers.add(IrStaticInitializer(konanLibrary, createInitCtor(initNode)))
     }
 
@@ -355,7 +361,7 @@ internal class CodeGeneratorVisitor(val context: Context, val lifetimes: Map<IrE
         initializeCachedBoxes(context)
         declaration.acceptChildrenVoid(this)
 
-        runAndProcessInitializers(null) {
+        runAndProcessInitializers(null, null) {
             // Note: it is here because it also generates some bitcode.
             context.objCExport.generate(codegen)
 
@@ -389,7 +395,75 @@ internal class CodeGeneratorVisitor(val context: Context, val lifetimes: Map<IrE
     val INIT_THREAD_LOCAL_GLOBALS = 2
     val DEINIT_GLOBALS = 3
 
-    private fun createInitBody(): LLVMValueRef {
+    private fun isStaticallyInitializable(irField: IrField, address: LLVMValueRef, initialization: LLVMValueRef) =
+            initialization.isConst &&
+                    irField.type.binaryTypeIsReference() &&
+                    irField.storageKind != FieldStorageKind.THREAD_LOCAL &&
+                    LLVMIsAGlobalVariable(address) != null &&
+                    LLVMTypeOf(initialization) == getGlobalType(address)
+
+    // Must be synchronized with Runtime.cpp
+    val FILE_NOT_INITIALIZED = 0
+    val FILE_INITIALIZED = 1
+
+    // Stores the initial values of the (not thread local) globals of the current file.
+    private fun FunctionGenerationContext.initGlobals() {
+        context.llvm.fileInitializers
+                .forEach { irField ->
+                    if (irField.storageKind != FieldStorageKind.THREAD_LOCAL) {
+                        val address = context.llvmDeclarations.forStaticField(irField).storageAddressAccess.getAddress(
+                                functionGenerationContext
+                        )
+                        var isStaticallyInitialized = false
+                        val initialValue = if (irField.initializer?.expression !is IrConst<*>?) {
+                            val initialization = evaluateExpression(irField.initializer!!.expression)
+                            if (isStaticallyInitializable(irField, address, initialization)) {
+                                // The value is a permanent object built at compile time (a `listOf` of constants,
+                                // a constant singleton, etc.): put it into the global right away, so that
+                                // it's neither frozen nor registered as a GC root at startup.
+                                // It's still stored below: `DEINIT_GLOBALS` nulls the global, and the runtime
+                                // may be initialized again after that.
+                                LLVMSetInitializer(address, initialization)
+                                isStaticallyInitialized = true
+                            } else if (irField.storageKind == FieldStorageKind.SHARED_FROZEN) {
+                                freeze(initialization, currentCodeContext.exceptionHandler)
+                            }
+                            initialization
+                        } else {
+                            null
+                        }
+                        val needRegistration =
+                                context.memoryModel == MemoryModel.EXPERIMENTAL && // only for the new MM
+                                        irField.type.binaryTypeIsReference() && // only for references
+                                        ((initialValue != null && !isStaticallyInitialized) || // which are initialized from heap object
+                                                !irField.isFinal) // or are not final
+                        if (needRegistration) {
+                            call(context.llvm.initAndRegisterGlobalFunction, listOf(address, initialValue
+                                    ?: kNullObjHeaderPtr))
+                        } else if (initialValue != null) {
+                            storeAny(initialValue, address, false)
+                        }
+                    }
+                }
+    }
+
+    // Stores the initial values of the thread local globals of the current file.
+    private fun FunctionGenerationContext.initThreadLocalGlobals() {
+        context.llvm.fileInitializers
+                .forEach { irField ->
+                    if (irField.initializer != null && irField.storageKind == FieldStorageKind.THREAD_LOCAL) {
+                        val initialization = evaluateExpression(irField.initializer!!.expression)
+                        val address = context.llvmDeclarations.forStaticField(irField).storageAddressAccess.getAddress(
+                                functionGenerationContext
+                        )
+                        storeAny(initialization, address, false)
+                    }
+                }
+    }
+
+    // With `lazyInitializer` the globals are initialized on first access instead (see `initializeFileOf`), and
+    // the init function only resets the state words, so that the runtime can be initialized again.
+    private fun createInitBody(lazyInitializer: LazyFileInitializer?): LLVMValueRef {
         val initFunction = addLlvmFunctionWithDefaultAttributes(
                 context,
                 context.llvmModule!!,
@@ -416,47 +490,16 @@ internal class CodeGeneratorVisitor(val context: Context, val lifetimes: Map<IrE
 
                 // Globals initalizers may contain accesses to objects, so visit them first.
                 appendingTo(bbInit) {
-                    context.llvm.fileInitializers
-                            .forEach { irField ->
-                                if (irField.storageKind != FieldStorageKind.THREAD_LOCAL) {
-                                    val address = context.llvmDeclarations.forStaticField(irField).storageAddressAccess.getAddress(
-                                            functionGenerationContext
-                                    )
-                                    val initialValue = if (irField.initializer?.expression !is IrConst<*>?) {
-                                        val initialization = evaluateExpression(irField.initializer!!.expression)
-                                        if (irField.storageKind == FieldStorageKind.SHARED_FROZEN)
-                                            freeze(initialization, currentCodeContext.exceptionHandler)
-                                        initialization
-                                    } else {
-                                        null
-                                    }
-                                    val needRegistration =
-                                            context.memoryModel == MemoryModel.EXPERIMENTAL && // only for the new MM
-                                                    irField.type.binaryTypeIsReference() && // only for references
-                                                    (initialValue != null || // which are initialized from heap object
-                                                            !irField.isFinal) // or are not final
-                                    if (needRegistration) {
-                                        call(context.llvm.initAndRegisterGlobalFunction, listOf(address, initialValue
-                                                ?: kNullObjHeaderPtr))
-                                    } else if (initialValue != null) {
-                                        storeAny(initialValue, address, false)
-                                    }
-                                }
-                            }
+                    if (lazyInitializer == null) {
+                        initGlobals()
+                    }
                     ret(null)
                 }
 
                 appendingTo(bbLocalInit) {
-                    context.llvm.fileInitializers
-                            .forEach { irField ->
-                                if (irField.initializer != null && irField.storageKind == FieldStorageKind.THREAD_LOCAL) {
-                                    val initialization = evaluateExpression(irField.initializer!!.expression)
-                                    val address = context.llvmDeclarations.forStaticField(irField).storageAddressAccess.getAddress(
-                                            functionGenerationContext
-                                    )
-                                    storeAny(initialization, address, false)
-                                }
-                            }
+                    if (lazyInitializer == null) {
+                        initThreadLocalGlobals()
+                    }
                     ret(null)
                 }
 
@@ -466,6 +509,10 @@ internal class CodeGeneratorVisitor(val context: Context, val lifetimes: Map<IrE
                         call(context.llvm.addTLSRecord, listOf(memory, context.llvm.tlsKey,
                                 Int32(context.llvm.tlsCount).llvm))
                     }
+                    if (lazyInitializer != null) {
+                        // The thread may have had the runtime before, with a different TLS record.
+                        store(Int32(FILE_NOT_INITIALIZED).llvm, lazyInitializer.threadLocalState)
+                    }
                     ret(null)
                 }
 
@@ -483,6 +530,9 @@ internal class CodeGeneratorVisitor(val context: Context, val lifetimes: Map<IrE
                     context.llvm.globalSharedObjects.forEach { address ->
                         storeHeapRef(codegen.kNullObjHeaderPtr, address)
                     }
+                    if (lazyInitializer != null) {
+                        store(Int32(FILE_NOT_INITIALIZED).llvm, lazyInitializer.state)
+                    }
                     ret(null)
                 }
             }
@@ -490,6 +540,86 @@ internal class CodeGeneratorVisitor(val context: Context, val lifetimes: Map<IrE
         return initFunction
     }
 
+    //-------------------------------------------------------------------------//
+
+    // The file whose lazy initializers are being generated: its globals need no init guard there.
+    private var lazilyInitializedFile: IrFile? = null
+
+    private fun lazyFileInitializer(file: IrFile) = context.llvm.lazyFileInitializers.getOrPut(file) {
+        fun stateWord(name: String) = LLVMAddGlobal(context.llvmModule, int32Type, name)!!.also {
+            LLVMSetInitializer(it, Int32(FILE_NOT_INITIALIZED).llvm)
+            LLVMSetLinkage(it, LLVMLinkage.LLVMInternalLinkage)
+        }
+        // The bodies are generated with the file, see `generateLazyFileInitializers`.
+        fun initializer() = addLlvmFunctionWithDefaultAttributes(context, context.llvmModule!!, "", kVoidFuncType).also {
+            LLVMSetLinkage(it, LLVMLinkage.LLVMPrivateLinkage)
+        }
+        LazyFileInitializer(
+                state = stateWord("state_global"),
+                initializer = initializer(),
+                threadLocalState = stateWord("state_thread_local").also { LLVMSetThreadLocalMode(it, context.llvm.tlsMode) },
+                threadLocalInitializer = initializer()
+        )
+    }
+
+    private fun generateLazyFileInitializers(file: IrFile, lazyInitializer: LazyFileInitializer) {
+        lazilyInitializedFile = file
+        try {
+            generateFunction(codegen, lazyInitializer.initializer) {
+                using(FunctionScope(lazyInitializer.initializer, "init_global", it)) {
+                    initGlobals()
+                    ret(null)
+                }
+            }
+            generateFunction(codegen, lazyInitializer.threadLocalInitializer) {
+                using(FunctionScope(lazyInitializer.threadLocalInitializer, "init_thread_local", it)) {
+                    initThreadLocalGlobals()
+                    ret(null)
+                }
+            }
+        } finally {
+            lazilyInitializedFile = null
+        }
+    }
+
+    // Whether the file initializer does anything for `irField`.
+    private fun hasInitializerCode(irField: IrField) = if (irField.storageKind == FieldStorageKind.THREAD_LOCAL) {
+        irField.initializer != null
+    } else {
+        irField.initializer?.expression !is IrConst<*>? ||
+                (context.memoryModel == MemoryModel.EXPERIMENTAL && irField.type.binaryTypeIsReference() && !irField.isFinal)
+    }
+
+    // With `-Xlazy-file-initialization`, initializes the globals of the file of `irField` before it is accessed.
+    private fun initializeFileOf(irField: IrField) {
+        if (!context.config.lazyFileInitialization || !context.needGlobalInit(irField) || !hasInitializerCode(irField)) return
+        // Globals of cached libraries are initialized by their own code.
+        if (!context.llvmModuleSpecification.containsDeclaration(irField)) return
+        val file = irField.fileOrNull ?: return
+        if (file == lazilyInitializedFile) return
+        val lazyInitializer = lazyFileInitializer(file)
+        with(functionGenerationContext) {
+            if (irField.storageKind == FieldStorageKind.THREAD_LOCAL) {
+                val state = lazyInitializer.threadLocalState
+                ifThen(icmpNe(load(state), Int32(FILE_INITIALIZED).llvm)) {
+                    call(context.llvm.callInitThreadLocal, listOf(state, lazyInitializer.threadLocalInitializer),
+                            Lifetime.IRRELEVANT, currentCodeContext.exceptionHandler)
+                }
+            } else {
+                val state = lazyInitializer.state
+                // Pairs with the release store of `FILE_INITIALIZED` by the thread that ran the initializer.
+                val stateValue = load(state).also {
+                    LLVMSetOrdering(it, LLVMAtomicOrdering.LLVMAtomicOrderingAcquire)
+                    LLVMSetAlignment(it, 4)
+                }
+                ifThen(icmpNe(stateValue, Int32(FILE_INITIALIZED).llvm)) {
+                    call(context.llvm.callInitGlobalPossiblyLock, listOf(state, lazyInitializer.initializer),
+                            Lifetime.IRRELEVANT, currentCodeContext.exceptionHandler)
+                }
+            }
+        }
+    }
+
     //-------------------------------------------------------------------------//
     // Creates static struct InitNode $nodeName = {$initName, NULL};
 
@@ -519,7 +649,7 @@ internal class CodeGeneratorVisitor(val context: Context, val lifetimes: Map<IrE
     override fun visitFile(declaration: IrFile) {
         @Suppress("UNCHECKED_CAST")
         using(FileScope(declaration)) {
-            runAndProcessInitializers(declaration.konanLibrary) {
+            runAndProcessInitializers(declaration.konanLibrary, declaration) {
                 declaration.acceptChildrenVoid(this)
             }
         }
@@ -1591,6 +1721,7 @@ internal class CodeGeneratorVisitor(val context: Context, val lifetimes: Map<IrE
                 if (context.config.threadsAreAllowed && value.symbol.owner.isGlobalNonPrimitive) {
                     functionGenerationContext.checkGlobalsAccessible(currentCodeContext.exceptionHandler)
                 }
+                initializeFileOf(value.symbol.owner)
                 val ptr = context.llvmDeclarations.forStaticField(value.symbol.owner).storageAddressAccess.getAddress(
                         functionGenerationContext
                 )
@@ -1654,6 +1785,7 @@ internal class CodeGeneratorVisitor(val context: Context, val lifetimes: Map<IrE
             functionGenerationContext.storeAny(valueToAssign, fieldPtrOfClass(thisPtr, value.symbol.owner), false)
         } else {
             assert(value.receiver == null)
+            initializeFileOf(value.symbol.owner)
             val globalAddress = context.llvmDeclarations.forStaticField(value.symbol.owner).storageAddressAccess.getAddress(
                     functionGenerationContext
             )
@@ -0,0 +1,37 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. and Kotlin Programming Language contributors.
+ * Use of this source code is governed by the Apache 2.0 license that can be found in the license/LICENSE.txt file.
+ */
+
+package codegen.objectDeclaration.globalConstantsRoots
+
+import kotlin.test.*
+import kotlin.native.internal.*
+
+object EmptyClass {}
+
+object ClassWithConstants {
+    const val A = 1
+}
+
+class ClassWithField(val x: Int)
+
+val permanentObject = EmptyClass
+val permanentObjectWithConstants = ClassWithConstants
+val heapObject = ClassWithField(1)
+var permanentObjectInVar = EmptyClass
+
+@Test fun finalPermanentGlobalsAreNotRoots() {
+    assertTrue(permanentObject.isPermanent())
+    assertFalse(permanentObject.isReferencedByGlobalRoot())
+    assertTrue(permanentObjectWithConstants.isPermanent())
+    assertFalse(permanentObjectWithConstants.isReferencedByGlobalRoot())
+}
+
+@Test fun otherGlobalsAreRoots() {
+    assertFalse(heapObject.isPermanent())
+    assertTrue(heapObject.isReferencedByGlobalRoot())
+    // May be reassigned to a heap object, so it stays registered.
+    assertTrue(permanentObjectInVar.isPermanent())
+    assertTrue(permanentObjectInVar.isReferencedByGlobalRoot())
+}
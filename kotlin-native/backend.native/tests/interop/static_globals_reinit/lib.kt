@@ -0,0 +1,14 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. and Kotlin Programming Language contributors.
+ * Use of this source code is governed by the Apache 2.0 license that can be found in the license/LICENSE.txt file.
+ */
+
+object ClassWithConstants {
+    const val A = 42
+}
+
+// With -opt, `ClassWithConstants` is a permanent object, and the global gets it statically.
+private val permanentObject = ClassWithConstants
+
+// Reads the type info of the object, which fails if the global was left null.
+fun hasPermanentObject(): Boolean = permanentObject::class == ClassWithConstants::class
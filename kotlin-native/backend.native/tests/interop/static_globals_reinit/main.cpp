@@ -0,0 +1,21 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. and Kotlin Programming Language contributors.
+ * Use of this source code is governed by the Apache 2.0 license that can be found in the license/LICENSE.txt file.
+ */
+
+#include "testlib_api.h"
+
+#include <cassert>
+#include <thread>
+
+int main() {
+    for (int i = 0; i < 2; ++i) {
+        // With the legacy destroy runtime mode, the runtime is destroyed when the thread exits, and `DEINIT_GLOBALS`
+        // nulls the globals. The second thread initializes the runtime again, and must see the same values.
+        std::thread thread([]() {
+            assert(testlib_symbols()->kotlin.root.hasPermanentObject());
+        });
+        thread.join();
+    }
+    return 0;
+}
@@ -0,0 +1,22 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+@file:OptIn(ExperimentalStdlibApi::class)
+
+import kotlin.native.internal.*
+import kotlin.native.Platform
+
+fun main() {
+    Platform.isMemoryLeakCheckerActive = true
+    Platform.isCleanersLeakCheckerActive = true
+    Shutdown.isFast = true
+    Shutdown.addHook {
+        println("hook")
+    }
+    // With the fast shutdown this cleaner is neither run nor reported by the checker.
+    createCleaner(42) {
+        println(it)
+    }
+    println("main")
+}
@@ -0,0 +1,26 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+import kotlin.native.concurrent.ThreadLocal
+
+class A(val msg: String) {
+    init {
+        println("init $msg")
+    }
+    override fun toString(): String = msg
+}
+
+val globalValue1 = A("globalValue1")
+val globalValue2 = A("globalValue2")
+
+@ThreadLocal
+val threadLocalValue = A("threadLocalValue")
+
+fun main(args: Array<String>) {
+    println("main")
+    println(globalValue1.toString())
+    println(globalValue2.toString())
+    println(threadLocalValue.toString())
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.workers.channel
+
+import kotlin.test.*
+
+import kotlin.native.concurrent.*
+
+data class Message(val value: Int)
+
+@Test fun runTest() {
+    val channel = Channel<Message>(4)
+    assertTrue(channel.trySend { Message(0) })
+    assertEquals(Message(0), channel.tryReceive())
+    assertNull(channel.tryReceive())
+
+    val workers = Array(4) { Worker.start() }
+    val consumers = workers.map { worker ->
+        worker.execute(TransferMode.SAFE, { channel }) { channel ->
+            var sum = 0
+            while (true) {
+                val message = try {
+                    channel.receive()
+                } catch (e: IllegalStateException) {
+                    break
+                }
+                sum += message.value
+            }
+            sum
+        }
+    }
+    for (i in 1..1000) {
+        assertTrue(channel.send { Message(i) })
+    }
+    channel.close()
+    assertTrue(channel.isClosed)
+    assertFalse(channel.send { Message(-1) })
+    assertEquals(500500, consumers.map { it.result }.sum())
+    workers.forEach { it.requestTermination().result }
+
+    val full = Channel<Message>(4)
+    repeat(4) { assertTrue(full.trySend { Message(it) }) }
+    assertFalse(full.trySend { Message(4) })
+    println("OK")
+}
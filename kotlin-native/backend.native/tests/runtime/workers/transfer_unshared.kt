@@ -0,0 +1,53 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.workers.transfer_unshared
+
+import kotlin.test.*
+
+import kotlin.native.concurrent.*
+import kotlin.native.internal.Debugging
+
+class Holder(var value: Any?)
+
+class Leaf(val array: ByteArray, val frozen: Any)
+
+// Checks that `block` transfers `expected` subgraphs without analyzing the heap.
+fun <T> assertExclusiveLeafTransfers(expected: Long, block: () -> T): T {
+    val before = Debugging.exclusiveLeafTransfers
+    val result = block()
+    assertEquals(expected, Debugging.exclusiveLeafTransfers - before)
+    return result
+}
+
+@Test fun runTest() {
+    // Single containers referring to nothing but frozen objects.
+    val bytes = assertExclusiveLeafTransfers(1) {
+        DetachedObjectGraph { ByteArray(10_000_000) { it.toByte() } }.attach()
+    }
+    assertEquals(10_000_000, bytes.size)
+    assertEquals(99.toByte(), bytes[99])
+    val frozen = Holder("frozen").freeze()
+    assertSame(frozen, assertExclusiveLeafTransfers(1) { DetachedObjectGraph { Holder(frozen) }.attach().value })
+
+    // Still referenced from the heap. The producers capture no reference to the leaf itself, as that's one more.
+    val frozenArray = ByteArray(10).freeze()
+    val holder = Holder(null)
+    assertExclusiveLeafTransfers(0) {
+        assertFailsWith<IllegalStateException> {
+            DetachedObjectGraph { Leaf(frozenArray, frozen).also { holder.value = it } }
+        }
+    }
+    // Not anymore, but the reference is only released later.
+    val leaf = assertExclusiveLeafTransfers(1) {
+        DetachedObjectGraph { Leaf(frozenArray, frozen).also { holder.value = it; holder.value = null } }.attach()
+    }
+    assertSame(frozenArray, leaf.array)
+
+    // Referring to other objects.
+    val graph = assertExclusiveLeafTransfers(0) { DetachedObjectGraph { Holder(Holder(ByteArray(10))) }.attach() }
+    assertEquals(10, ((graph.value as Holder).value as ByteArray).size)
+    println("OK")
+}
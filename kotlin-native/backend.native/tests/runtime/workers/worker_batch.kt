@@ -0,0 +1,38 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.workers.worker_batch
+
+import kotlin.test.*
+
+import kotlin.native.concurrent.*
+
+data class Data(val index: Int, var value: Int)
+
+@Test fun runTest() {
+    val worker = Worker.start()
+    val pool = Worker.startPool(4)
+    val multiplier = 3
+    for (target in listOf(worker, pool)) {
+        val futures = target.executeBatch(TransferMode.SAFE, 1000, { index -> Data(index, index) }) { data ->
+            data.value *= multiplier
+            data
+        }
+        assertEquals(1000, futures.size)
+        futures.forEachIndexed { index, future ->
+            future.consume { data ->
+                assertEquals(index, data.index)
+                assertEquals(index * multiplier, data.value)
+            }
+        }
+        assertTrue(target.executeBatch(TransferMode.SAFE, 0, { it }) { it }.isEmpty())
+    }
+    worker.requestTermination().result
+    pool.requestTermination().result
+    assertFailsWith<IllegalStateException> {
+        worker.executeBatch(TransferMode.SAFE, 1, { it }) { it }
+    }
+    println("OK")
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.workers.worker_cancel_delayed
+
+import kotlin.test.*
+
+import kotlin.native.concurrent.*
+
+@SharedImmutable
+val executed = AtomicInt(0)
+
+@Test fun runTest() {
+    val worker = Worker.start()
+    val pool = Worker.startPool(2)
+    for (target in listOf(worker, pool)) {
+        executed.value = 0
+        val cancelled = target.executeAfterCancellable(10_000_000, { executed.increment() }.freeze())
+        val kept = target.executeAfterCancellable(10_000, { executed.increment() }.freeze())
+        assertTrue(target.cancelDelayed(cancelled))
+        // Cannot be cancelled twice.
+        assertFalse(target.cancelDelayed(cancelled))
+        while (executed.value == 0) {
+        }
+        // Already executed.
+        assertFalse(target.cancelDelayed(kept))
+        assertEquals(1, executed.value)
+        assertFailsWith<IllegalStateException> {
+            target.executeAfterCancellable(1, { executed.increment() })
+        }
+    }
+    worker.requestTermination().result
+    pool.requestTermination().result
+    println("OK")
+}
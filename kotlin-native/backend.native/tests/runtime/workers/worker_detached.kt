@@ -0,0 +1,30 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.workers.worker_detached
+
+import kotlin.test.*
+
+import kotlin.native.concurrent.*
+
+data class Data(val value: Int)
+
+@Test fun runTest() {
+    val worker = Worker.start(errorReporting = false)
+    val sum = AtomicInt(0)
+    for (i in 1..100) {
+        worker.executeDetached(TransferMode.SAFE, { Data(i) }) { data ->
+            sum.addAndGet(data.value)
+        }
+    }
+    // Exceptions don't stop the worker.
+    worker.executeDetached(TransferMode.SAFE, { Unit }) { throw Error("Unexpected") }
+    worker.requestTermination().result
+    assertEquals(5050, sum.value)
+    assertFailsWith<IllegalStateException> {
+        worker.executeDetached(TransferMode.SAFE, { Unit }) {}
+    }
+    println("OK")
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.workers.worker_park_fd
+
+import kotlin.test.*
+
+import kotlin.native.concurrent.*
+import kotlinx.cinterop.*
+import platform.posix.*
+
+fun writeByte(fd: Int) = memScoped {
+    val byte = alloc<ByteVar>()
+    assertEquals(1L, write(fd, byte.ptr, 1.convert()).toLong())
+}
+
+fun readByte(fd: Int) = memScoped {
+    val byte = alloc<ByteVar>()
+    assertEquals(1L, read(fd, byte.ptr, 1.convert()).toLong())
+}
+
+@Test fun runTest() {
+    val (readFd, writeFd) = memScoped {
+        val fds = allocArray<IntVar>(2)
+        assertEquals(0, pipe(fds))
+        fds[0] to fds[1]
+    }
+    val current = Worker.current
+    // Not supported on this platform.
+    if (!current.watchFileDescriptor(readFd)) {
+        println("OK")
+        return
+    }
+
+    // Nothing to read yet.
+    assertFalse(current.park(1_000))
+    assertEquals(0, current.readyFileDescriptors.size)
+
+    withWorker {
+        executeAfter(1_000, { writeByte(writeFd) }.freeze())
+        assertTrue(current.park(10_000_000, process = true))
+        assertEquals(listOf(readFd), current.readyFileDescriptors.toList())
+        readByte(readFd)
+
+        // Jobs still wake up the parked worker.
+        val counter = AtomicInt(0)
+        executeAfter(1_000, { current.executeAfter(0, { counter.increment() }.freeze()) }.freeze())
+        while (counter.value == 0) {
+            current.park(10_000_000, process = true)
+        }
+        assertEquals(0, current.readyFileDescriptors.size)
+    }
+
+    assertTrue(current.unwatchFileDescriptor(readFd))
+    assertFalse(current.unwatchFileDescriptor(readFd))
+    writeByte(writeFd)
+    assertFalse(current.park(1_000))
+    close(readFd)
+    close(writeFd)
+    println("OK")
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.workers.worker_pool
+
+import kotlin.test.*
+
+import kotlin.native.concurrent.*
+
+data class Data(val index: Int, var value: Int)
+
+@Test fun runTest() {
+    val pool = Worker.startPool(4, name = "pool")
+    assertEquals("pool", pool.name)
+    val futures = Array(1000) { index ->
+        pool.execute(TransferMode.SAFE, { Data(index, index) }) { data ->
+            data.value *= 2
+            data
+        }
+    }
+    futures.forEachIndexed { index, future ->
+        future.consume { data ->
+            assertEquals(index, data.index)
+            assertEquals(index * 2, data.value)
+        }
+    }
+
+    val counter = AtomicInt(0)
+    repeat(100) {
+        pool.executeAfter(0, { counter.increment() }.freeze())
+    }
+    pool.requestTermination().result
+    assertEquals(100, counter.value)
+    assertFailsWith<IllegalStateException> {
+        pool.execute(TransferMode.SAFE, { null }) { it }
+    }
+    println("OK")
+}
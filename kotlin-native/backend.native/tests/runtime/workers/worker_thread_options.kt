@@ -0,0 +1,24 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.workers.worker_thread_options
+
+import kotlin.test.*
+
+import kotlin.native.concurrent.*
+
+fun depth(n: Int): Int = if (n == 0) 0 else depth(n - 1) + 1
+
+@Test fun runTest() {
+    // Lowering the priority is allowed without privileges.
+    val options = WorkerThreadOptions(stackSize = 64L * 1024 * 1024, priority = 10, threadName = "options-test")
+    val worker = Worker.start(name = "worker", threadOptions = options)
+    assertEquals("worker", worker.name)
+    // Too deep for the default stack size of secondary threads on some platforms.
+    val future = worker.execute(TransferMode.SAFE, { 100000 }) { depth(it) }
+    assertEquals(100000, future.result)
+    worker.requestTermination().result
+    println("OK")
+}
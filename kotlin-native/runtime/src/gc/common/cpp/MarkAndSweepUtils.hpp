@@ -11,6 +11,7 @@
 #include "Memory.h"
 #include "ObjectTraversal.hpp"
 #include "Runtime.h"
+#include "SoftReferenceRegistry.hpp"
 #include "Types.h"
 
 namespace kotlin {
@@ -24,7 +25,6 @@ void Mark(KStdVector<ObjHeader*> graySet) noexcept {
         graySet.pop_back();
 
         RuntimeAssert(!isNullOrMarker(top), "Got invalid reference %p in gray set", top);
-        RuntimeAssert(!top->local(), "TODO: Stack objects are not supported yet, top=%p", top);
 
         if (top->heap()) {
             if (!Traits::TryMark(top)) {
@@ -32,7 +32,8 @@ void Mark(KStdVector<ObjHeader*> graySet) noexcept {
             }
         }
 
-        if (!top->permanent()) {
+        // Local (arena) objects are roots themselves, so they get here exactly once and are never pushed as fields.
+        if (!top->permanent() || top->local()) {
             traverseReferredObjects(top, [&graySet](ObjHeader* field) noexcept {
                 if (!isNullOrMarker(field) && !field->permanent() && !Traits::IsMarked(field)) {
                     graySet.push_back(field);
@@ -45,23 +46,85 @@ void Mark(KStdVector<ObjHeader*> graySet) noexcept {
             if (!isNullOrMarker(weakCounter)) {
                 graySet.push_back(weakCounter);
             }
+            auto* softCounter = *extraObjectData->GetSoftCounterLocation();
+            if (!isNullOrMarker(softCounter)) {
+                graySet.push_back(softCounter);
+            }
         }
     }
 }
 
+// Decides which softly reachable objects survive a collection. While the heap is below `thresholdBytes`
+// all of them are retained. Above the threshold an object is retained only if its soft reference was
+// dereferenced recently enough. The allowed idle time shrinks as the heap grows, so the least recently used
+// objects are the first to go.
+class SoftReferencePolicy {
+public:
+    SoftReferencePolicy(size_t heapBytes, size_t thresholdBytes, uint64_t maxIdleMillis, int64_t nowMillis) noexcept :
+        retainAll_(heapBytes < thresholdBytes), nowMillis_(nowMillis) {
+        if (!retainAll_) {
+            double scale = heapBytes == 0 ? 1.0 : static_cast<double>(thresholdBytes) / static_cast<double>(heapBytes);
+            allowedIdleMillis_ = static_cast<int64_t>(static_cast<double>(maxIdleMillis) * scale);
+        }
+    }
+
+    bool ShouldRetain(int64_t lastAccessMillis) const noexcept {
+        return retainAll_ || nowMillis_ - lastAccessMillis <= allowedIdleMillis_;
+    }
+
+private:
+    bool retainAll_;
+    int64_t nowMillis_;
+    int64_t allowedIdleMillis_ = 0;
+};
+
+// Must be called after `Mark`. Marks softly reachable objects that `policy` decides to retain, and drops
+// registry entries for the soft references that will be cleared or collected by the following `Sweep`.
 template <typename Traits>
-typename Traits::ObjectFactory::FinalizerQueue Sweep(typename Traits::ObjectFactory& objectFactory) noexcept {
+void MarkSoftReferences(mm::SoftReferenceRegistry& registry, const SoftReferencePolicy& policy) noexcept {
+    auto counters = registry.Iter();
+    // A retained object may make more soft references reachable, so repeat until nothing new gets marked.
+    // Chains of soft references are expected to be short, so this terminates in a couple of passes.
+    while (true) {
+        KStdVector<ObjHeader*> graySet;
+        for (auto* counter : counters) {
+            if (!Traits::IsMarked(counter)) continue;
+            auto* referred = mm::SoftReferenceCounterReferred(counter);
+            if (referred == nullptr || Traits::IsMarked(referred)) continue;
+            if (policy.ShouldRetain(mm::SoftReferenceCounterLastAccessMillis(counter))) {
+                graySet.push_back(referred);
+            }
+        }
+        if (graySet.empty()) break;
+        Mark<Traits>(std::move(graySet));
+    }
+    counters.EraseIf([](ObjHeader* counter) noexcept {
+        if (!Traits::IsMarked(counter)) return true;
+        auto* referred = mm::SoftReferenceCounterReferred(counter);
+        return referred == nullptr || !Traits::IsMarked(referred);
+    });
+}
+
+// If `aliveBytes` is not null, it receives the total size of the objects that survived the sweep.
+template <typename Traits>
+typename Traits::ObjectFactory::FinalizerQueue Sweep(
+        typename Traits::ObjectFactory& objectFactory, size_t* aliveBytes = nullptr) noexcept {
     typename Traits::ObjectFactory::FinalizerQueue finalizerQueue;
+    size_t alive = 0;
 
     auto iter = objectFactory.Iter();
     for (auto it = iter.begin(); it != iter.end();) {
         if (Traits::TryResetMark(*it)) {
+            if (aliveBytes) {
+                alive += it->AllocatedDataSize();
+            }
             ++it;
             continue;
         }
         auto* objHeader = it->IsArray() ? it->GetArrayHeader()->obj() : it->GetObjHeader();
         if (auto* extraObject = mm::ExtraObjectData::Get(objHeader)) {
             extraObject->ClearWeakReferenceCounter();
+            extraObject->ClearSoftReferenceCounter();
         }
         if (HasFinalizers(objHeader)) {
             iter.MoveAndAdvance(finalizerQueue, it);
@@ -70,6 +133,9 @@ typename Traits::ObjectFactory::FinalizerQueue Sweep(typename Traits::ObjectFact
         }
     }
 
+    if (aliveBytes) {
+        *aliveBytes = alive;
+    }
     return finalizerQueue;
 }
 
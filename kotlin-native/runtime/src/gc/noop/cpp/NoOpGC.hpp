@@ -6,8 +6,11 @@
 #ifndef RUNTIME_GC_NOOP_NOOP_GC_H
 #define RUNTIME_GC_NOOP_NOOP_GC_H
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 
+#include "Common.h"
 #include "Utils.hpp"
 
 namespace kotlin {
@@ -23,19 +26,58 @@ public:
     public:
         using ObjectData = NoOpGC::ObjectData;
 
-        explicit ThreadData(NoOpGC& gc) noexcept {}
-        ~ThreadData() = default;
+        explicit ThreadData(NoOpGC& gc) noexcept : gc_(gc) {}
+        ~ThreadData() { FlushAllocatedBytes(); }
 
         void SafePointFunctionEpilogue() noexcept {}
         void SafePointLoopBody() noexcept {}
         void SafePointExceptionUnwind() noexcept {}
-        void SafePointAllocation(size_t size) noexcept {}
+        // Allocations are counted locally and published to the shared counter in chunks, so that
+        // threads do not contend on it on every allocation.
+        ALWAYS_INLINE void SafePointAllocation(size_t size) noexcept {
+            pendingAllocatedBytes_ += size;
+            if (pendingAllocatedBytes_ >= kAllocatedBytesFlushThreshold) {
+                FlushAllocatedBytes();
+            }
+        }
+
+        void SafePointExternalAllocation(size_t size) noexcept {
+            gc_.externalBytes_.fetch_add(size, std::memory_order_relaxed);
+            externalAllocatedBytes_ += size;
+        }
+        void OnExternalFree(size_t size) noexcept {
+            gc_.externalBytes_.fetch_sub(size, std::memory_order_relaxed);
+            externalFreedBytes_ += size;
+        }
+        // Nothing is batched: there are no collections to schedule.
+        void FlushExternalBytes() noexcept {}
 
         void PerformFullGC() noexcept {}
 
         void OnOOM(size_t size) noexcept {}
 
+        // Forgets everything about the current thread, when `mm::ThreadData` is pooled for another one.
+        void Reset() noexcept {
+            FlushAllocatedBytes();
+            externalAllocatedBytes_ = 0;
+            externalFreedBytes_ = 0;
+        }
+
+        uint64_t externalAllocatedBytes() const noexcept { return externalAllocatedBytes_; }
+        uint64_t externalFreedBytes() const noexcept { return externalFreedBytes_; }
+
     private:
+        static constexpr size_t kAllocatedBytesFlushThreshold = 64 * 1024;
+
+        void FlushAllocatedBytes() noexcept {
+            gc_.allocatedBytes_.fetch_add(pendingAllocatedBytes_, std::memory_order_relaxed);
+            pendingAllocatedBytes_ = 0;
+        }
+
+        NoOpGC& gc_;
+        size_t pendingAllocatedBytes_ = 0;
+        uint64_t externalAllocatedBytes_ = 0;
+        uint64_t externalFreedBytes_ = 0;
     };
 
     NoOpGC() noexcept {}
@@ -50,10 +92,29 @@ public:
     void SetAutoTune(bool value) noexcept { autoTune_ = value; }
     bool GetAutoTune() noexcept { return autoTune_; }
 
+    void SetSoftReferencesThresholdBytes(size_t value) noexcept { softReferencesThresholdBytes_ = value; }
+    size_t GetSoftReferencesThresholdBytes() noexcept { return softReferencesThresholdBytes_; }
+
+    void SetSoftReferencesMaxIdleMillis(uint64_t value) noexcept { softReferencesMaxIdleMillis_ = value; }
+    uint64_t GetSoftReferencesMaxIdleMillis() noexcept { return softReferencesMaxIdleMillis_; }
+
+    void SetHeapLimitBytes(size_t value) noexcept { heapLimitBytes_ = value; }
+    size_t GetHeapLimitBytes() noexcept { return heapLimitBytes_; }
+
+    size_t GetExternalBytes() noexcept { return externalBytes_.load(std::memory_order_relaxed); }
+
+    // Nothing is ever freed, so this is everything allocated so far (up to the bytes that threads have not published yet).
+    size_t GetHeapBytesEstimate() noexcept { return allocatedBytes_.load(std::memory_order_relaxed) + GetExternalBytes(); }
+
 private:
     size_t threshold_ = 0;
     size_t allocationThresholdBytes_ = 0;
     bool autoTune_ = false;
+    size_t softReferencesThresholdBytes_ = 0;
+    uint64_t softReferencesMaxIdleMillis_ = 0;
+    std::atomic<size_t> allocatedBytes_ = 0;
+    std::atomic<size_t> externalBytes_ = 0;
+    size_t heapLimitBytes_ = 0;
 };
 
 } // namespace gc
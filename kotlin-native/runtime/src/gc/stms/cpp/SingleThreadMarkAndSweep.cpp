@@ -5,11 +5,17 @@
 
 #include "SingleThreadMarkAndSweep.hpp"
 
+#include <algorithm>
+#include <limits>
+
 #include "GlobalData.hpp"
 #include "MarkAndSweepUtils.hpp"
 #include "Memory.h"
+#include "Porting.h"
 #include "RootSet.hpp"
 #include "Runtime.h"
+#include "Scavenger.hpp"
+#include "SoftReferenceRegistry.hpp"
 #include "ThreadData.hpp"
 #include "ThreadRegistry.hpp"
 
@@ -46,6 +52,11 @@ struct FinalizeTraits {
     using ObjectFactory = mm::ObjectFactory<gc::SingleThreadMarkAndSweep>;
 };
 
+// After a collection the heap must be below this fraction of the limit (in percent)...
+constexpr size_t kHeapLimitEmergencyPercent = 90;
+// ... otherwise after this many collections in a row the GC is considered thrashing.
+constexpr size_t kHeapLimitThrashingCollections = 5;
+
 } // namespace
 
 void gc::SingleThreadMarkAndSweep::ThreadData::SafePointFunctionEpilogue() noexcept {
@@ -69,16 +80,35 @@ void gc::SingleThreadMarkAndSweep::ThreadData::SafePointExceptionUnwind() noexce
     ++safePointsCounter_;
 }
 
-void gc::SingleThreadMarkAndSweep::ThreadData::SafePointAllocation(size_t size) noexcept {
-    size_t allocationOverhead =
-            gc_.GetAllocationThresholdBytes() == 0 ? allocatedBytes_ : allocatedBytes_ % gc_.GetAllocationThresholdBytes();
-    if (allocationOverhead + size >= gc_.GetAllocationThresholdBytes()) {
-        PerformFullGC();
-    }
-    allocatedBytes_ += size;
+void gc::SingleThreadMarkAndSweep::ThreadData::SafePointAllocationSlowPath(size_t size) noexcept {
+    CountAllocation(size);
+    gc_.allocatedBytesSinceLastGC_ += size;
+    RefillAllocationBudget();
+}
+
+void gc::SingleThreadMarkAndSweep::ThreadData::SafePointExternalAllocationSlowPath(size_t size) noexcept {
+    // Account before a possible collection, so that the heap estimate already includes this memory.
+    FlushExternalBytes();
+    CountAllocation(size);
+    RefillAllocationBudget();
+}
+
+void gc::SingleThreadMarkAndSweep::ThreadData::FlushExternalBytes() noexcept {
+    if (pendingExternalBytes_ == 0) return;
+    int64_t delta = pendingExternalBytes_;
+    pendingExternalBytes_ = 0;
+    size_t current = gc_.externalBytes_.load(std::memory_order_relaxed);
+    size_t updated;
+    do {
+        // Frees may be flushed before the allocations they match, while those are still batched on another thread.
+        updated = delta >= 0 ? current + static_cast<size_t>(delta) : current - std::min(current, static_cast<size_t>(-delta));
+    } while (!gc_.externalBytes_.compare_exchange_weak(current, updated, std::memory_order_relaxed));
+    // The heap limit trigger of every thread depends on the external memory.
+    gc_.InvalidateAllocationBudgets();
 }
 
 void gc::SingleThreadMarkAndSweep::ThreadData::PerformFullGC() noexcept {
+    FlushExternalBytes();
     gc_.PerformFullGC();
 }
 
@@ -86,6 +116,35 @@ void gc::SingleThreadMarkAndSweep::ThreadData::OnOOM(size_t size) noexcept {
     PerformFullGC();
 }
 
+void gc::SingleThreadMarkAndSweep::ThreadData::Reset() noexcept {
+    allocatedBytes_ = 0;
+    // Epoch 0 is never current, so the next allocation refills the budget.
+    allocationBudget_ = 0;
+    allocationBudgetEpoch_ = 0;
+    safePointsCounter_ = 0;
+    externalAllocatedBytes_ = 0;
+    externalFreedBytes_ = 0;
+    FlushExternalBytes();
+}
+
+void gc::SingleThreadMarkAndSweep::ThreadData::CountAllocation(size_t size) noexcept {
+    size_t allocationOverhead =
+            gc_.GetAllocationThresholdBytes() == 0 ? allocatedBytes_ : allocatedBytes_ % gc_.GetAllocationThresholdBytes();
+    if (allocationOverhead + size >= gc_.GetAllocationThresholdBytes() || gc_.ShouldCollectForHeapLimit(size)) {
+        PerformFullGC();
+    }
+    allocatedBytes_ += size;
+}
+
+void gc::SingleThreadMarkAndSweep::ThreadData::RefillAllocationBudget() noexcept {
+    // Mirrors the conditions in `CountAllocation`: an allocation of `size` bytes does not trigger the collection
+    // as long as `size < allocationBudget_`.
+    size_t threshold = gc_.GetAllocationThresholdBytes();
+    size_t thresholdBudget = threshold == 0 ? 0 : threshold - allocatedBytes_ % threshold;
+    allocationBudget_ = std::min(thresholdBudget, gc_.HeapLimitAllocationBudget());
+    allocationBudgetEpoch_ = gc_.allocationBudgetEpoch_.load(std::memory_order_relaxed);
+}
+
 void gc::SingleThreadMarkAndSweep::PerformFullGC() noexcept {
     RuntimeAssert(running_ == false, "Cannot have been called during another collection");
     running_ = true;
@@ -107,12 +166,56 @@ void gc::SingleThreadMarkAndSweep::PerformFullGC() noexcept {
     }
 
     gc::Mark<MarkTraits>(std::move(graySet));
-    auto finalizerQueue = gc::Sweep<SweepTraits>(mm::GlobalData::Instance().objectFactory());
+    gc::SoftReferencePolicy softReferencePolicy(
+            GetHeapBytesEstimate(), softReferencesThresholdBytes_, softReferencesMaxIdleMillis_,
+            static_cast<int64_t>(konan::getTimeMillis()));
+    gc::MarkSoftReferences<MarkTraits>(mm::SoftReferenceRegistry::Instance(), softReferencePolicy);
+    auto finalizerQueue = gc::Sweep<SweepTraits>(mm::GlobalData::Instance().objectFactory(), &aliveBytesAfterLastGC_);
+    allocatedBytesSinceLastGC_ = 0;
+    InvalidateAllocationBudgets();
+    if (heapLimitBytes_ != 0 && GetHeapBytesEstimate() >= heapLimitBytes_ / 100 * kHeapLimitEmergencyPercent) {
+        OnCollectionNearHeapLimit();
+    } else {
+        collectionsNearHeapLimit_ = 0;
+    }
 
     running_ = false;
 
     // TODO: These will actually need to be run on a separate thread.
     // TODO: This probably should check for the existence of runtime itself, but unit tests initialize only memory.
-    RuntimeAssert(mm::ThreadRegistry::Instance().CurrentThreadData() != nullptr, "Finalizers need a Kotlin runtime");
+    auto* threadData = mm::ThreadRegistry::Instance().CurrentThreadData();
+    RuntimeAssert(threadData != nullptr, "Finalizers need a Kotlin runtime");
     finalizerQueue.Finalize();
+
+    ScavengeAfterCollection();
+    // Objects are allocated from per-thread heaps: if the scavenger ran, the collecting thread returns
+    // the memory of its own heap right away, other threads do it at their next safe point.
+    threadData->SafePointScavenge();
+}
+
+bool gc::SingleThreadMarkAndSweep::ShouldCollectForHeapLimit(size_t size) noexcept {
+    return size >= HeapLimitAllocationBudget();
+}
+
+size_t gc::SingleThreadMarkAndSweep::HeapLimitAllocationBudget() noexcept {
+    if (heapLimitBytes_ == 0) return std::numeric_limits<size_t>::max();
+    size_t aliveBytes = aliveBytesAfterLastGC_ + GetExternalBytes();
+    size_t headroom = aliveBytes < heapLimitBytes_ ? heapLimitBytes_ - aliveBytes : 0;
+    // Allow allocating half of the remaining headroom between collections: the closer the live heap
+    // is to the limit, the more often the collection runs. Past the limit collect after every percent
+    // of it, rather than on each allocation.
+    size_t allowance = std::max(headroom / 2, heapLimitBytes_ / 100);
+    return allowance > allocatedBytesSinceLastGC_ ? allowance - allocatedBytesSinceLastGC_ : 0;
+}
+
+void gc::SingleThreadMarkAndSweep::OnCollectionNearHeapLimit() noexcept {
+    // Whatever the sweep has freed is of no use if the process gets killed for its RSS.
+    ScavengeNow();
+    ++collectionsNearHeapLimit_;
+    if (collectionsNearHeapLimit_ == kHeapLimitThrashingCollections) {
+        konan::consoleErrorf(
+                "Kotlin heap is still at %zu bytes of its %zu bytes limit after %zu collections in a row. "
+                "The collector is thrashing, consider raising the limit (kotlin.native.internal.GC.heapLimit).\n",
+                GetHeapBytesEstimate(), heapLimitBytes_, collectionsNearHeapLimit_);
+    }
 }
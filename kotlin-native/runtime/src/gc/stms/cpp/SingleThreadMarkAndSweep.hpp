@@ -6,7 +6,9 @@
 #ifndef RUNTIME_GC_STMS_SINGLE_THREAD_MARK_AND_SWEEP_H
 #define RUNTIME_GC_STMS_SINGLE_THREAD_MARK_AND_SWEEP_H
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 
 #include "Types.h"
 #include "Utils.hpp"
@@ -37,21 +39,77 @@ public:
         using ObjectData = SingleThreadMarkAndSweep::ObjectData;
 
         explicit ThreadData(SingleThreadMarkAndSweep& gc) noexcept : gc_(gc) {}
-        ~ThreadData() = default;
+        ~ThreadData() { FlushExternalBytes(); }
 
         void SafePointFunctionEpilogue() noexcept;
         void SafePointLoopBody() noexcept;
         void SafePointExceptionUnwind() noexcept;
-        void SafePointAllocation(size_t size) noexcept;
+
+        // Allocations within the thread's budget only need a couple of additions. The budget is the
+        // number of bytes that can be allocated before any of the collection triggers may fire.
+        ALWAYS_INLINE void SafePointAllocation(size_t size) noexcept {
+            // Relaxed: a stale epoch only delays the budget recomputation until the next allocation.
+            if (size < allocationBudget_ && allocationBudgetEpoch_ == gc_.allocationBudgetEpoch_.load(std::memory_order_relaxed)) {
+                allocationBudget_ -= size;
+                allocatedBytes_ += size;
+                gc_.allocatedBytesSinceLastGC_ += size;
+                return;
+            }
+            SafePointAllocationSlowPath(size);
+        }
+
+        // Native memory owned by Kotlin objects (e.g. released by a `Cleaner`). Counts towards
+        // the allocation threshold just like the heap allocations do. Reports are batched per thread:
+        // the global counter only changes once the batch reaches `kExternalBytesBatchSize`.
+        ALWAYS_INLINE void SafePointExternalAllocation(size_t size) noexcept {
+            externalAllocatedBytes_ += size;
+            pendingExternalBytes_ += static_cast<int64_t>(size);
+            if (size < allocationBudget_ && pendingExternalBytes_ < kExternalBytesBatchSize &&
+                allocationBudgetEpoch_ == gc_.allocationBudgetEpoch_.load(std::memory_order_relaxed)) {
+                allocationBudget_ -= size;
+                allocatedBytes_ += size;
+                return;
+            }
+            SafePointExternalAllocationSlowPath(size);
+        }
+        ALWAYS_INLINE void OnExternalFree(size_t size) noexcept {
+            externalFreedBytes_ += size;
+            pendingExternalBytes_ -= static_cast<int64_t>(size);
+            if (pendingExternalBytes_ <= -kExternalBytesBatchSize) {
+                FlushExternalBytes();
+            }
+        }
+        // Publishes the current batch of external reports to `SingleThreadMarkAndSweep::GetExternalBytes`.
+        void FlushExternalBytes() noexcept;
 
         void PerformFullGC() noexcept;
 
         void OnOOM(size_t size) noexcept;
 
+        // Forgets everything about the current thread, when `mm::ThreadData` is pooled for another one.
+        void Reset() noexcept;
+
+        uint64_t externalAllocatedBytes() const noexcept { return externalAllocatedBytes_; }
+        uint64_t externalFreedBytes() const noexcept { return externalFreedBytes_; }
+
     private:
+        static constexpr int64_t kExternalBytesBatchSize = 64 * 1024;
+
+        NO_INLINE void SafePointAllocationSlowPath(size_t size) noexcept;
+        NO_INLINE void SafePointExternalAllocationSlowPath(size_t size) noexcept;
+        void CountAllocation(size_t size) noexcept;
+        void RefillAllocationBudget() noexcept;
+
         SingleThreadMarkAndSweep& gc_;
         size_t allocatedBytes_ = 0;
+        size_t allocationBudget_ = 0;
+        // The budget is only valid while it matches `SingleThreadMarkAndSweep::allocationBudgetEpoch_`.
+        size_t allocationBudgetEpoch_ = 0;
         size_t safePointsCounter_ = 0;
+        uint64_t externalAllocatedBytes_ = 0;
+        uint64_t externalFreedBytes_ = 0;
+        // Reported but not yet added to `SingleThreadMarkAndSweep::externalBytes_`. Negative when frees prevail.
+        int64_t pendingExternalBytes_ = 0;
     };
 
     SingleThreadMarkAndSweep() noexcept {}
@@ -60,20 +118,64 @@ public:
     void SetThreshold(size_t value) noexcept { threshold_ = value; }
     size_t GetThreshold() noexcept { return threshold_; }
 
-    void SetAllocationThresholdBytes(size_t value) noexcept { allocationThresholdBytes_ = value; }
+    void SetAllocationThresholdBytes(size_t value) noexcept {
+        allocationThresholdBytes_ = value;
+        InvalidateAllocationBudgets();
+    }
     size_t GetAllocationThresholdBytes() noexcept { return allocationThresholdBytes_; }
 
     void SetAutoTune(bool value) noexcept { autoTune_ = value; }
     bool GetAutoTune() noexcept { return autoTune_; }
 
+    void SetSoftReferencesThresholdBytes(size_t value) noexcept { softReferencesThresholdBytes_ = value; }
+    size_t GetSoftReferencesThresholdBytes() noexcept { return softReferencesThresholdBytes_; }
+
+    void SetSoftReferencesMaxIdleMillis(uint64_t value) noexcept { softReferencesMaxIdleMillis_ = value; }
+    uint64_t GetSoftReferencesMaxIdleMillis() noexcept { return softReferencesMaxIdleMillis_; }
+
+    // Soft limit on the heap size, including native memory reported by the threads; 0 means no limit.
+    // The closer the heap gets to the limit, the more often the collection runs.
+    void SetHeapLimitBytes(size_t value) noexcept {
+        heapLimitBytes_ = value;
+        InvalidateAllocationBudgets();
+    }
+    size_t GetHeapLimitBytes() noexcept { return heapLimitBytes_; }
+
+    // Native memory reported by all threads and not freed yet, up to the unflushed batches of the threads.
+    size_t GetExternalBytes() noexcept { return externalBytes_.load(std::memory_order_relaxed); }
+
+    // Objects that survived the last collection plus everything allocated since, including native memory.
+    size_t GetHeapBytesEstimate() noexcept { return aliveBytesAfterLastGC_ + allocatedBytesSinceLastGC_ + GetExternalBytes(); }
+
 private:
     void PerformFullGC() noexcept;
+    bool ShouldCollectForHeapLimit(size_t size) noexcept;
+    // Bytes that can be allocated before `ShouldCollectForHeapLimit` triggers.
+    size_t HeapLimitAllocationBudget() noexcept;
+    // Makes every thread recompute its allocation budget on the next allocation.
+    // Can be called from any thread.
+    void InvalidateAllocationBudgets() noexcept { allocationBudgetEpoch_.fetch_add(1, std::memory_order_relaxed); }
+    void OnCollectionNearHeapLimit() noexcept;
 
     bool running_ = false;
 
     size_t threshold_ = 1000;
     size_t allocationThresholdBytes_ = 10000;
     bool autoTune_ = false;
+
+    size_t softReferencesThresholdBytes_ = 64 * 1024 * 1024;
+    uint64_t softReferencesMaxIdleMillis_ = 60 * 1000;
+
+    size_t aliveBytesAfterLastGC_ = 0;
+    size_t allocatedBytesSinceLastGC_ = 0;
+    // Can be updated by threads that do not hold the GC (e.g. when a `Cleaner` frees native memory).
+    std::atomic<size_t> externalBytes_ = 0;
+
+    size_t heapLimitBytes_ = 0;
+    // Starts at 1, so that fresh threads always take the slow path first.
+    std::atomic<size_t> allocationBudgetEpoch_ = 1;
+    // Consecutive collections that could not bring the heap sufficiently below the limit.
+    size_t collectionsNearHeapLimit_ = 0;
 };
 
 } // namespace gc
@@ -5,6 +5,8 @@
 
 #include "SingleThreadMarkAndSweep.hpp"
 
+#include <limits>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -13,6 +15,9 @@
 #include "GlobalData.hpp"
 #include "ObjectOps.hpp"
 #include "ObjectTestSupport.hpp"
+#include "Porting.h"
+#include "Scavenger.hpp"
+#include "SoftReferenceRegistry.hpp"
 #include "TestSupport.hpp"
 #include "ThreadData.hpp"
 
@@ -46,9 +51,19 @@ struct WeakCounterPayload {
 
 using WeakCounter = test_support::Object<WeakCounterPayload>;
 
+struct SoftCounterPayload {
+    void* referred;
+    KLong lastAccessMillis;
+
+    static constexpr std::array<ObjHeader * SoftCounterPayload::*, 0> kFields{};
+};
+
+using SoftCounter = test_support::Object<SoftCounterPayload>;
+
 test_support::TypeInfoHolder typeHolder{test_support::TypeInfoHolder::ObjectBuilder<Payload>()};
 test_support::TypeInfoHolder typeHolderWithFinalizer{test_support::TypeInfoHolder::ObjectBuilder<Payload>().addFlag(TF_HAS_FINALIZER)};
 test_support::TypeInfoHolder typeHolderWeakCounter{test_support::TypeInfoHolder::ObjectBuilder<WeakCounterPayload>()};
+test_support::TypeInfoHolder typeHolderSoftCounter{test_support::TypeInfoHolder::ObjectBuilder<SoftCounterPayload>()};
 
 // TODO: Clean GlobalObjectHolder after it's gone.
 class GlobalObjectHolder : private Pinned {
@@ -64,7 +79,7 @@ public:
     test_support::Object<Payload>& operator->() { return test_support::Object<Payload>::FromObjHeader(location_); }
 
 private:
-    ObjHeader* location_;
+    ObjHeader* location_ = nullptr;
 };
 
 // TODO: Clean GlobalPermanentObjectHolder after it's gone.
@@ -102,7 +117,7 @@ public:
     ObjHeader*& operator[](size_t index) noexcept { return (**this).elements()[index]; }
 
 private:
-    ObjHeader* location_;
+    ObjHeader* location_ = nullptr;
 };
 
 // TODO: Clean GlobalCharArrayHolder after it's gone.
@@ -119,7 +134,7 @@ public:
     test_support::CharArray<3>& operator->() { return test_support::CharArray<3>::FromArrayHeader(location_->array()); }
 
 private:
-    ObjHeader* location_;
+    ObjHeader* location_ = nullptr;
 };
 
 class StackObjectHolder : private Pinned {
@@ -203,9 +218,34 @@ WeakCounter& InstallWeakCounter(mm::ThreadData& threadData, ObjHeader* objHeader
     return weakCounter;
 }
 
+SoftCounter& InstallSoftCounter(mm::ThreadData& threadData, ObjHeader* objHeader, ObjHeader** location, KLong lastAccessMillis) {
+    mm::AllocateObject(&threadData, typeHolderSoftCounter.typeInfo(), location);
+    auto& softCounter = SoftCounter::FromObjHeader(*location);
+    auto& extraObjectData = mm::ExtraObjectData::GetOrInstall(objHeader);
+    *extraObjectData.GetSoftCounterLocation() = softCounter.header();
+    softCounter->referred = objHeader;
+    softCounter->lastAccessMillis = lastAccessMillis;
+    mm::SoftReferenceRegistry::Instance().RegisterSoftReferenceCounter(softCounter.header());
+    return softCounter;
+}
+
+KStdVector<ObjHeader*> SoftCounters() {
+    KStdVector<ObjHeader*> counters;
+    for (auto* counter : mm::SoftReferenceRegistry::Instance().Iter()) {
+        counters.push_back(counter);
+    }
+    return counters;
+}
+
 class SingleThreadMarkAndSweepTest : public testing::Test {
 public:
     ~SingleThreadMarkAndSweepTest() {
+        auto& gc = mm::GlobalData::Instance().gc();
+        gc.SetSoftReferencesThresholdBytes(softReferencesThresholdBytes_);
+        gc.SetSoftReferencesMaxIdleMillis(softReferencesMaxIdleMillis_);
+        gc.SetAllocationThresholdBytes(allocationThresholdBytes_);
+        gc.SetHeapLimitBytes(heapLimitBytes_);
+        mm::SoftReferenceRegistry::Instance().ClearForTests();
         mm::GlobalsRegistry::Instance().ClearForTests();
         mm::GlobalData::Instance().objectFactory().ClearForTests();
     }
@@ -214,6 +254,10 @@ public:
 
 private:
     FinalizerHooksTestSupport finalizerHooks_;
+    size_t softReferencesThresholdBytes_ = mm::GlobalData::Instance().gc().GetSoftReferencesThresholdBytes();
+    uint64_t softReferencesMaxIdleMillis_ = mm::GlobalData::Instance().gc().GetSoftReferencesMaxIdleMillis();
+    size_t allocationThresholdBytes_ = mm::GlobalData::Instance().gc().GetAllocationThresholdBytes();
+    size_t heapLimitBytes_ = mm::GlobalData::Instance().gc().GetHeapLimitBytes();
 };
 
 } // namespace
@@ -369,6 +413,70 @@ TEST_F(SingleThreadMarkAndSweepTest, FreeObjectWithHoldedWeak) {
     });
 }
 
+TEST_F(SingleThreadMarkAndSweepTest, FreeObjectWithFreeSoft) {
+    RunInNewThread([](mm::ThreadData& threadData) {
+        auto& object1 = AllocateObject(threadData);
+        auto& soft1 = ([&threadData, &object1]() -> SoftCounter& {
+            ObjHolder holder;
+            return InstallSoftCounter(threadData, object1.header(), holder.slot(), konan::getTimeMillis());
+        })();
+
+        ASSERT_THAT(Alive(threadData), testing::UnorderedElementsAre(object1.header(), soft1.header()));
+        ASSERT_THAT(SoftCounters(), testing::ElementsAre(soft1.header()));
+
+        threadData.gc().PerformFullGC();
+
+        EXPECT_THAT(Alive(threadData), testing::UnorderedElementsAre());
+        EXPECT_THAT(SoftCounters(), testing::ElementsAre());
+    });
+}
+
+TEST_F(SingleThreadMarkAndSweepTest, RetainObjectWithHoldedSoftBelowThreshold) {
+    RunInNewThread([](mm::ThreadData& threadData) {
+        mm::GlobalData::Instance().gc().SetSoftReferencesThresholdBytes(std::numeric_limits<size_t>::max());
+        auto& object1 = AllocateObject(threadData);
+        StackObjectHolder stack{threadData};
+        auto& soft1 = InstallSoftCounter(threadData, object1.header(), &stack->field1, 0);
+
+        ASSERT_THAT(Alive(threadData), testing::UnorderedElementsAre(object1.header(), soft1.header(), stack.header()));
+
+        threadData.gc().PerformFullGC();
+
+        EXPECT_THAT(Alive(threadData), testing::UnorderedElementsAre(object1.header(), soft1.header(), stack.header()));
+        EXPECT_THAT(GetColor(object1.header()), Color::kWhite);
+        EXPECT_THAT(soft1->referred, object1.header());
+        EXPECT_THAT(SoftCounters(), testing::ElementsAre(soft1.header()));
+    });
+}
+
+TEST_F(SingleThreadMarkAndSweepTest, FreeObjectWithHoldedSoftAboveThreshold) {
+    RunInNewThread([](mm::ThreadData& threadData) {
+        auto& gc = mm::GlobalData::Instance().gc();
+        // The heap is tiny but still above the threshold, so the allowed idle time is scaled down
+        // to a few seconds.
+        gc.SetSoftReferencesThresholdBytes(1);
+        gc.SetSoftReferencesMaxIdleMillis(1000 * 1000);
+        auto& object1 = AllocateObject(threadData);
+        auto& object2 = AllocateObject(threadData);
+        StackObjectHolder stack{threadData};
+        // Used long ago: cleared.
+        auto& soft1 = InstallSoftCounter(threadData, object1.header(), &stack->field1, konan::getTimeMillis() - 1000 * 1000 * 1000);
+        // Used just now: retained.
+        auto& soft2 = InstallSoftCounter(threadData, object2.header(), &stack->field2, konan::getTimeMillis());
+
+        ASSERT_THAT(
+                Alive(threadData),
+                testing::UnorderedElementsAre(object1.header(), object2.header(), soft1.header(), soft2.header(), stack.header()));
+
+        threadData.gc().PerformFullGC();
+
+        EXPECT_THAT(Alive(threadData), testing::UnorderedElementsAre(object2.header(), soft1.header(), soft2.header(), stack.header()));
+        EXPECT_THAT(soft1->referred, nullptr);
+        EXPECT_THAT(soft2->referred, object2.header());
+        EXPECT_THAT(SoftCounters(), testing::ElementsAre(soft2.header()));
+    });
+}
+
 TEST_F(SingleThreadMarkAndSweepTest, ObjectReferencedFromRootSet) {
     RunInNewThread([](mm::ThreadData& threadData) {
         GlobalObjectHolder global{threadData};
@@ -609,6 +717,39 @@ TEST_F(SingleThreadMarkAndSweepTest, PermanentObjects) {
     });
 }
 
+TEST_F(SingleThreadMarkAndSweepTest, ArenaObjects) {
+    RunInNewThread([](mm::ThreadData& threadData) {
+        auto& object1 = AllocateObject(threadData);
+        auto& object2 = AllocateObject(threadData);
+        auto& object3 = AllocateObject(threadData);
+
+        threadData.EnterArena();
+        auto& arenaObject1 = test_support::Object<Payload>::FromObjHeader(threadData.arena()->PlaceObject(typeHolder.typeInfo()));
+        threadData.EnterArena();
+        auto& arenaObject2 = test_support::Object<Payload>::FromObjHeader(threadData.arena()->PlaceObject(typeHolder.typeInfo()));
+        arenaObject1->field1 = object1.header();
+        arenaObject2->field1 = arenaObject1.header();
+        arenaObject2->field2 = object2.header();
+        object2->field1 = arenaObject2.header();
+
+        threadData.gc().PerformFullGC();
+
+        EXPECT_THAT(Alive(threadData), testing::UnorderedElementsAre(object1.header(), object2.header()));
+        EXPECT_THAT(GetColor(object1.header()), Color::kWhite);
+        EXPECT_THAT(GetColor(object2.header()), Color::kWhite);
+
+        threadData.LeaveArena();
+        threadData.gc().PerformFullGC();
+
+        EXPECT_THAT(Alive(threadData), testing::UnorderedElementsAre(object1.header()));
+
+        threadData.LeaveArena();
+        threadData.gc().PerformFullGC();
+
+        EXPECT_THAT(Alive(threadData), testing::UnorderedElementsAre());
+    });
+}
+
 TEST_F(SingleThreadMarkAndSweepTest, SameObjectInRootSet) {
     RunInNewThread([](mm::ThreadData& threadData) {
         GlobalObjectHolder global{threadData};
@@ -629,3 +770,125 @@ TEST_F(SingleThreadMarkAndSweepTest, SameObjectInRootSet) {
         EXPECT_THAT(GetColor(object.header()), Color::kWhite);
     });
 }
+
+TEST_F(SingleThreadMarkAndSweepTest, ExternalAllocationTriggersGC) {
+    RunInNewThread([](mm::ThreadData& threadData) {
+        auto& gc = mm::GlobalData::Instance().gc();
+        size_t size = gc.GetAllocationThresholdBytes();
+        size_t externalBytes = gc.GetExternalBytes();
+        StackObjectHolder stack{threadData};
+        auto& object = AllocateObject(threadData);
+
+        ASSERT_THAT(Alive(threadData), testing::UnorderedElementsAre(stack.header(), object.header()));
+
+        threadData.gc().SafePointExternalAllocation(size);
+
+        EXPECT_THAT(Alive(threadData), testing::UnorderedElementsAre(stack.header()));
+        EXPECT_THAT(gc.GetExternalBytes(), externalBytes + size);
+        EXPECT_THAT(threadData.gc().externalAllocatedBytes(), size);
+        EXPECT_THAT(threadData.gc().externalFreedBytes(), 0);
+
+        threadData.gc().OnExternalFree(size);
+        threadData.gc().FlushExternalBytes();
+
+        EXPECT_THAT(gc.GetExternalBytes(), externalBytes);
+        EXPECT_THAT(threadData.gc().externalAllocatedBytes(), size);
+        EXPECT_THAT(threadData.gc().externalFreedBytes(), size);
+    });
+}
+
+TEST_F(SingleThreadMarkAndSweepTest, ExternalReportsAreBatched) {
+    RunInNewThread([](mm::ThreadData& threadData) {
+        auto& gc = mm::GlobalData::Instance().gc();
+        size_t externalBytes = gc.GetExternalBytes();
+        // Get a fresh budget.
+        threadData.gc().SafePointAllocation(1);
+
+        for (int i = 0; i < 10; ++i) {
+            threadData.gc().SafePointExternalAllocation(100);
+        }
+        threadData.gc().OnExternalFree(300);
+
+        EXPECT_THAT(gc.GetExternalBytes(), externalBytes);
+        EXPECT_THAT(threadData.gc().externalAllocatedBytes(), 1000);
+        EXPECT_THAT(threadData.gc().externalFreedBytes(), 300);
+
+        threadData.gc().FlushExternalBytes();
+
+        EXPECT_THAT(gc.GetExternalBytes(), externalBytes + 700);
+
+        // Memory allocated on another thread may be freed here first, but the total never goes negative.
+        threadData.gc().OnExternalFree(externalBytes + 1000);
+        threadData.gc().FlushExternalBytes();
+
+        EXPECT_THAT(gc.GetExternalBytes(), 0);
+    });
+}
+
+TEST_F(SingleThreadMarkAndSweepTest, ScavengingReleasesThreadHeap) {
+    uint64_t scavengingIntervalMillis = GetScavengingIntervalMillis();
+    SetScavengingIntervalMillis(0);
+    RunInNewThread([](mm::ThreadData& threadData) {
+        auto& gc = mm::GlobalData::Instance().gc();
+        gc.SetAllocationThresholdBytes(std::numeric_limits<size_t>::max());
+        gc.SetHeapLimitBytes(0);
+        constexpr size_t kArraySize = 16 * 1024;
+        constexpr size_t kCount = 2 * 1024;
+        constexpr size_t kTotalSize = kArraySize * kCount;
+
+        size_t committedBefore = GetCommittedBytes();
+        for (size_t i = 0; i < kCount; ++i) {
+            ObjHolder holder;
+            mm::AllocateArray(&threadData, theByteArrayTypeInfo, kArraySize, holder.slot());
+        }
+        size_t committedAllocated = GetCommittedBytes();
+
+        threadData.gc().PerformFullGC();
+
+        size_t committedCollected = GetCommittedBytes();
+        // The allocator cannot tell.
+        if (committedBefore == 0) return;
+        // Some of the arrays may fit into the memory that was committed before.
+        ASSERT_THAT(committedAllocated, testing::Ge(committedBefore + kTotalSize / 2));
+        EXPECT_THAT(committedCollected, testing::Le(committedAllocated - kTotalSize / 2));
+    });
+    SetScavengingIntervalMillis(scavengingIntervalMillis);
+}
+
+TEST_F(SingleThreadMarkAndSweepTest, HeapLimitTriggersGC) {
+    RunInNewThread([](mm::ThreadData& threadData) {
+        auto& gc = mm::GlobalData::Instance().gc();
+        gc.SetAllocationThresholdBytes(std::numeric_limits<size_t>::max());
+        StackObjectHolder stack{threadData};
+        auto& object1 = AllocateObject(threadData);
+
+        ASSERT_THAT(Alive(threadData), testing::UnorderedElementsAre(stack.header(), object1.header()));
+
+        // The heap is already above the limit, so the next allocation collects first.
+        gc.SetHeapLimitBytes(1);
+        // Allocations from the thread's buffer were accounted for when it was filled.
+        threadData.objectFactoryThreadQueue().ReleaseAllocationBuffer();
+        auto& object2 = AllocateObject(threadData);
+
+        EXPECT_THAT(Alive(threadData), testing::UnorderedElementsAre(stack.header(), object2.header()));
+    });
+}
+
+TEST_F(SingleThreadMarkAndSweepTest, AllocationThresholdChangeTriggersGC) {
+    RunInNewThread([](mm::ThreadData& threadData) {
+        auto& gc = mm::GlobalData::Instance().gc();
+        gc.SetAllocationThresholdBytes(std::numeric_limits<size_t>::max());
+        StackObjectHolder stack{threadData};
+        auto& object1 = AllocateObject(threadData);
+        auto& object2 = AllocateObject(threadData);
+
+        ASSERT_THAT(Alive(threadData), testing::UnorderedElementsAre(stack.header(), object1.header(), object2.header()));
+
+        // The thread has a huge allocation budget by now, lowering the threshold must still be noticed.
+        gc.SetAllocationThresholdBytes(1);
+        threadData.objectFactoryThreadQueue().ReleaseAllocationBuffer();
+        auto& object3 = AllocateObject(threadData);
+
+        EXPECT_THAT(Alive(threadData), testing::UnorderedElementsAre(stack.header(), object3.header()));
+    });
+}
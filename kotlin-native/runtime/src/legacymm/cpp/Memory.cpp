@@ -17,6 +17,7 @@
 #include <string.h>
 #include <stdio.h>
 
+#include <algorithm>
 #include <cstddef> // for offsetof
 #include <mutex>
 
@@ -49,6 +50,7 @@
 #include "ObjectTraversal.hpp"
 #include "Porting.h"
 #include "Runtime.h"
+#include "Scavenger.hpp"
 #include "Utils.hpp"
 #include "WorkerBoundReference.h"
 #include "Weak.h"
@@ -152,6 +154,8 @@ FrameOverlay exportFrameOverlay;
 // Current number of allocated containers.
 volatile int allocCount = 0;
 volatile int aliveMemoryStatesCount = 0;
+// Native memory reported with `ReportExternalAllocation` and not freed yet.
+volatile size_t externalBytes = 0;
 
 #if USE_CYCLIC_GC
 KBoolean g_hasCyclicCollector = true;
@@ -721,6 +725,13 @@ struct MemoryState {
 
   bool isMainThread = false;
 
+  // Native memory reported by this thread, see `ReportExternalAllocation`.
+  uint64_t externalAllocatedBytes = 0;
+  uint64_t externalFreedBytes = 0;
+
+  // How many times `clearSubgraphReferences` took the exclusive leaf shortcut. Only checked by tests.
+  uint64_t exclusiveLeafTransfers = 0;
+
 #if COLLECT_STATISTIC
   #define CONTAINER_ALLOC_STAT(state, size, container) state->statistic.incAlloc(size, container);
   #define CONTAINER_DESTROY_STAT(state, container) \
@@ -854,8 +865,9 @@ class ObjectContainer : public Container {
 
 class ArrayContainer : public Container {
  public:
-  ArrayContainer(MemoryState* state, const TypeInfo* type_info, uint32_t elements) {
-    Init(state, type_info, elements);
+  // If `zeroed` is false, array elements are left uninitialized.
+  ArrayContainer(MemoryState* state, const TypeInfo* type_info, uint32_t elements, bool zeroed = true) {
+    Init(state, type_info, elements, zeroed);
   }
 
   // Array container shalln't have any dtor, as it's being freed by ::Release().
@@ -865,7 +877,7 @@ class ArrayContainer : public Container {
   }
 
  private:
-  void Init(MemoryState* state, const TypeInfo* type_info, uint32_t elements);
+  void Init(MemoryState* state, const TypeInfo* type_info, uint32_t elements, bool zeroed);
 };
 
 // Class representing arena-style placement container.
@@ -1031,7 +1043,8 @@ inline bool isFreezableAtomic(ContainerHeader* container) {
   return isFreezableAtomic(obj);
 }
 
-ContainerHeader* allocContainer(MemoryState* state, size_t size) {
+// If `zeroed` is false, only the `ContainerHeader` is zeroed.
+ContainerHeader* allocContainer(MemoryState* state, size_t size, bool zeroed = true) {
  ContainerHeader* result = nullptr;
 #if USE_GC
   // We recycle elements of finalizer queue for new allocations, to avoid trashing memory manager.
@@ -1048,7 +1061,7 @@ ContainerHeader* allocContainer(MemoryState* state, size_t size) {
       else
         previous->setNextLink(container->nextLink());
       state->finalizerQueueSize--;
-      memset(container, 0, size);
+      memset(container, 0, zeroed ? size : sizeof(ContainerHeader));
       break;
     }
     previous = container;
@@ -1060,7 +1073,11 @@ ContainerHeader* allocContainer(MemoryState* state, size_t size) {
     if (state != nullptr)
         state->allocSinceLastGc += size;
 #endif
-    result = konanConstructSizedInstance<ContainerHeader>(alignUp(size, kObjectAlignment));
+    if (zeroed) {
+      result = konanConstructSizedInstance<ContainerHeader>(alignUp(size, kObjectAlignment));
+    } else {
+      result = new (konanAllocUninitializedMemory(alignUp(size, kObjectAlignment))) ContainerHeader();
+    }
     atomicAdd(&allocCount, 1);
   }
   if (state != nullptr) {
@@ -1128,6 +1145,40 @@ bool hasExternalRefs(ContainerHeader* start, ContainerHeaderSet* visited) {
   return false;
 }
 
+// If `container` is the whole subgraph reachable from it, and it's only referenced by a single heap reference.
+// Its RC also counts the decrements pending for it in the `toRelease` list: a new object has one queued by
+// `rememberNewContainer`, and a released heap reference may have queued another.
+bool isExclusiveLeaf(MemoryState* state, ContainerHeader* container) {
+  if (!container->local() || container->refCount() < 1) return false;
+  bool leaf = true;
+  traverseContainerReferredObjects(container, [&leaf](ObjHeader* ref) {
+    if (!isShareable(containerFor(ref))) leaf = false;
+  });
+  if (!leaf) return false;
+  // Removed entries are tagged, so they never compare equal to `container`.
+  auto pendingDecrements = std::count(state->toRelease->begin(), state->toRelease->end(), container);
+  return container->refCount() == 1 + pendingDecrements;
+}
+
+// Takes `container` out of the GC structures, leaving it with only the remaining reference counted in RC.
+void forgetExclusiveLeaf(MemoryState* state, ContainerHeader* container) {
+  for (auto it = state->toRelease->begin(); it != state->toRelease->end(); ++it) {
+    if (*it == container) {
+      container->decRefCount<false>();
+      *it = markAsRemoved(container);
+    }
+  }
+  if (container->buffered()) {
+    for (auto it = state->toFree->begin(); it != state->toFree->end(); ++it) {
+      if (*it == container) {
+        *it = markAsRemoved(container);
+      }
+    }
+    container->resetBuffered();
+    container->setColorAssertIfGreen(CONTAINER_TAG_GC_BLACK);
+  }
+}
+
 #endif  // USE_GC
 
 void scheduleDestroyContainer(MemoryState* state, ContainerHeader* container) {
@@ -1849,6 +1900,7 @@ void garbageCollect(MemoryState* state, bool force) {
   if (!IsStrictMemoryModel()) {
     // In relaxed model we just process finalizer queue and be done with it.
     processFinalizerQueue(state);
+    kotlin::ScavengeAfterCollection();
     return;
   }
 
@@ -1940,6 +1992,8 @@ void garbageCollect(MemoryState* state, bool force) {
   GC_LOG("GC: gcToComputeRatio=%f duration=%lld sinceLast=%lld\n", double(gcEndTime - gcStartTime) / (gcStartTime - state->lastGcTimestamp + 1), (gcEndTime - gcStartTime), gcStartTime - state->lastGcTimestamp);
   state->lastGcTimestamp = gcEndTime;
 
+  kotlin::ScavengeAfterCollection();
+
 #if TRACE_MEMORY
   for (auto* obj: *state->toRelease) {
     MEMORY_LOG("toRelease %p\n", obj)
@@ -2316,14 +2370,14 @@ OBJ_GETTER(allocInstance, const TypeInfo* type_info) {
 }
 
 template <bool Strict>
-OBJ_GETTER(allocArrayInstance, const TypeInfo* type_info, int32_t elements) {
+OBJ_GETTER(allocArrayInstance, const TypeInfo* type_info, int32_t elements, bool zeroed) {
   RuntimeAssert(type_info->instanceSize_ < 0, "must be an array");
   if (elements < 0) ThrowIllegalArgumentException();
   auto* state = memoryState;
 #if USE_GC
   checkIfGcNeeded(state);
 #endif  // USE_GC
-  auto container = ArrayContainer(state, type_info, elements);
+  auto container = ArrayContainer(state, type_info, elements, zeroed);
 #if USE_GC
   if (Strict) {
     rememberNewContainer(container.header());
@@ -2690,6 +2744,19 @@ bool clearSubgraphReferences(ObjHeader* root, bool checked) {
     // TODO: assert for that?
     return true;
 
+  // The only reference is the stable pointer of the caller, so the root container is not shared and can be passed
+  // as is: nothing to analyze, whatever the size of the container, and only its own entries to remove from the GC
+  // structures.
+  if (isExclusiveLeaf(state, container)) {
+    MEMORY_LOG("transferring exclusive leaf %p\n", container)
+    forgetExclusiveLeaf(state, container);
+    state->exclusiveLeafTransfers++;
+#if TRACE_MEMORY
+    state->containers->erase(container);
+#endif
+    return true;
+  }
+
   // Free cyclic garbage to decrease number of analyzed objects.
   checkIfForceCyclicGcNeeded(state);
 
@@ -3156,12 +3223,16 @@ void ObjectContainer::Init(MemoryState* state, const TypeInfo* typeInfo) {
   OBJECT_ALLOC_EVENT(memoryState, typeInfo->instanceSize_, GetPlace())
 }
 
-void ArrayContainer::Init(MemoryState* state, const TypeInfo* typeInfo, uint32_t elements) {
+void ArrayContainer::Init(MemoryState* state, const TypeInfo* typeInfo, uint32_t elements, bool zeroed) {
   RuntimeAssert(typeInfo->instanceSize_ < 0, "Must be an array");
+  RuntimeAssert(zeroed || typeInfo != theArrayTypeInfo, "Only arrays without references can be left uninitialized");
   uint32_t allocSize =
       sizeof(ContainerHeader) + arrayObjectSize(typeInfo, elements);
-  header_ = allocContainer(state, allocSize);
+  header_ = allocContainer(state, allocSize, zeroed);
   RuntimeCheck(header_ != nullptr, "Cannot alloc memory");
+  if (!zeroed) {
+    memset(GetPlace(), 0, sizeof(ArrayHeader));
+  }
   // One object in this container, no need to set.
   header_->setContainerSize(allocSize);
   RuntimeAssert(header_->objectCount() == 1, "Must work properly");
@@ -3335,10 +3406,17 @@ OBJ_GETTER(AllocInstanceRelaxed, const TypeInfo* type_info) {
 }
 
 OBJ_GETTER(AllocArrayInstanceStrict, const TypeInfo* typeInfo, int32_t elements) {
-  RETURN_RESULT_OF(allocArrayInstance<true>, typeInfo, elements);
+  RETURN_RESULT_OF(allocArrayInstance<true>, typeInfo, elements, true);
 }
 OBJ_GETTER(AllocArrayInstanceRelaxed, const TypeInfo* typeInfo, int32_t elements) {
-  RETURN_RESULT_OF(allocArrayInstance<false>, typeInfo, elements);
+  RETURN_RESULT_OF(allocArrayInstance<false>, typeInfo, elements, true);
+}
+
+OBJ_GETTER(AllocArrayInstanceUninitializedStrict, const TypeInfo* typeInfo, int32_t elements) {
+  RETURN_RESULT_OF(allocArrayInstance<true>, typeInfo, elements, false);
+}
+OBJ_GETTER(AllocArrayInstanceUninitializedRelaxed, const TypeInfo* typeInfo, int32_t elements) {
+  RETURN_RESULT_OF(allocArrayInstance<false>, typeInfo, elements, false);
 }
 
 OBJ_GETTER(InitThreadLocalSingletonStrict, ObjHeader** location, const TypeInfo* typeInfo, void (*ctor)(ObjHeader*)) {
@@ -3568,6 +3646,113 @@ OBJ_GETTER(Kotlin_native_internal_GC_findCycle, KRef, KRef root) {
 #endif
 }
 
+void Kotlin_native_internal_GC_setSoftReferencesThreshold(KRef, KLong value) {
+  // Soft references are strong with the legacy MM.
+  ThrowIllegalArgumentException();
+}
+
+KLong Kotlin_native_internal_GC_getSoftReferencesThreshold(KRef) {
+  // Soft references are strong with the legacy MM.
+  ThrowIllegalArgumentException();
+}
+
+void Kotlin_native_internal_GC_setSoftReferencesMaxIdleMillis(KRef, KLong value) {
+  // Soft references are strong with the legacy MM.
+  ThrowIllegalArgumentException();
+}
+
+KLong Kotlin_native_internal_GC_getSoftReferencesMaxIdleMillis(KRef) {
+  // Soft references are strong with the legacy MM.
+  ThrowIllegalArgumentException();
+}
+
+void Kotlin_native_internal_GC_setHeapLimit(KRef, KLong value) {
+  // Reference counting frees objects eagerly, there is no heap to limit.
+  ThrowIllegalArgumentException();
+}
+
+KLong Kotlin_native_internal_GC_getHeapLimit(KRef) {
+  // Reference counting frees objects eagerly, there is no heap to limit.
+  ThrowIllegalArgumentException();
+}
+
+void Kotlin_native_internal_GC_setScavengingIntervalMillis(KRef, KLong value) {
+  if (value < 0) {
+    ThrowIllegalArgumentException();
+  }
+  kotlin::SetScavengingIntervalMillis(static_cast<uint64_t>(value));
+}
+
+KLong Kotlin_native_internal_GC_getScavengingIntervalMillis(KRef) {
+  auto value = kotlin::GetScavengingIntervalMillis();
+  return value > static_cast<uint64_t>(INT64_MAX) ? INT64_MAX : static_cast<KLong>(value);
+}
+
+KLong Kotlin_native_internal_GC_getCommittedBytes(KRef) {
+  return static_cast<KLong>(kotlin::GetCommittedBytes());
+}
+
+KLong Kotlin_native_internal_GC_getUsedBytes(KRef) {
+  // Reference counting does not keep track of the live bytes.
+  ThrowIllegalArgumentException();
+}
+
+void Kotlin_native_internal_GC_reportExternalAllocation(KRef, KLong bytes) {
+  if (bytes < 0) {
+    ThrowIllegalArgumentException();
+  }
+  ReportExternalAllocation(static_cast<size_t>(bytes));
+}
+
+void Kotlin_native_internal_GC_reportExternalFree(KRef, KLong bytes) {
+  if (bytes < 0) {
+    ThrowIllegalArgumentException();
+  }
+  ReportExternalFree(static_cast<size_t>(bytes));
+}
+
+KLong Kotlin_native_internal_GC_getExternalBytes(KRef) {
+  return static_cast<KLong>(atomicGet(&externalBytes));
+}
+
+KLong Kotlin_native_internal_GC_getCurrentThreadExternalAllocatedBytes(KRef) {
+  return memoryState->externalAllocatedBytes;
+}
+
+KLong Kotlin_native_internal_GC_getCurrentThreadExternalFreedBytes(KRef) {
+  return memoryState->externalFreedBytes;
+}
+
+RUNTIME_NOTHROW void ReportExternalAllocation(size_t size) {
+  atomicAdd(&externalBytes, size);
+  auto* state = memoryState;
+  if (state == nullptr) return;
+  state->externalAllocatedBytes += size;
+#if USE_GC
+  // Collection frees the wrappers, and their cleaners free the native memory.
+  state->allocSinceLastGc += size;
+  checkIfGcNeeded(state);
+#endif  // USE_GC
+}
+
+RUNTIME_NOTHROW void ReportExternalFree(size_t size) {
+  atomicAdd(&externalBytes, -size);
+  auto* state = memoryState;
+  if (state == nullptr) return;
+  state->externalFreedBytes += size;
+}
+
+OBJ_GETTER(makeStrongSoftReferenceImpl, KRef);
+
+// Reference counting has no notion of memory pressure, so soft references keep their referents alive.
+OBJ_GETTER(Konan_getSoftReferenceImpl, KRef referred) {
+  RETURN_RESULT_OF(makeStrongSoftReferenceImpl, referred);
+}
+
+OBJ_GETTER(Konan_SoftReferenceCounter_get, KRef counter) {
+  RuntimeFail("Only for experimental MM");
+}
+
 RUNTIME_NOTHROW KNativePtr CreateStablePointer(KRef any) {
   return createStablePointer(any);
 }
@@ -3674,6 +3859,17 @@ void Kotlin_native_internal_GC_setCyclicCollector(KRef gc, KBoolean value) {
 #endif  // USE_CYCLIC_GC
 }
 
+void Kotlin_native_internal_Arena_enter() {
+  // Arenas are not supported: objects are allocated as usual.
+}
+
+void Kotlin_native_internal_Arena_leave() {
+}
+
+OBJ_GETTER(Kotlin_native_internal_Arena_promote, KRef object) {
+  RETURN_OBJ(object);
+}
+
 bool Kotlin_Any_isShareable(KRef thiz) {
     return thiz == nullptr || isShareable(containerFor(thiz));
 }
@@ -3687,6 +3883,15 @@ void CheckGlobalsAccessible() {
         ThrowIncorrectDereferenceException();
 }
 
+KLong Kotlin_Debugging_getExclusiveLeafTransfers() {
+  return memoryState->exclusiveLeafTransfers;
+}
+
+RUNTIME_NOTHROW KBoolean Kotlin_Debugging_isReferencedByGlobalRoot(KRef obj) {
+    // Globals are not registered as roots in the legacy MM.
+    return false;
+}
+
 ALWAYS_INLINE RUNTIME_NOTHROW void Kotlin_mm_switchThreadStateNative() {
     // no-op, used by the new MM only.
 }
@@ -0,0 +1,173 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "Alloc.h"
+
+#include <mutex>
+
+#include "Common.h"
+#include "KAssert.h"
+#include "Mutex.hpp"
+
+using namespace kotlin;
+
+namespace {
+
+constexpr size_t kSizeClassCount = kMaxPooledAllocationSize / kPooledAllocationGranularity;
+// Blocks are moved between a thread cache and the global pool in batches of this size.
+constexpr size_t kBatchSize = 32;
+constexpr size_t kMaxCachedBlocks = 2 * kBatchSize;
+constexpr size_t kSlabSize = 16 * 1024;
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+struct FreeList {
+    FreeBlock* head = nullptr;
+    size_t count = 0;
+
+    void Push(FreeBlock* block) noexcept {
+        block->next = head;
+        head = block;
+        ++count;
+    }
+
+    FreeBlock* Pop() noexcept {
+        FreeBlock* block = head;
+        head = block->next;
+        --count;
+        return block;
+    }
+};
+
+size_t SizeClass(size_t size) noexcept {
+    return (size + kPooledAllocationGranularity - 1) / kPooledAllocationGranularity - 1;
+}
+
+size_t BlockSize(size_t sizeClass) noexcept {
+    return (sizeClass + 1) * kPooledAllocationGranularity;
+}
+
+// Blocks are never returned to the system: the pool only holds runtime bookkeeping, which stays small.
+class GlobalPool : private Pinned {
+public:
+    // Moves up to `kBatchSize` blocks into `cache`, allocating a new slab if needed.
+    void Refill(size_t sizeClass, FreeList& cache) noexcept {
+        {
+            std::lock_guard<SpinLock> guard(mutex_);
+            FreeList& list = lists_[sizeClass];
+            while (list.head != nullptr && cache.count < kBatchSize) {
+                cache.Push(list.Pop());
+            }
+        }
+        if (cache.head != nullptr) return;
+
+        size_t blockSize = BlockSize(sizeClass);
+        auto* slab = static_cast<uint8_t*>(konanAllocUninitializedMemory(kSlabSize));
+        if (slab == nullptr) return;
+        FreeList rest;
+        for (size_t offset = 0; offset + blockSize <= kSlabSize; offset += blockSize) {
+            FreeList& target = cache.count < kBatchSize ? cache : rest;
+            target.Push(reinterpret_cast<FreeBlock*>(slab + offset));
+        }
+        // The rest of the slab goes to the pool, so the cache stays under `kMaxCachedBlocks`.
+        Drain(sizeClass, rest, rest.count);
+    }
+
+    // Moves `count` blocks from `cache` into the pool.
+    void Drain(size_t sizeClass, FreeList& cache, size_t count) noexcept {
+        std::lock_guard<SpinLock> guard(mutex_);
+        FreeList& list = lists_[sizeClass];
+        while (cache.head != nullptr && count > 0) {
+            list.Push(cache.Pop());
+            --count;
+        }
+    }
+
+private:
+    SpinLock mutex_;
+    FreeList lists_[kSizeClassCount];
+};
+
+GlobalPool& globalPool() noexcept {
+    // Never destroyed: containers may be freed during static destruction.
+    static GlobalPool* pool = new (konanAllocMemory(sizeof(GlobalPool))) GlobalPool();
+    return *pool;
+}
+
+enum class CacheState {
+    kUninitialized,
+    kActive,
+    // The thread is exiting, all the blocks go directly to the global pool.
+    kFlushed,
+};
+
+struct ThreadCache {
+    CacheState state = CacheState::kUninitialized;
+    FreeList lists[kSizeClassCount];
+};
+
+THREAD_LOCAL_VARIABLE ThreadCache threadCache;
+
+void FlushThreadCache(void*) {
+    for (size_t sizeClass = 0; sizeClass < kSizeClassCount; ++sizeClass) {
+        FreeList& cache = threadCache.lists[sizeClass];
+        globalPool().Drain(sizeClass, cache, cache.count);
+    }
+    threadCache.state = CacheState::kFlushed;
+}
+
+ThreadCache* CurrentThreadCache() noexcept {
+    switch (threadCache.state) {
+        case CacheState::kActive:
+            return &threadCache;
+        case CacheState::kFlushed:
+            return nullptr;
+        case CacheState::kUninitialized:
+            threadCache.state = CacheState::kActive;
+            konan::onThreadExit(FlushThreadCache, nullptr);
+            return &threadCache;
+    }
+}
+
+} // namespace
+
+void* konanAllocPooledMemory(size_t size) {
+    RuntimeAssert(size > 0 && size <= kMaxPooledAllocationSize, "Size %zu is not pooled", size);
+    size_t sizeClass = SizeClass(size);
+    ThreadCache* cache = CurrentThreadCache();
+    if (cache == nullptr) {
+        FreeList list;
+        globalPool().Refill(sizeClass, list);
+        if (list.head == nullptr) return nullptr;
+        void* result = list.Pop();
+        globalPool().Drain(sizeClass, list, list.count);
+        return result;
+    }
+    FreeList& list = cache->lists[sizeClass];
+    if (list.head == nullptr) {
+        globalPool().Refill(sizeClass, list);
+        if (list.head == nullptr) return nullptr;
+    }
+    return list.Pop();
+}
+
+void konanFreePooledMemory(void* memory, size_t size) {
+    RuntimeAssert(size > 0 && size <= kMaxPooledAllocationSize, "Size %zu is not pooled", size);
+    size_t sizeClass = SizeClass(size);
+    ThreadCache* cache = CurrentThreadCache();
+    if (cache == nullptr) {
+        FreeList list;
+        list.Push(static_cast<FreeBlock*>(memory));
+        globalPool().Drain(sizeClass, list, 1);
+        return;
+    }
+    FreeList& list = cache->lists[sizeClass];
+    list.Push(static_cast<FreeBlock*>(memory));
+    if (list.count > kMaxCachedBlocks) {
+        globalPool().Drain(sizeClass, list, kBatchSize);
+    }
+}
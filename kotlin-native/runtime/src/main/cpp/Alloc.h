@@ -33,6 +33,11 @@ inline void* konanAllocAlignedMemory(size_t size, size_t alignment) {
     return konan::calloc_aligned(1, size, alignment);
 }
 
+// The memory is not zeroed.
+inline void* konanAllocUninitializedMemory(size_t size) {
+  return konan::malloc(size);
+}
+
 inline void konanFreeMemory(void* memory) {
   konan::free(memory);
 }
@@ -58,6 +63,15 @@ inline void konanDestructInstance(T* instance) {
   konanFreeMemory(instance);
 }
 
+// Small allocations of runtime-internal containers (see `KonanAllocator`) come from a size-class pool
+// with per-thread caches, instead of going to the system allocator each time. The memory is not zeroed.
+// `size` passed to `konanFreePooledMemory` must be the same as the one used for allocation.
+constexpr size_t kPooledAllocationGranularity = 16;
+constexpr size_t kMaxPooledAllocationSize = 256;
+
+void* konanAllocPooledMemory(size_t size);
+void konanFreePooledMemory(void* memory, size_t size);
+
 template <class T> class KonanAllocator {
  public:
   typedef size_t size_type;
@@ -71,12 +85,21 @@ template <class T> class KonanAllocator {
   KonanAllocator() {}
   KonanAllocator(const KonanAllocator&) {}
 
+  // Containers construct their elements themselves, so the memory doesn't have to be zeroed.
   pointer allocate(size_type n, const void * = 0) {
-    return reinterpret_cast<T*>(konanAllocMemory(n * sizeof(T)));
+    size_t size = n * sizeof(T);
+    if (isPooled(size)) return reinterpret_cast<T*>(konanAllocPooledMemory(size));
+    return reinterpret_cast<T*>(konanAllocUninitializedMemory(size));
   }
 
-  void deallocate(void* p, size_type) {
-    if (p != nullptr) konanFreeMemory(p);
+  void deallocate(void* p, size_type n) {
+    if (p == nullptr) return;
+    size_t size = n * sizeof(T);
+    if (isPooled(size)) {
+      konanFreePooledMemory(p, size);
+    } else {
+      konanFreeMemory(p);
+    }
   }
 
   pointer address(reference x) const { return &x; }
@@ -105,6 +128,11 @@ template <class T> class KonanAllocator {
 
   template <class U>
   KonanAllocator& operator=(const KonanAllocator<U>&) { return *this; }
+
+ private:
+  static bool isPooled(size_t size) {
+    return alignof(T) <= kPooledAllocationGranularity && size > 0 && size <= kMaxPooledAllocationSize;
+  }
 };
 
 template <class T, class U>
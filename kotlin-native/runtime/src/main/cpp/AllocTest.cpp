@@ -6,6 +6,8 @@
 #include "Alloc.h"
 
 #include <array>
+#include <cstring>
+#include <thread>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -131,3 +133,48 @@ TEST_F(KonanAllocatorAwareTest, PlacementConstructedArray) {
         a->~A();
     }
 }
+
+TEST(PooledAllocationTest, ReuseFreedMemory) {
+    void* first = konanAllocPooledMemory(24);
+    ASSERT_THAT(first, testing::NotNull());
+    konanFreePooledMemory(first, 24);
+    // Same size class.
+    void* second = konanAllocPooledMemory(32);
+    EXPECT_THAT(second, first);
+    konanFreePooledMemory(second, 32);
+}
+
+TEST(PooledAllocationTest, DifferentSizeClasses) {
+    KStdVector<std::pair<void*, size_t>> allocations;
+    for (size_t size = 1; size <= kMaxPooledAllocationSize; ++size) {
+        void* memory = konanAllocPooledMemory(size);
+        ASSERT_THAT(memory, testing::NotNull());
+        EXPECT_THAT(reinterpret_cast<uintptr_t>(memory) % kPooledAllocationGranularity, 0);
+        std::memset(memory, 0xff, size);
+        allocations.emplace_back(memory, size);
+    }
+    for (auto& [memory, size] : allocations) {
+        konanFreePooledMemory(memory, size);
+    }
+}
+
+TEST(PooledAllocationTest, FreeOnAnotherThread) {
+    constexpr int kCount = 1000;
+    KStdList<int> list;
+    std::thread([&list] {
+        for (int i = 0; i < kCount; ++i) {
+            list.push_back(i);
+        }
+    }).join();
+    int expected = 0;
+    for (int value : list) {
+        EXPECT_THAT(value, expected++);
+    }
+    list.clear();
+    std::thread([&list] {
+        for (int i = 0; i < kCount; ++i) {
+            list.push_back(i);
+        }
+        list.clear();
+    }).join();
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#ifndef KONAN_NO_THREADS
+#define WITH_WORKERS 1
+#endif
+
+#if WITH_WORKERS
+#include <pthread.h>
+#endif
+
+#include "Alloc.h"
+#include "Memory.h"
+#include "Types.h"
+#include "Utils.hpp"
+
+using namespace kotlin;
+
+extern "C" {
+
+RUNTIME_NORETURN void ThrowWorkerUnsupported();
+
+}  // extern "C"
+
+#if WITH_WORKERS
+
+namespace {
+
+// Bounded queue of detached object graphs, shared by any number of senders and receivers.
+class Channel : private Pinned, public KonanAllocatorAware {
+ public:
+  explicit Channel(KInt capacity) : buffer_(capacity) {
+    pthread_mutex_init(&lock_, nullptr);
+    pthread_cond_init(&notEmpty_, nullptr);
+    pthread_cond_init(&notFull_, nullptr);
+  }
+
+  ~Channel() {
+    while (size_ > 0) {
+      DisposeStablePointer(pop());
+    }
+    pthread_mutex_destroy(&lock_);
+    pthread_cond_destroy(&notEmpty_);
+    pthread_cond_destroy(&notFull_);
+  }
+
+  // Returns `false` if the message was not sent: the channel is closed, or full and `blocking` is `false`.
+  bool send(KNativePtr message, bool blocking) {
+    ThreadStateGuard guard(ThreadState::kNative);
+    pthread_mutex_lock(&lock_);
+    while (blocking && !closed_ && size_ == buffer_.size()) {
+      pthread_cond_wait(&notFull_, &lock_);
+    }
+    bool sent = !closed_ && size_ < buffer_.size();
+    if (sent) {
+      buffer_[(head_ + size_) % buffer_.size()] = message;
+      ++size_;
+      pthread_cond_signal(&notEmpty_);
+    }
+    pthread_mutex_unlock(&lock_);
+    return sent;
+  }
+
+  // Returns `nullptr` if there is no message: the channel is closed and empty, or empty and `blocking` is `false`.
+  KNativePtr receive(bool blocking) {
+    ThreadStateGuard guard(ThreadState::kNative);
+    pthread_mutex_lock(&lock_);
+    while (blocking && !closed_ && size_ == 0) {
+      pthread_cond_wait(&notEmpty_, &lock_);
+    }
+    KNativePtr message = nullptr;
+    if (size_ > 0) {
+      message = pop();
+      pthread_cond_signal(&notFull_);
+    }
+    pthread_mutex_unlock(&lock_);
+    return message;
+  }
+
+  void close() {
+    ThreadStateGuard guard(ThreadState::kNative);
+    pthread_mutex_lock(&lock_);
+    closed_ = true;
+    pthread_cond_broadcast(&notEmpty_);
+    pthread_cond_broadcast(&notFull_);
+    pthread_mutex_unlock(&lock_);
+  }
+
+  bool isClosed() {
+    ThreadStateGuard guard(ThreadState::kNative);
+    pthread_mutex_lock(&lock_);
+    bool result = closed_;
+    pthread_mutex_unlock(&lock_);
+    return result;
+  }
+
+ private:
+  KNativePtr pop() {
+    KNativePtr message = buffer_[head_];
+    head_ = (head_ + 1) % buffer_.size();
+    --size_;
+    return message;
+  }
+
+  // Ring buffer of messages.
+  KStdVector<KNativePtr> buffer_;
+  size_t head_ = 0;
+  size_t size_ = 0;
+  bool closed_ = false;
+  pthread_mutex_t lock_;
+  pthread_cond_t notEmpty_;
+  pthread_cond_t notFull_;
+};
+
+Channel* asChannel(KNativePtr pointer) {
+  return reinterpret_cast<Channel*>(pointer);
+}
+
+}  // namespace
+
+#endif  // WITH_WORKERS
+
+extern "C" {
+
+#if WITH_WORKERS
+
+KNativePtr Kotlin_Channel_create(KInt capacity) {
+  return new Channel(capacity);
+}
+
+void Kotlin_Channel_destroy(KNativePtr channel) {
+  delete asChannel(channel);
+}
+
+KBoolean Kotlin_Channel_send(KNativePtr channel, KNativePtr message, KBoolean blocking) {
+  if (asChannel(channel)->send(message, blocking)) return true;
+  DisposeStablePointer(message);
+  return false;
+}
+
+OBJ_GETTER(Kotlin_Channel_receive, KNativePtr channel, KBoolean blocking) {
+  KNativePtr message = asChannel(channel)->receive(blocking);
+  if (message == nullptr) RETURN_OBJ(nullptr);
+  RETURN_RESULT_OF(AdoptStablePointer, message);
+}
+
+void Kotlin_Channel_close(KNativePtr channel) {
+  asChannel(channel)->close();
+}
+
+KBoolean Kotlin_Channel_isClosed(KNativePtr channel) {
+  return asChannel(channel)->isClosed();
+}
+
+#else
+
+KNativePtr Kotlin_Channel_create(KInt capacity) {
+  ThrowWorkerUnsupported();
+}
+
+void Kotlin_Channel_destroy(KNativePtr channel) {
+  ThrowWorkerUnsupported();
+}
+
+KBoolean Kotlin_Channel_send(KNativePtr channel, KNativePtr message, KBoolean blocking) {
+  ThrowWorkerUnsupported();
+}
+
+OBJ_GETTER(Kotlin_Channel_receive, KNativePtr channel, KBoolean blocking) {
+  ThrowWorkerUnsupported();
+}
+
+void Kotlin_Channel_close(KNativePtr channel) {
+  ThrowWorkerUnsupported();
+}
+
+KBoolean Kotlin_Channel_isClosed(KNativePtr channel) {
+  ThrowWorkerUnsupported();
+}
+
+#endif  // WITH_WORKERS
+
+}  // extern "C"
@@ -4,6 +4,7 @@
  */
 
 #include "Memory.h"
+#include "Runtime.h"
 
 namespace {
 
@@ -28,6 +29,8 @@ void EnsureDeclarationsEmitted() {
     ensureUsed(InitThreadLocalSingleton);
     ensureUsed(InitSingleton);
     ensureUsed(InitAndRegisterGlobal);
+    ensureUsed(CallInitGlobalPossiblyLock);
+    ensureUsed(CallInitThreadLocal);
     ensureUsed(UpdateHeapRef);
     ensureUsed(UpdateStackRef);
     ensureUsed(UpdateReturnRef);
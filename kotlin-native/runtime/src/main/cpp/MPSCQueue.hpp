@@ -0,0 +1,122 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#ifndef RUNTIME_MPSC_QUEUE_H
+#define RUNTIME_MPSC_QUEUE_H
+
+#include <atomic>
+#include <new>
+
+#include "Alloc.h"
+#include "Utils.hpp"
+
+namespace kotlin {
+
+// Unbounded multi-producer single-consumer FIFO queue. `Push` and `PushChain` are wait-free: a single atomic exchange.
+// `TryPop` and `Empty` may only be called by the consumer thread.
+//
+// While a `Push` is in progress, the queue may look empty to the consumer, even if there are other nodes
+// behind it. The producer completes the `Push` right after with a sequentially consistent store, so the
+// consumer can park when the queue looks empty, as long as producers check whether it's parked after
+// `Push` (and wake it up). So the consumer never spins waiting for a preempted producer.
+template <typename T>
+class MPSCQueue : private Pinned {
+public:
+    MPSCQueue() noexcept : head_(&stub_), tail_(&stub_) {}
+
+    ~MPSCQueue() {
+        T value;
+        while (TryPop(value)) {
+        }
+    }
+
+    void Push(const T& value) noexcept {
+        KonanAllocator<Node> allocator;
+        Node* node = new (allocator.allocate(1)) Node(value);
+        PushNode(node);
+    }
+
+    // Pushes the values of `[first, last)` in order, with a single exchange for all of them: values pushed
+    // concurrently by other producers come before or after the whole chain, never in the middle of it.
+    template <typename Iterator>
+    void PushChain(Iterator first, Iterator last) noexcept {
+        if (first == last) return;
+        KonanAllocator<Node> allocator;
+        Node* chainFirst = new (allocator.allocate(1)) Node(*first);
+        Node* chainLast = chainFirst;
+        for (++first; first != last; ++first) {
+            Node* node = new (allocator.allocate(1)) Node(*first);
+            // Published to the consumer by the store in `LinkChain`.
+            chainLast->next.store(node, std::memory_order_relaxed);
+            chainLast = node;
+        }
+        LinkChain(chainFirst, chainLast);
+    }
+
+    // Returns `false` if the queue is empty, including when the next node is still being linked by a
+    // concurrent `Push`. Never waits for producers.
+    bool TryPop(T& value) noexcept {
+        Node* tail = tail_;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (tail == &stub_) {
+            if (next == nullptr) return false;
+            tail_ = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next == nullptr) {
+            // A `Push` is in progress after `tail`.
+            if (tail != head_.load(std::memory_order_acquire)) return false;
+            // `tail` is the last node: put the stub after it, so that `tail` could be removed.
+            stub_.next.store(nullptr, std::memory_order_relaxed);
+            PushNode(&stub_);
+            next = tail->next.load(std::memory_order_acquire);
+            // A `Push` got in before the stub, and is in progress after `tail`.
+            if (next == nullptr) return false;
+        }
+        tail_ = next;
+        value = tail->value;
+        tail->~Node();
+        KonanAllocator<Node>().deallocate(tail, 1);
+        return true;
+    }
+
+    // Mirrors `TryPop`: `true` if it would return `false` now (barring the race with a `Push` that it
+    // resolves by putting the stub in).
+    bool Empty() const noexcept {
+        const Node* tail = tail_;
+        const Node* next = tail->next.load(std::memory_order_seq_cst);
+        if (tail == &stub_) {
+            if (next == nullptr) return true;
+            tail = next;
+            next = next->next.load(std::memory_order_seq_cst);
+        }
+        return next == nullptr && tail != head_.load(std::memory_order_seq_cst);
+    }
+
+private:
+    struct Node {
+        Node() noexcept = default;
+        explicit Node(const T& value) noexcept : value(value) {}
+
+        std::atomic<Node*> next = nullptr;
+        T value;
+    };
+
+    void PushNode(Node* node) noexcept { LinkChain(node, node); }
+
+    void LinkChain(Node* first, Node* last) noexcept {
+        Node* previous = head_.exchange(last, std::memory_order_acq_rel);
+        previous->next.store(first, std::memory_order_seq_cst);
+    }
+
+    std::atomic<Node*> head_; // Producers push here.
+    Node* tail_; // The consumer pops from here.
+    Node stub_;
+};
+
+} // namespace kotlin
+
+#endif // RUNTIME_MPSC_QUEUE_H
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "MPSCQueue.hpp"
+
+#include <atomic>
+#include <thread>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "TestSupport.hpp"
+#include "Types.h"
+
+using namespace kotlin;
+
+TEST(MPSCQueueTest, Empty) {
+    MPSCQueue<int> queue;
+    int value = 0;
+    EXPECT_TRUE(queue.Empty());
+    EXPECT_FALSE(queue.TryPop(value));
+}
+
+TEST(MPSCQueueTest, PushAndPop) {
+    MPSCQueue<int> queue;
+    queue.Push(1);
+    queue.Push(2);
+    EXPECT_FALSE(queue.Empty());
+
+    int value = 0;
+    EXPECT_TRUE(queue.TryPop(value));
+    EXPECT_THAT(value, 1);
+    queue.Push(3);
+    EXPECT_TRUE(queue.TryPop(value));
+    EXPECT_THAT(value, 2);
+    EXPECT_TRUE(queue.TryPop(value));
+    EXPECT_THAT(value, 3);
+    EXPECT_TRUE(queue.Empty());
+    EXPECT_FALSE(queue.TryPop(value));
+
+    queue.Push(4);
+    EXPECT_TRUE(queue.TryPop(value));
+    EXPECT_THAT(value, 4);
+    EXPECT_TRUE(queue.Empty());
+}
+
+TEST(MPSCQueueTest, PushChain) {
+    MPSCQueue<int> queue;
+    KStdVector<int> values = {2, 3, 4};
+    queue.PushChain(values.begin(), values.begin());
+    EXPECT_TRUE(queue.Empty());
+
+    queue.Push(1);
+    queue.PushChain(values.begin(), values.end());
+    queue.Push(5);
+    int value = 0;
+    for (int expected = 1; expected <= 5; ++expected) {
+        EXPECT_TRUE(queue.TryPop(value));
+        EXPECT_THAT(value, expected);
+    }
+    EXPECT_TRUE(queue.Empty());
+
+    queue.PushChain(values.begin(), values.begin() + 1);
+    EXPECT_TRUE(queue.TryPop(value));
+    EXPECT_THAT(value, 2);
+    EXPECT_TRUE(queue.Empty());
+}
+
+TEST(MPSCQueueTest, DestroyNonEmpty) {
+    MPSCQueue<int> queue;
+    queue.Push(1);
+    queue.Push(2);
+}
+
+TEST(MPSCQueueTest, ConcurrentPush) {
+    constexpr int kThreadCount = kDefaultThreadCount;
+    constexpr int kPerThread = 10000;
+    MPSCQueue<std::pair<int, int>> queue;
+    std::atomic<bool> canStart(false);
+    KStdVector<std::thread> threads;
+    for (int i = 0; i < kThreadCount; ++i) {
+        threads.emplace_back([&queue, &canStart, i] {
+            while (!canStart) {
+            }
+            for (int j = 0; j < kPerThread; ++j) {
+                queue.Push(std::make_pair(i, j));
+            }
+        });
+    }
+
+    canStart = true;
+    // Elements of every producer must come in order.
+    KStdVector<int> next(kThreadCount, 0);
+    int popped = 0;
+    while (popped < kThreadCount * kPerThread) {
+        std::pair<int, int> value;
+        if (!queue.TryPop(value)) continue;
+        EXPECT_THAT(value.second, next[value.first]);
+        next[value.first] = value.second + 1;
+        ++popped;
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_TRUE(queue.Empty());
+}
+
+TEST(MPSCQueueTest, ConcurrentPushChain) {
+    constexpr int kThreadCount = kDefaultThreadCount;
+    constexpr int kChainCount = 1000;
+    constexpr int kChainSize = 10;
+    MPSCQueue<std::pair<int, int>> queue;
+    std::atomic<bool> canStart(false);
+    KStdVector<std::thread> threads;
+    for (int i = 0; i < kThreadCount; ++i) {
+        threads.emplace_back([&queue, &canStart, i] {
+            while (!canStart) {
+            }
+            KStdVector<std::pair<int, int>> chain;
+            for (int j = 0; j < kChainCount * kChainSize; j += kChainSize) {
+                chain.clear();
+                for (int k = 0; k < kChainSize; ++k) {
+                    chain.push_back(std::make_pair(i, j + k));
+                }
+                queue.PushChain(chain.begin(), chain.end());
+            }
+        });
+    }
+
+    canStart = true;
+    // A chain is never interleaved with other producers.
+    int popped = 0;
+    int currentProducer = -1;
+    int next = 0;
+    KStdVector<int> nextChainStart(kThreadCount, 0);
+    while (popped < kThreadCount * kChainCount * kChainSize) {
+        std::pair<int, int> value;
+        if (!queue.TryPop(value)) continue;
+        if (value.second % kChainSize == 0) {
+            EXPECT_THAT(value.second, nextChainStart[value.first]);
+            nextChainStart[value.first] = value.second + kChainSize;
+            currentProducer = value.first;
+        } else {
+            EXPECT_THAT(value.first, currentProducer);
+            EXPECT_THAT(value.second, next);
+        }
+        next = value.second + 1;
+        ++popped;
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_TRUE(queue.Empty());
+}
@@ -164,13 +164,17 @@ OBJ_GETTER(AllocInstance, const TypeInfo* type_info) RUNTIME_NOTHROW;
 
 OBJ_GETTER(AllocArrayInstance, const TypeInfo* type_info, int32_t elements);
 
+// Same as `AllocArrayInstance`, but the array elements are not zeroed. Only for arrays of primitive types,
+// and the caller must overwrite every element before the array is exposed.
+OBJ_GETTER(AllocArrayInstanceUninitialized, const TypeInfo* type_info, int32_t elements);
+
 OBJ_GETTER(InitThreadLocalSingleton, ObjHeader** location, const TypeInfo* typeInfo, void (*ctor)(ObjHeader*));
 
 OBJ_GETTER(InitSingleton, ObjHeader** location, const TypeInfo* typeInfo, void (*ctor)(ObjHeader*));
 
 // `initialValue` may be `nullptr`, which signifies that the appropriate initial value was already
 // set by static initialization.
-// TODO: When global initialization becomes lazy, this signature won't do.
+// With lazy initialization (see `CallInitGlobalPossiblyLock`) this is called on the first access to the file.
 void InitAndRegisterGlobal(ObjHeader** location, const ObjHeader* initialValue) RUNTIME_NOTHROW;
 
 //
@@ -289,14 +293,38 @@ void Kotlin_native_internal_GC_setThresholdAllocations(ObjHeader*, int64_t value
 int64_t Kotlin_native_internal_GC_getThresholdAllocations(ObjHeader*);
 void Kotlin_native_internal_GC_setTuneThreshold(ObjHeader*, bool value);
 bool Kotlin_native_internal_GC_getTuneThreshold(ObjHeader*);
+void Kotlin_native_internal_GC_setSoftReferencesThreshold(ObjHeader*, int64_t value);
+int64_t Kotlin_native_internal_GC_getSoftReferencesThreshold(ObjHeader*);
+void Kotlin_native_internal_GC_setSoftReferencesMaxIdleMillis(ObjHeader*, int64_t value);
+int64_t Kotlin_native_internal_GC_getSoftReferencesMaxIdleMillis(ObjHeader*);
+void Kotlin_native_internal_GC_setHeapLimit(ObjHeader*, int64_t value);
+int64_t Kotlin_native_internal_GC_getHeapLimit(ObjHeader*);
+void Kotlin_native_internal_GC_setScavengingIntervalMillis(ObjHeader*, int64_t value);
+int64_t Kotlin_native_internal_GC_getScavengingIntervalMillis(ObjHeader*);
+int64_t Kotlin_native_internal_GC_getCommittedBytes(ObjHeader*);
+int64_t Kotlin_native_internal_GC_getUsedBytes(ObjHeader*);
+void Kotlin_native_internal_GC_reportExternalAllocation(ObjHeader*, int64_t bytes);
+void Kotlin_native_internal_GC_reportExternalFree(ObjHeader*, int64_t bytes);
+int64_t Kotlin_native_internal_GC_getExternalBytes(ObjHeader*);
+int64_t Kotlin_native_internal_GC_getCurrentThreadExternalAllocatedBytes(ObjHeader*);
+int64_t Kotlin_native_internal_GC_getCurrentThreadExternalFreedBytes(ObjHeader*);
 OBJ_GETTER(Kotlin_native_internal_GC_detectCycles, ObjHeader*);
 OBJ_GETTER(Kotlin_native_internal_GC_findCycle, ObjHeader*, ObjHeader* root);
 bool Kotlin_native_internal_GC_getCyclicCollector(ObjHeader* gc);
 void Kotlin_native_internal_GC_setCyclicCollector(ObjHeader* gc, bool value);
 
+// Scoped arenas, see `kotlin.native.internal.withArena`.
+void Kotlin_native_internal_Arena_enter();
+void Kotlin_native_internal_Arena_leave();
+OBJ_GETTER(Kotlin_native_internal_Arena_promote, ObjHeader* object);
+
 bool Kotlin_Any_isShareable(ObjHeader* thiz);
 void Kotlin_Any_share(ObjHeader* thiz);
 void PerformFullGC(MemoryState* memory) RUNTIME_NOTHROW;
+// Report native memory kept alive by Kotlin objects (e.g. released by a `Cleaner`), so that it
+// is taken into account when scheduling GC. Allocation must happen on a Kotlin thread and can collect.
+void ReportExternalAllocation(size_t size) RUNTIME_NOTHROW;
+void ReportExternalFree(size_t size) RUNTIME_NOTHROW;
 
 bool TryAddHeapRef(const ObjHeader* object);
 
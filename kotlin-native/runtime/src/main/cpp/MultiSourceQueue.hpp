@@ -18,6 +18,15 @@ namespace kotlin {
 // A queue that is constructed by collecting subqueues from several `Producer`s.
 template <typename T>
 class MultiSourceQueue {
+    // Nodes inserted by a `Producer` between two publications. It tells the owning `Producer` which nodes are
+    // its own, and `ApplyDeletions` which nodes were published, without walking any queue. Created by `Insert`,
+    // so that `Publish` never allocates, and destroyed together with the last of its nodes.
+    struct Batch : private Pinned, public KonanAllocatorAware {
+        // Set by `Publish` under `mutex_`. After that the batch is only accessed under `mutex_`.
+        bool published = false;
+        size_t size = 0;
+    };
+
 public:
     class Producer;
 
@@ -25,7 +34,7 @@ public:
     // and to not store the iterator.
     class Node : private Pinned, public KonanAllocatorAware {
     public:
-        Node(const T& value, Producer* owner) noexcept : value_(value), owner_(owner) {}
+        Node(const T& value, Batch* batch) noexcept : value_(value), batch_(batch) {}
 
         T& operator*() noexcept { return value_; }
 
@@ -33,7 +42,7 @@ public:
         friend class MultiSourceQueue;
 
         T value_;
-        std::atomic<Producer*> owner_; // `nullptr` signifies that `MultiSourceQueue` owns it.
+        Batch* const batch_;
         typename KStdList<Node>::iterator position_;
     };
 
@@ -41,19 +50,28 @@ public:
     public:
         explicit Producer(MultiSourceQueue& owner) noexcept : owner_(owner) {}
 
-        ~Producer() { Publish(); }
+        ~Producer() {
+            Publish();
+            // Only an empty batch can be left after publication.
+            delete batch_;
+        }
 
         Node* Insert(const T& value) noexcept {
-            queue_.emplace_back(value, this);
+            if (batch_ == nullptr) {
+                batch_ = new Batch();
+            }
+            queue_.emplace_back(value, batch_);
+            ++batch_->size;
             auto& node = queue_.back();
             node.position_ = std::prev(queue_.end());
             return &node;
         }
 
         void Erase(Node* node) noexcept {
-            if (node->owner_ == this) {
-                // If we own it, delete it immediately.
+            if (node->batch_ == batch_) {
+                // If we own it, delete it immediately. The batch stays, as it's still the current one.
                 queue_.erase(node->position_);
+                --batch_->size;
                 return;
             }
             // If it's owned by the global queue or some other `Producer`, queue it.
@@ -61,12 +79,16 @@ public:
         }
 
         // Merge `this` queue with owning `MultiSourceQueue`. `this` will have empty queue after the call.
-        // This call is performed without heap allocations. TODO: Test that no allocations are happening.
+        // This call is performed without heap allocations and without walking the queue. The lock is not
+        // taken at all if there's nothing to publish. TODO: Test that no allocations are happening.
         void Publish() noexcept {
-            for (auto& node : queue_) {
-                node.owner_ = nullptr;
-            }
+            if (queue_.empty() && deletionQueue_.empty()) return;
             std::lock_guard<SpinLock> guard(owner_.mutex_);
+            if (!queue_.empty()) {
+                // The published nodes are no longer owned by `this`, the next `Insert` starts a new batch.
+                batch_->published = true;
+                batch_ = nullptr;
+            }
             owner_.queue_.splice(owner_.queue_.end(), queue_);
             owner_.deletionQueue_.splice(owner_.deletionQueue_.end(), deletionQueue_);
         }
@@ -74,10 +96,14 @@ public:
         void ClearForTests() noexcept {
             queue_.clear();
             deletionQueue_.clear();
+            delete batch_;
+            batch_ = nullptr;
         }
 
     private:
         MultiSourceQueue& owner_; // weak
+        // The batch of the nodes in `queue_`, if there were any since the last publication.
+        Batch* batch_ = nullptr;
         KStdList<Node> queue_;
         KStdList<Node*> deletionQueue_;
     };
@@ -117,39 +143,46 @@ public:
         std::unique_lock<SpinLock> guard_;
     };
 
+    ~MultiSourceQueue() { ClearForTests(); }
+
     // Lock `MultiSourceQueue` for safe iteration. If element was scheduled for deletion,
     // it'll still be iterated. Use `ApplyDeletions` to remove those elements.
     Iterable Iter() noexcept { return Iterable(*this); }
 
     // Lock `MultiSourceQueue` and apply deletions. Only deletes elements that were published.
+    // Takes time proportional to the number of deletions, not to the size of the queue.
     void ApplyDeletions() noexcept {
         std::lock_guard<SpinLock> guard(mutex_);
-        KStdList<Node*> remainingDeletions;
-
         auto it = deletionQueue_.begin();
         while (it != deletionQueue_.end()) {
-            auto next = std::next(it);
             Node* node = *it;
-
-            if (node->owner_ != nullptr) {
-                // If the `Node` is still owned by some `Producer`, skip it.
-                remainingDeletions.splice(remainingDeletions.end(), deletionQueue_, it);
-            } else {
-                queue_.erase(node->position_);
-                // `node` is invalid after this
+            // Nodes still owned by some `Producer` stay in the deletion queue.
+            if (!node->batch_->published) {
+                ++it;
+                continue;
             }
-
-            it = next;
+            Erase(node);
+            it = deletionQueue_.erase(it);
         }
-        deletionQueue_ = std::move(remainingDeletions);
     }
 
     void ClearForTests() noexcept {
-        queue_.clear();
+        while (!queue_.empty()) {
+            Erase(&queue_.front());
+        }
         deletionQueue_.clear();
     }
 
 private:
+    // Expects `mutex_` to be held by the current thread, and `node` to be published.
+    void Erase(Node* node) noexcept {
+        Batch* batch = node->batch_;
+        queue_.erase(node->position_);
+        if (--batch->size == 0) {
+            delete batch;
+        }
+    }
+
     // Using `KStdList` as it allows to implement `Collect` without memory allocations,
     // which is important for GC mark phase.
     KStdList<Node> queue_;
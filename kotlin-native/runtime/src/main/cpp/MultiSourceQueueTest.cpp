@@ -115,6 +115,70 @@ TEST(MultiSourceQueueTest, EraseFromOtherProducer) {
     EXPECT_THAT(actual4, testing::ElementsAre(kFirst));
 }
 
+TEST(MultiSourceQueueTest, ErasePublishedAndUnpublished) {
+    IntQueue queue;
+    IntQueue::Producer producer1(queue);
+    IntQueue::Producer producer2(queue);
+
+    constexpr int kFirst = 1;
+    constexpr int kSecond = 2;
+    constexpr int kThird = 3;
+
+    auto* node1 = producer1.Insert(kFirst);
+    producer1.Insert(kSecond);
+    producer1.Publish();
+    auto* node3 = producer1.Insert(kThird);
+    producer2.Erase(node1);
+    producer2.Erase(node3);
+    producer2.Publish();
+
+    queue.ApplyDeletions();
+
+    auto actual1 = Collect(queue);
+    EXPECT_THAT(actual1, testing::ElementsAre(kSecond));
+
+    producer1.Publish();
+
+    auto actual2 = Collect(queue);
+    EXPECT_THAT(actual2, testing::ElementsAre(kSecond, kThird));
+
+    queue.ApplyDeletions();
+
+    auto actual3 = Collect(queue);
+    EXPECT_THAT(actual3, testing::ElementsAre(kSecond));
+}
+
+TEST(MultiSourceQueueTest, EraseWholeBatches) {
+    IntQueue queue;
+    IntQueue::Producer producer1(queue);
+    IntQueue::Producer producer2(queue);
+
+    constexpr int kFirst = 1;
+    constexpr int kSecond = 2;
+    constexpr int kThird = 3;
+
+    auto* node1 = producer1.Insert(kFirst);
+    producer1.Erase(node1);
+    auto* node2 = producer1.Insert(kSecond);
+    producer1.Publish();
+    auto* node3 = producer1.Insert(kThird);
+    producer1.Publish();
+    producer2.Erase(node2);
+    producer2.Erase(node3);
+    producer2.Publish();
+
+    queue.ApplyDeletions();
+
+    auto actual = Collect(queue);
+    EXPECT_THAT(actual, testing::IsEmpty());
+
+    producer1.Insert(kFirst);
+    producer1.Publish();
+
+    auto actual2 = Collect(queue);
+    EXPECT_THAT(actual2, testing::ElementsAre(kFirst));
+}
+
 TEST(MultiSourceQueueTest, Empty) {
     IntQueue queue;
 
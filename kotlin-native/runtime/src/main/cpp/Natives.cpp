@@ -62,10 +62,17 @@ void* Kotlin_interop_malloc(KLong size, KInt align) {
     RuntimeAssert(false, "unsupported alignment");
   }
 
+  // Such memory is usually owned by a small Kotlin object, so let the GC know how much it keeps alive.
+  // The block size is taken from the allocator, so that pointers stay compatible with the C `free`.
+  if (result != nullptr) {
+    ReportExternalAllocation(konan::malloc_usable_size(result));
+  }
   return result;
 }
 
 void Kotlin_interop_free(void* ptr) {
+  if (ptr == nullptr) return;
+  ReportExternalFree(konan::malloc_usable_size(ptr));
   konan::free(ptr);
 }
 
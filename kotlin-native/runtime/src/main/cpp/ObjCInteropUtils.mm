@@ -71,7 +71,7 @@ OBJ_GETTER(Kotlin_Interop_CreateKStringFromNSString, NSString* str) {
 
   auto length = CFStringGetLength(immutableCopyOrSameStr);
   CFRange range = {0, length};
-  ArrayHeader* result = AllocArrayInstance(theStringTypeInfo, length, OBJ_RESULT)->array();
+  ArrayHeader* result = AllocArrayInstanceUninitialized(theStringTypeInfo, length, OBJ_RESULT)->array();
   KChar* rawResult = CharArrayAddressOfElementAt(result, 0);
 
   CFStringGetCharacters(immutableCopyOrSameStr, range, rawResult);
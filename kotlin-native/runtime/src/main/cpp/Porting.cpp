@@ -26,6 +26,15 @@
 #include <pthread.h>
 #endif
 #include <unistd.h>
+#if KONAN_LINUX
+#include <fcntl.h>
+#include <limits.h>
+#endif
+#if (KONAN_LINUX || KONAN_ANDROID) && !KONAN_NO_THREADS
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
 #if KONAN_WINDOWS
 #include <windows.h>
 #endif
@@ -238,6 +247,47 @@ void onThreadExit(void (*destructor)(void*), void* destructorParameter) {
 #endif  // !KONAN_NO_THREADS
 }
 
+void setCurrentThreadName(const char* name) {
+#if KONAN_NO_THREADS || KONAN_WINDOWS
+  // Not supported.
+#elif KONAN_MACOSX || KONAN_IOS || KONAN_TVOS || KONAN_WATCHOS
+  pthread_setname_np(name);
+#else
+  // Linux limits names to 16 bytes including the terminating zero, and rejects longer ones.
+  char buffer[16];
+  strncpy(buffer, name, sizeof(buffer) - 1);
+  buffer[sizeof(buffer) - 1] = '\0';
+  pthread_setname_np(pthread_self(), buffer);
+#endif
+}
+
+bool setCurrentThreadAffinity(const int32_t* cpus, size_t count) {
+#if (KONAN_LINUX || KONAN_ANDROID) && !KONAN_NO_THREADS
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (size_t i = 0; i < count; ++i) {
+    if (cpus[i] < 0 || cpus[i] >= CPU_SETSIZE) return false;
+    CPU_SET(cpus[i], &set);
+  }
+#if KONAN_ANDROID
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#endif
+#else
+  return false;
+#endif
+}
+
+bool setCurrentThreadNice(int32_t nice) {
+#if (KONAN_LINUX || KONAN_ANDROID) && !KONAN_NO_THREADS
+  // On Linux, nice value of a thread is set with its thread id.
+  return setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), nice) == 0;
+#else
+  return false;
+#endif
+}
+
 // Process execution.
 void abort(void) {
   ::abort();
@@ -253,6 +303,16 @@ void exit(int32_t status) {
 }
 #endif
 
+#if KONAN_WASM || KONAN_ZEPHYR
+const char* getEnv(const char* name) {
+  return nullptr;
+}
+#else
+const char* getEnv(const char* name) {
+  return ::getenv(name);
+}
+#endif
+
 // String/byte operations.
 // memcpy/memmove are not here intentionally, as frequently implemented/optimized
 // by C compiler.
@@ -289,18 +349,57 @@ size_t strnlen(const char* buffer, size_t maxSize) {
 // Memory operations.
 #if KONAN_INTERNAL_DLMALLOC
 extern "C" void* dlcalloc(size_t, size_t);
+extern "C" void* dlmalloc(size_t);
 extern "C" void dlfree(void*);
 #define calloc_impl dlcalloc
+#define malloc_impl dlmalloc
+#define malloc_aligned_impl(size, alignment) dlmalloc(size)
 #define free_impl dlfree
 #define calloc_aligned_impl(count, size, alignment) dlcalloc(count, size)
-
+#define aligned_alloc_supported_impl() false
+extern "C" size_t dlmalloc_usable_size(void*);
+#define malloc_usable_size_impl dlmalloc_usable_size
+#define free_batch_impl(ptrs, count) for (size_t i = 0; i < (count); ++i) dlfree((ptrs)[i])
+extern "C" int dlmalloc_trim(size_t);
+#define release_free_memory_impl() dlmalloc_trim(0)
+extern "C" size_t dlmalloc_footprint();
+#define committed_memory_bytes_impl dlmalloc_footprint
+#define heap_new_impl() nullptr
+#define heap_delete_impl(heap) (void)(heap)
+#define heap_calloc_aligned_impl(heap, count, size, alignment) dlcalloc(count, size)
+#define heap_malloc_aligned_impl(heap, size, alignment) dlmalloc(size)
+#define heap_collect_impl(heap, force) (void)(heap)
 #else
 extern "C" void* konan_calloc_impl(size_t, size_t);
+extern "C" void* konan_malloc_impl(size_t);
+extern "C" void* konan_malloc_aligned_impl(size_t size, size_t alignment);
 extern "C" void konan_free_impl(void*);
+extern "C" size_t konan_malloc_usable_size_impl(void*);
+extern "C" void konan_free_batch_impl(void**, size_t);
 extern "C" void* konan_calloc_aligned_impl(size_t count, size_t size, size_t alignment);
+extern "C" bool konan_aligned_alloc_supported_impl();
+extern "C" void konan_release_free_memory_impl();
+extern "C" size_t konan_committed_memory_bytes_impl();
+extern "C" void* konan_heap_new_impl();
+extern "C" void konan_heap_delete_impl(void* heap);
+extern "C" void* konan_heap_calloc_aligned_impl(void* heap, size_t count, size_t size, size_t alignment);
+extern "C" void* konan_heap_malloc_aligned_impl(void* heap, size_t size, size_t alignment);
+extern "C" void konan_heap_collect_impl(void* heap, bool force);
 #define calloc_impl konan_calloc_impl
+#define malloc_impl konan_malloc_impl
+#define malloc_aligned_impl konan_malloc_aligned_impl
 #define free_impl konan_free_impl
+#define malloc_usable_size_impl konan_malloc_usable_size_impl
+#define free_batch_impl konan_free_batch_impl
 #define calloc_aligned_impl konan_calloc_aligned_impl
+#define aligned_alloc_supported_impl konan_aligned_alloc_supported_impl
+#define release_free_memory_impl konan_release_free_memory_impl
+#define committed_memory_bytes_impl konan_committed_memory_bytes_impl
+#define heap_new_impl konan_heap_new_impl
+#define heap_delete_impl konan_heap_delete_impl
+#define heap_calloc_aligned_impl konan_heap_calloc_aligned_impl
+#define heap_malloc_aligned_impl konan_heap_malloc_aligned_impl
+#define heap_collect_impl konan_heap_collect_impl
 #endif
 
 void* calloc(size_t count, size_t size) {
@@ -311,10 +410,117 @@ void* calloc_aligned(size_t count, size_t size, size_t alignment) {
   return calloc_aligned_impl(count, size, alignment);
 }
 
+void* malloc(size_t size) {
+  return malloc_impl(size);
+}
+
+void* malloc_aligned(size_t size, size_t alignment) {
+  return malloc_aligned_impl(size, alignment);
+}
+
+bool aligned_alloc_supported() {
+  return aligned_alloc_supported_impl();
+}
+
 void free(void* pointer) {
   free_impl(pointer);
 }
 
+void free_batch(void** pointers, size_t count) {
+  free_batch_impl(pointers, count);
+}
+
+size_t malloc_usable_size(void* pointer) {
+  if (pointer == nullptr) return 0;
+  return malloc_usable_size_impl(pointer);
+}
+
+AllocatorHeap* heap_new() {
+  return static_cast<AllocatorHeap*>(heap_new_impl());
+}
+
+void heap_delete(AllocatorHeap* heap) {
+  if (heap == nullptr) return;
+  heap_delete_impl(heap);
+}
+
+void* heap_calloc_aligned(AllocatorHeap* heap, size_t count, size_t size, size_t alignment) {
+  if (heap == nullptr) return calloc_aligned_impl(count, size, alignment);
+  return heap_calloc_aligned_impl(heap, count, size, alignment);
+}
+
+void* heap_malloc_aligned(AllocatorHeap* heap, size_t size, size_t alignment) {
+  if (heap == nullptr) return malloc_aligned_impl(size, alignment);
+  return heap_malloc_aligned_impl(heap, size, alignment);
+}
+
+void heap_collect(AllocatorHeap* heap, bool force) {
+  if (heap == nullptr) return;
+  heap_collect_impl(heap, force);
+}
+
+void releaseFreeMemory() {
+  release_free_memory_impl();
+}
+
+size_t getCommittedMemoryBytes() {
+  return committed_memory_bytes_impl();
+}
+
+#if KONAN_LINUX
+namespace {
+
+// Reads a single unsigned number from a cgroup file. Returns false for "max" and for missing files.
+bool readCgroupValue(const char* path, size_t* value) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) return false;
+  char buffer[64];
+  ssize_t size = read(fd, buffer, sizeof(buffer) - 1);
+  close(fd);
+  if (size <= 0) return false;
+  buffer[size] = '\0';
+  char* end = nullptr;
+  unsigned long long result = strtoull(buffer, &end, 10);
+  if (end == buffer) return false;
+  *value = static_cast<size_t>(result);
+  return true;
+}
+
+} // namespace
+#endif
+
+size_t getMemoryLimitBytes() {
+#if KONAN_LINUX
+  // Only cgroup v2 is supported. The process cgroup is listed in /proc/self/cgroup as "0::<path>".
+  // Inside a container with its own cgroup namespace that path is just "/".
+  char path[PATH_MAX];
+  int fd = open("/proc/self/cgroup", O_RDONLY);
+  if (fd >= 0) {
+    char buffer[PATH_MAX];
+    ssize_t size = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if (size > 0) {
+      buffer[size] = '\0';
+      const char* cgroup = strstr(buffer, "0::");
+      if (cgroup != nullptr) {
+        cgroup += 3;
+        size_t length = strcspn(cgroup, "\n");
+        int pathLength = snprintf(path, sizeof(path), "/sys/fs/cgroup%.*s/memory.max", static_cast<int>(length), cgroup);
+        size_t value = 0;
+        if (pathLength < static_cast<int>(sizeof(path)) && readCgroupValue(path, &value)) {
+          return value;
+        }
+      }
+    }
+  }
+  size_t value = 0;
+  if (readCgroupValue("/sys/fs/cgroup/memory.max", &value)) {
+    return value;
+  }
+#endif
+  return 0;
+}
+
 #if KONAN_INTERNAL_NOW
 
 #ifdef KONAN_ZEPHYR
@@ -38,9 +38,17 @@ void consoleFlush();
 // Process control.
 RUNTIME_NORETURN void abort(void);
 RUNTIME_NORETURN void exit(int32_t status);
+// Returns `nullptr` if the variable is not set or there's no process environment on the platform.
+const char* getEnv(const char* name);
 
 // Thread control.
 void onThreadExit(void (*destructor)(void*), void* destructorParameter);
+// Names the current thread for debuggers and profilers, the name may be truncated to the platform limit.
+void setCurrentThreadName(const char* name);
+// Restricts the current thread to run on `cpus` only. Returns `false` if unsupported on the platform, or failed.
+bool setCurrentThreadAffinity(const int32_t* cpus, size_t count);
+// Sets the nice value of the current thread. Returns `false` if unsupported on the platform, or failed.
+bool setCurrentThreadNice(int32_t nice);
 
 // String/byte operations.
 // memcpy/memmove/memcmp are not here intentionally, as frequently implemented/optimized
@@ -80,7 +88,36 @@ void *memset(void *b, int c, size_t len);
 // Memory operations.
 void* calloc(size_t count, size_t size);
 void* calloc_aligned(size_t count, size_t size, size_t alignment);
+// Like `calloc`, but the memory is not zeroed.
+void* malloc(size_t size);
+void* malloc_aligned(size_t size, size_t alignment);
+// Whether the `*_aligned` functions honour `alignment`. If not, they only give the alignment of `malloc`.
+bool aligned_alloc_supported();
 void free(void* ptr);
+// Frees `count` blocks at once. The blocks may come from different heaps: consecutive blocks that are
+// owned by another thread are handed back to it together, where the allocator supports that.
+void free_batch(void** ptrs, size_t count);
+// Usable size of a block returned by the functions above, at least the requested size.
+// 0 if the allocator cannot tell.
+size_t malloc_usable_size(void* ptr);
+// Separate allocation heap, intended to be owned by a single thread. `heap_new` returns `nullptr` if
+// the allocator does not support heaps, and allocating from a `nullptr` heap uses the default one.
+struct AllocatorHeap;
+AllocatorHeap* heap_new();
+// Must be called on the thread that created `heap`. Blocks allocated from `heap` remain valid.
+void heap_delete(AllocatorHeap* heap);
+void* heap_calloc_aligned(AllocatorHeap* heap, size_t count, size_t size, size_t alignment);
+void* heap_malloc_aligned(AllocatorHeap* heap, size_t size, size_t alignment);
+// Frees the empty pages of `heap`, and with `force` also returns the memory cached by the current thread
+// to the OS. Must be called on the thread that created `heap`. Does nothing for a `nullptr` heap.
+void heap_collect(AllocatorHeap* heap, bool force);
+// Ask the allocator to return unused memory to the OS.
+void releaseFreeMemory();
+// Memory the allocator has taken from the OS, 0 if the allocator cannot tell.
+size_t getCommittedMemoryBytes();
+// Memory available to the process as limited by the environment (cgroup v2 `memory.max` on Linux).
+// 0 if there is no limit or it cannot be determined.
+size_t getMemoryLimitBytes();
 
 // Time operations.
 uint64_t getTimeMillis();
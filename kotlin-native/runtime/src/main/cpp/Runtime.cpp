@@ -14,6 +14,9 @@
  * limitations under the License.
  */
 
+#include <cstring>
+#include <thread>
+
 #include "Alloc.h"
 #include "Atomic.h"
 #include "Cleaner.h"
@@ -25,6 +28,8 @@
 #include "Runtime.h"
 #include "Worker.h"
 
+extern "C" void Kotlin_runShutdownHooks();
+
 typedef void (*Initializer)(int initialize, MemoryState* memory);
 struct InitNode {
   Initializer init;
@@ -74,11 +79,46 @@ void InitOrDeinitGlobalVariables(int initialize, MemoryState* memory) {
 KBoolean g_checkLeaks = false;
 KBoolean g_checkLeakedCleaners = false;
 KBoolean g_forceCheckedShutdown = false;
+KBoolean g_fastShutdown = false;
 
 constexpr RuntimeState* kInvalidRuntime = nullptr;
 
 THREAD_LOCAL_VARIABLE RuntimeState* runtimeState = kInvalidRuntime;
 
+// Values of file initialization state words. For global state words, a file being initialized has the id
+// of the initializing thread (see `currentInitializerThreadId`) instead of `FILE_BEING_INITIALIZED`.
+enum FileInitState : int32_t {
+  FILE_NOT_INITIALIZED = 0,
+  FILE_INITIALIZED = 1,
+  FILE_FAILED_TO_INITIALIZE = 2,
+  FILE_BEING_INITIALIZED = 3,
+};
+
+volatile int32_t lastInitializerThreadId = FILE_BEING_INITIALIZED;
+THREAD_LOCAL_VARIABLE int32_t initializerThreadId = FILE_NOT_INITIALIZED;
+
+int32_t currentInitializerThreadId() {
+  if (initializerThreadId == FILE_NOT_INITIALIZED) {
+    initializerThreadId = atomicAdd(&lastInitializerThreadId, 1);
+    RuntimeCheck(initializerThreadId > FILE_BEING_INITIALIZED, "Too many threads initializing globals");
+  }
+  return initializerThreadId;
+}
+
+template <typename State>
+void runFileInitializer(State* state, void (*init)()) {
+#if KONAN_NO_EXCEPTIONS
+  init();
+#else
+  try {
+    init();
+  } catch (...) {
+    *state = FILE_FAILED_TO_INITIALIZE;
+    throw;
+  }
+#endif
+}
+
 inline bool isValidRuntime() {
   return ::runtimeState != kInvalidRuntime;
 }
@@ -134,6 +174,10 @@ RuntimeState* initRuntime() {
   // Keep global variables in state as well.
   if (firstRuntime) {
     konan::consoleInit();
+    const char* fastShutdown = konan::getEnv("KOTLIN_NATIVE_FAST_SHUTDOWN");
+    if (fastShutdown != nullptr && strcmp(fastShutdown, "1") == 0) {
+      g_fastShutdown = true;
+    }
 #if KONAN_OBJC_INTEROP
     Kotlin_ObjCExport_initialize();
 #endif
@@ -196,6 +240,39 @@ void AppendToInitializersTail(InitNode *next) {
   initTailNode = next;
 }
 
+void CallInitGlobalPossiblyLock(int32_t volatile* state, void (*init)()) {
+  int32_t localState = atomicGet(state);
+  if (localState == FILE_INITIALIZED) return;
+  if (localState == FILE_FAILED_TO_INITIALIZE) ThrowIllegalStateException();
+  int32_t threadId = currentInitializerThreadId();
+  // Recursive initialization: the globals are being initialized further up the stack.
+  if (localState == threadId) return;
+  localState = compareAndSwap(state, static_cast<int32_t>(FILE_NOT_INITIALIZED), threadId);
+  if (localState == FILE_NOT_INITIALIZED) {
+    runFileInitializer(state, init);
+    atomicSet(state, static_cast<int32_t>(FILE_INITIALIZED));
+    return;
+  }
+  {
+    // Let the GC proceed while another thread runs the initializer.
+    kotlin::ThreadStateGuard guard(kotlin::ThreadState::kNative);
+    while (localState != FILE_INITIALIZED && localState != FILE_FAILED_TO_INITIALIZE) {
+      std::this_thread::yield();
+      localState = atomicGet(state);
+    }
+  }
+  if (localState == FILE_FAILED_TO_INITIALIZE) ThrowIllegalStateException();
+}
+
+void CallInitThreadLocal(int32_t* state, void (*init)()) {
+  int32_t localState = *state;
+  if (localState == FILE_INITIALIZED || localState == FILE_BEING_INITIALIZED) return;
+  if (localState == FILE_FAILED_TO_INITIALIZE) ThrowIllegalStateException();
+  *state = FILE_BEING_INITIALIZED;
+  runFileInitializer(state, init);
+  *state = FILE_INITIALIZED;
+}
+
 RUNTIME_NOTHROW void Kotlin_initRuntimeIfNeeded() {
   if (!isValidRuntime()) {
     initRuntime();
@@ -215,6 +292,18 @@ void Kotlin_shutdownRuntime() {
     auto* runtime = ::runtimeState;
     RuntimeAssert(runtime != kInvalidRuntime, "Current thread must have Kotlin runtime initialized on it");
 
+    // Explicitly added hooks run in every mode, while everything is still functional.
+    Kotlin_runShutdownHooks();
+
+    if (Kotlin_fastShutdownEnabled()) {
+        // The process is about to exit, so the memory doesn't have to be cleaned up: no final GC, no finalizers,
+        // no cleaners and no leak checks. The runtime of this thread is deliberately left alive.
+        konan::consoleFlush();
+        auto lastStatus = compareAndSwap(&globalRuntimeStatus, kGlobalRuntimeRunning, kGlobalRuntimeShutdown);
+        RuntimeAssert(lastStatus == kGlobalRuntimeRunning, "Invalid runtime status for shutdown");
+        return;
+    }
+
     bool needsFullShutdown = false;
     switch (Kotlin_getDestroyRuntimeMode()) {
         case DESTROY_RUNTIME_LEGACY:
@@ -377,6 +466,18 @@ void Kotlin_Debugging_setForceCheckedShutdown(KBoolean value) {
     g_forceCheckedShutdown = value;
 }
 
+bool Kotlin_fastShutdownEnabled() {
+    return g_fastShutdown && !g_forceCheckedShutdown;
+}
+
+KBoolean Kotlin_Shutdown_isFast() {
+    return g_fastShutdown;
+}
+
+void Kotlin_Shutdown_setFast(KBoolean value) {
+    g_fastShutdown = value;
+}
+
 KBoolean Kotlin_Debugging_isThreadStateRunnable() {
     return kotlin::GetThreadState() == kotlin::ThreadState::kRunnable;
 }
@@ -46,12 +46,25 @@ void Kotlin_shutdownRuntime();
 // Appends given node to an initializer list.
 void AppendToInitializersTail(struct InitNode*);
 
+// Lazily initializes globals of a file: runs `init` on the first call for the given `state` word, which must be
+// zero-initialized. Concurrent callers wait until `init` completes, while recursive calls from the thread running
+// `init` return immediately. If `init` throws, the exception is rethrown, and all subsequent calls throw
+// `IllegalStateException`. Globals registration with the memory manager happens inside `init`, i.e. on first access.
+// Used by the compiler with `-Xlazy-file-initialization`, which also resets `state` when the globals are deinitialized.
+void CallInitGlobalPossiblyLock(int32_t volatile* state, void (*init)());
+
+// Same for thread local globals of a file: `state` must be thread local too, so no synchronization is needed.
+void CallInitThreadLocal(int32_t* state, void (*init)());
+
 bool Kotlin_memoryLeakCheckerEnabled();
 
 bool Kotlin_cleanersLeakCheckerEnabled();
 
 bool Kotlin_forceCheckedShutdown();
 
+// Whether `Kotlin_shutdownRuntime` should skip all the cleanup and only run shutdown hooks and flush the console.
+bool Kotlin_fastShutdownEnabled();
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "Runtime.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "TestSupport.hpp"
+#include "Types.h"
+
+using namespace kotlin;
+
+namespace {
+
+testing::MockFunction<void()>* globalInit = nullptr;
+
+void initImpl() {
+    globalInit->Call();
+}
+
+class FileInitializationTest : public testing::Test {
+public:
+    FileInitializationTest() { globalInit = &init_; }
+    ~FileInitializationTest() { globalInit = nullptr; }
+
+    testing::MockFunction<void()>& init() { return init_; }
+
+private:
+    testing::StrictMock<testing::MockFunction<void()>> init_;
+};
+
+} // namespace
+
+TEST_F(FileInitializationTest, GlobalInitializedOnce) {
+    RunInNewThread([this] {
+        int32_t state = 0;
+        EXPECT_CALL(init(), Call());
+        CallInitGlobalPossiblyLock(&state, initImpl);
+        testing::Mock::VerifyAndClearExpectations(&init());
+
+        EXPECT_CALL(init(), Call()).Times(0);
+        CallInitGlobalPossiblyLock(&state, initImpl);
+    });
+}
+
+TEST_F(FileInitializationTest, GlobalRecursive) {
+    RunInNewThread([this] {
+        static int32_t state = 0;
+        EXPECT_CALL(init(), Call()).WillOnce([] { CallInitGlobalPossiblyLock(&state, initImpl); });
+        CallInitGlobalPossiblyLock(&state, initImpl);
+    });
+}
+
+TEST_F(FileInitializationTest, GlobalFailed) {
+    RunInNewThread([this] {
+        int32_t state = 0;
+        EXPECT_CALL(init(), Call()).WillOnce([] { throw std::runtime_error("init failed"); });
+        EXPECT_THROW(CallInitGlobalPossiblyLock(&state, initImpl), std::runtime_error);
+        testing::Mock::VerifyAndClearExpectations(&init());
+
+        EXPECT_CALL(init(), Call()).Times(0);
+        // `IllegalStateException` in the real runtime.
+        EXPECT_THROW(CallInitGlobalPossiblyLock(&state, initImpl), std::runtime_error);
+    });
+}
+
+TEST_F(FileInitializationTest, GlobalConcurrent) {
+    constexpr int kThreadCount = 4;
+    static int32_t state = 0;
+    std::atomic<bool> canStart(false);
+    std::atomic<int> initialized(0);
+    EXPECT_CALL(init(), Call()).WillOnce([] { std::this_thread::sleep_for(std::chrono::milliseconds(10)); });
+    KStdVector<std::thread> threads;
+    for (int i = 0; i < kThreadCount; ++i) {
+        threads.emplace_back([&] {
+            ScopedMemoryInit memory;
+            while (!canStart) {
+            }
+            CallInitGlobalPossiblyLock(&state, initImpl);
+            ++initialized;
+        });
+    }
+    canStart = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_THAT(initialized.load(), kThreadCount);
+}
+
+TEST_F(FileInitializationTest, ThreadLocal) {
+    int32_t state = 0;
+    EXPECT_CALL(init(), Call()).WillOnce([&state] { CallInitThreadLocal(&state, initImpl); });
+    CallInitThreadLocal(&state, initImpl);
+    testing::Mock::VerifyAndClearExpectations(&init());
+
+    EXPECT_CALL(init(), Call()).Times(0);
+    CallInitThreadLocal(&state, initImpl);
+}
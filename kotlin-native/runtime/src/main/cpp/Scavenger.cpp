@@ -0,0 +1,60 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "Scavenger.hpp"
+
+#include <atomic>
+
+#include "Porting.h"
+
+using namespace kotlin;
+
+namespace {
+
+constexpr uint64_t kDefaultScavengingIntervalMillis = 5 * 1000;
+
+std::atomic<uint64_t> g_scavengingIntervalMillis = kDefaultScavengingIntervalMillis;
+std::atomic<uint64_t> g_lastScavengeMillis = 0;
+void (*g_hookOverrideForTesting)() = nullptr;
+
+} // namespace
+
+std::atomic<uint64_t> kotlin::internal::scavengeEpoch = 0;
+
+void kotlin::ScavengeAfterCollection() noexcept {
+    auto interval = g_scavengingIntervalMillis.load(std::memory_order_relaxed);
+    auto now = konan::getTimeMillis();
+    auto last = g_lastScavengeMillis.load(std::memory_order_relaxed);
+    if (now - last < interval) return;
+    // Several threads may finish collections at once, only one of them needs to scavenge.
+    if (!g_lastScavengeMillis.compare_exchange_strong(last, now, std::memory_order_relaxed)) return;
+    ScavengeNow();
+}
+
+void kotlin::ScavengeNow() noexcept {
+    g_lastScavengeMillis.store(konan::getTimeMillis(), std::memory_order_relaxed);
+    internal::scavengeEpoch.fetch_add(1, std::memory_order_relaxed);
+    if (g_hookOverrideForTesting != nullptr) {
+        g_hookOverrideForTesting();
+        return;
+    }
+    konan::releaseFreeMemory();
+}
+
+void kotlin::SetScavengingIntervalMillis(uint64_t value) noexcept {
+    g_scavengingIntervalMillis.store(value, std::memory_order_relaxed);
+}
+
+uint64_t kotlin::GetScavengingIntervalMillis() noexcept {
+    return g_scavengingIntervalMillis.load(std::memory_order_relaxed);
+}
+
+size_t kotlin::GetCommittedBytes() noexcept {
+    return konan::getCommittedMemoryBytes();
+}
+
+void kotlin::SetScavengeHookForTesting(void (*hook)()) noexcept {
+    g_hookOverrideForTesting = hook;
+}
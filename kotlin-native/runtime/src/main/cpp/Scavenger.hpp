@@ -0,0 +1,47 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#ifndef RUNTIME_SCAVENGER_H
+#define RUNTIME_SCAVENGER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace kotlin {
+
+// Memory freed by the GC goes back to the allocator, which keeps it committed for future allocations.
+// Scavenging asks the allocator to return it to the OS. It is costly (both the call itself and page
+// faults when the memory is needed again), so it is done after a collection, but no more often than
+// once per scavenging interval.
+
+// Called by the GC after each collection (including finalization).
+void ScavengeAfterCollection() noexcept;
+
+// Return unused memory to the OS regardless of the interval.
+void ScavengeNow() noexcept;
+
+// 0 means scavenging after every collection.
+void SetScavengingIntervalMillis(uint64_t value) noexcept;
+uint64_t GetScavengingIntervalMillis() noexcept;
+
+namespace internal {
+extern std::atomic<uint64_t> scavengeEpoch;
+} // namespace internal
+
+// Allocator heaps owned by threads (see `konan::heap_collect`) can only be scavenged by their owners.
+// Each scavenge starts a new epoch, and owners collect their heaps when they see it at a safe point.
+inline uint64_t GetScavengeEpoch() noexcept {
+    return internal::scavengeEpoch.load(std::memory_order_relaxed);
+}
+
+// Memory the allocator has taken from the OS, 0 if the allocator cannot tell.
+size_t GetCommittedBytes() noexcept;
+
+void SetScavengeHookForTesting(void (*hook)()) noexcept;
+
+} // namespace kotlin
+
+#endif // RUNTIME_SCAVENGER_H
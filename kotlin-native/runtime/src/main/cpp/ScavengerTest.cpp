@@ -0,0 +1,66 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "Scavenger.hpp"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+using namespace kotlin;
+
+namespace {
+
+class ScavengerTest : public testing::Test {
+public:
+    ScavengerTest() {
+        scavengeHook_ = &scavengeHook();
+        SetScavengeHookForTesting([] { scavengeHook_->Call(); });
+    }
+
+    ~ScavengerTest() {
+        SetScavengeHookForTesting(nullptr);
+        SetScavengingIntervalMillis(interval_);
+        scavengeHook_ = nullptr;
+    }
+
+    testing::MockFunction<void()>& scavengeHook() { return scavengeHookMock_; }
+
+private:
+    static testing::MockFunction<void()>* scavengeHook_;
+
+    testing::StrictMock<testing::MockFunction<void()>> scavengeHookMock_;
+    uint64_t interval_ = GetScavengingIntervalMillis();
+};
+
+// static
+testing::MockFunction<void()>* ScavengerTest::scavengeHook_ = nullptr;
+
+} // namespace
+
+TEST_F(ScavengerTest, ScavengeAfterEveryCollection) {
+    SetScavengingIntervalMillis(0);
+
+    EXPECT_CALL(scavengeHook(), Call()).Times(2);
+    ScavengeAfterCollection();
+    ScavengeAfterCollection();
+}
+
+TEST_F(ScavengerTest, ScavengeOncePerInterval) {
+    SetScavengingIntervalMillis(1000 * 1000 * 1000);
+
+    EXPECT_CALL(scavengeHook(), Call());
+    ScavengeNow();
+    testing::Mock::VerifyAndClearExpectations(&scavengeHook());
+
+    EXPECT_CALL(scavengeHook(), Call()).Times(0);
+    ScavengeAfterCollection();
+}
+
+TEST_F(ScavengerTest, ScavengeNeverAfterCollection) {
+    SetScavengingIntervalMillis(INT64_MAX);
+
+    EXPECT_CALL(scavengeHook(), Call()).Times(0);
+    ScavengeAfterCollection();
+}
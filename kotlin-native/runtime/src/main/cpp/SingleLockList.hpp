@@ -95,6 +95,12 @@ public:
     template <typename... Args>
     Node* Emplace(Args&&... args) noexcept {
         auto* nodePtr = new Node(std::forward<Args>(args)...);
+        Insert(nodePtr);
+        return nodePtr;
+    }
+
+    // Links `node` obtained from `Extract` back into the list.
+    void Insert(Node* nodePtr) noexcept {
         NodeOwner node(nodePtr);
         std::lock_guard<Mutex> guard(mutex_);
         AssertCorrectUnsafe();
@@ -106,34 +112,42 @@ public:
         node->next_ = std::move(root_);
         root_ = std::move(node);
         AssertCorrectUnsafe();
-        return nodePtr;
     }
 
     // Using `node` including its referred `Value` after `Erase` is undefined behaviour.
-    void Erase(Node* node) noexcept {
+    void Erase(Node* node) noexcept { Destroy(Extract(node)); }
+
+    // Unlinks `node` from the list without destroying it. The caller owns the node until it is
+    // either linked back with `Insert` or destroyed with `Destroy`.
+    Node* Extract(Node* node) noexcept {
         std::lock_guard<Mutex> guard(mutex_);
         AssertCorrectUnsafe();
         if (last_ == node) {
             last_ = node->previous_;
         }
+        NodeOwner ownedNode;
         if (root_.get() == node) {
+            ownedNode = std::move(root_);
             root_ = std::move(node->next_);
             if (root_) {
                 root_->previous_ = nullptr;
             }
-            AssertCorrectUnsafe();
-            return;
-        }
-        auto* previous = node->previous_;
-        RuntimeAssert(previous != nullptr, "Only the root node doesn't have the previous node");
-        auto ownedNode = std::move(previous->next_);
-        previous->next_ = std::move(node->next_);
-        if (auto& next = previous->next_) {
-            next->previous_ = previous;
+        } else {
+            auto* previous = node->previous_;
+            RuntimeAssert(previous != nullptr, "Only the root node doesn't have the previous node");
+            ownedNode = std::move(previous->next_);
+            previous->next_ = std::move(node->next_);
+            if (auto& next = previous->next_) {
+                next->previous_ = previous;
+            }
         }
+        node->previous_ = nullptr;
         AssertCorrectUnsafe();
+        return ownedNode.release();
     }
 
+    static void Destroy(Node* node) noexcept { delete node; }
+
     // Returned value locks `this` to perform safe iteration. `this` unlocks when
     // `Iterable` gets out of scope. Example usage:
     // for (auto& value: list.Iter()) {
@@ -106,6 +106,35 @@ TEST(SingleLockListTest, EraseToEmptyEmplaceAndIter) {
     EXPECT_THAT(actual, testing::ElementsAre(kFourth, kThird));
 }
 
+TEST(SingleLockListTest, ExtractAndInsert) {
+    IntList list;
+    constexpr int kFirst = 1;
+    constexpr int kSecond = 2;
+    constexpr int kThird = 3;
+    auto* firstNode = list.Emplace(kFirst);
+    auto* secondNode = list.Emplace(kSecond);
+    auto* thirdNode = list.Emplace(kThird);
+
+    EXPECT_THAT(list.Extract(secondNode), secondNode);
+    EXPECT_THAT(list.Extract(thirdNode), thirdNode);
+    EXPECT_THAT(list.Extract(firstNode), firstNode);
+
+    KStdVector<int> actual;
+    for (int element : list.Iter()) {
+        actual.push_back(element);
+    }
+    EXPECT_THAT(actual, testing::IsEmpty());
+
+    list.Insert(firstNode);
+    list.Insert(secondNode);
+    IntList::Destroy(thirdNode);
+
+    for (int element : list.Iter()) {
+        actual.push_back(element);
+    }
+    EXPECT_THAT(actual, testing::ElementsAre(kSecond, kFirst));
+}
+
 TEST(SingleLockListTest, ConcurrentEmplace) {
     IntList list;
     constexpr int kThreadCount = kDefaultThreadCount;
@@ -0,0 +1,235 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#ifndef RUNTIME_TIMER_WHEEL_H
+#define RUNTIME_TIMER_WHEEL_H
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <list>
+
+#include "Types.h"
+#include "Utils.hpp"
+
+namespace kotlin {
+
+// Hierarchical timer wheel: values scheduled at some time in microseconds. `Insert` and `Cancel` are O(1),
+// `Expire` is O(1) per expired value and per occupied slot passed.
+//
+// Times are split into ticks of `kTickMicroseconds`, and a tick number into `kLevels` digits of `kSlotBits` bits.
+// A value is kept at the lowest level, above which the digits of its tick are the same as the current tick's.
+// When the current tick reaches a slot of a higher level, values of this slot are moved to the lower levels.
+// Values too far in the future are kept in a separate overflow list.
+template <typename T>
+class TimerWheel : private Pinned {
+    struct Entry;
+
+public:
+    static constexpr uint64_t kTickMicroseconds = 1000;
+
+    class Handle {
+    public:
+        Handle() noexcept = default;
+
+    private:
+        friend class TimerWheel;
+
+        explicit Handle(typename KStdList<Entry>::iterator position) noexcept : position_(position) {}
+
+        typename KStdList<Entry>::iterator position_;
+    };
+
+    explicit TimerWheel(uint64_t nowMicroseconds) noexcept : current_(nowMicroseconds / kTickMicroseconds) {}
+
+    // `when` in the past is fine: the value expires on the next `Expire`.
+    Handle Insert(uint64_t whenMicroseconds, const T& value) noexcept {
+        KStdList<Entry> entry;
+        entry.push_back(Entry{whenMicroseconds, value});
+        auto position = entry.begin();
+        Place(entry, position);
+        ++size_;
+        return Handle(position);
+    }
+
+    // Returns the value of `handle`, which must not be expired or cancelled yet.
+    T Cancel(Handle handle) noexcept {
+        T value = handle.position_->value;
+        uint32_t level = handle.position_->level;
+        uint32_t slot = handle.position_->slot;
+        if (level == kLevels) {
+            overflow_.erase(handle.position_);
+        } else {
+            slots_[level][slot].erase(handle.position_);
+            ClearIfEmpty(level, slot);
+        }
+        --size_;
+        return value;
+    }
+
+    // Calls `f` for every value scheduled not later than `nowMicroseconds`, and removes them. The values are
+    // passed in the order of their times, and the ones with the same time in the order of `Insert`.
+    template <typename F>
+    void Expire(uint64_t nowMicroseconds, F&& f) {
+        uint64_t now = nowMicroseconds / kTickMicroseconds;
+        if (size_ == 0) {
+            if (now > current_) current_ = now;
+            return;
+        }
+        while (current_ < now) {
+            // Everything in the current slot is due.
+            KStdList<Entry> due;
+            due.splice(due.end(), slots_[0][current_ & kSlotMask]);
+            occupancy_[0] &= ~(uint64_t(1) << (current_ & kSlotMask));
+            ExpireAll(due, f);
+            current_ = std::min(NextEventTick(), now);
+            Cascade();
+        }
+        // And only some of the values in the current one.
+        KStdList<Entry> due;
+        auto& slot = slots_[0][current_ & kSlotMask];
+        for (auto it = slot.begin(); it != slot.end();) {
+            auto next = std::next(it);
+            if (it->when <= nowMicroseconds) {
+                due.splice(due.end(), slot, it);
+            }
+            it = next;
+        }
+        ClearIfEmpty(0, current_ & kSlotMask);
+        ExpireAll(due, f);
+    }
+
+    // Returns microseconds to wait from `nowMicroseconds` before calling `Expire` again, or -1 if there are no values.
+    // Must be called right after `Expire` with the same `nowMicroseconds`. May be less than the time to the earliest value.
+    int64_t NextExpiration(uint64_t nowMicroseconds) const noexcept {
+        if (size_ == 0) return -1;
+        auto& slot = slots_[0][current_ & kSlotMask];
+        if (!slot.empty()) {
+            uint64_t earliest = slot.front().when;
+            for (auto& entry : slot) {
+                earliest = std::min(earliest, entry.when);
+            }
+            return earliest - nowMicroseconds;
+        }
+        return NextEventTick() * kTickMicroseconds - nowMicroseconds;
+    }
+
+    bool Empty() const noexcept { return size_ == 0; }
+
+    size_t Size() const noexcept { return size_; }
+
+    template <typename F>
+    void ForEach(F&& f) const {
+        for (auto& level : slots_) {
+            for (auto& slot : level) {
+                for (auto& entry : slot) {
+                    f(entry.value);
+                }
+            }
+        }
+        for (auto& entry : overflow_) {
+            f(entry.value);
+        }
+    }
+
+private:
+    static constexpr size_t kSlotBits = 6;
+    static constexpr size_t kSlotCount = 1 << kSlotBits;
+    static constexpr uint64_t kSlotMask = kSlotCount - 1;
+    static constexpr size_t kLevels = 4;
+
+    struct Entry {
+        uint64_t when;
+        T value;
+        // The list the entry is in: `overflow_` if `level == kLevels`.
+        uint32_t level = 0;
+        uint32_t slot = 0;
+    };
+
+    // A slot of level 0 keeps the values of a tick in the order they came in, so sort them by time first.
+    template <typename F>
+    void ExpireAll(KStdList<Entry>& due, F&& f) {
+        // `sort` of a list is stable.
+        due.sort([](const Entry& lhs, const Entry& rhs) { return lhs.when < rhs.when; });
+        size_ -= due.size();
+        for (auto& entry : due) {
+            f(entry.value);
+        }
+    }
+
+    static uint64_t Digit(uint64_t tick, size_t level) noexcept { return (tick >> (kSlotBits * level)) & kSlotMask; }
+
+    void ClearIfEmpty(size_t level, uint64_t slot) noexcept {
+        if (slots_[level][slot].empty()) {
+            occupancy_[level] &= ~(uint64_t(1) << slot);
+        }
+    }
+
+    // Moves `position` from `from` into the list it belongs to now.
+    void Place(KStdList<Entry>& from, typename KStdList<Entry>::iterator position) noexcept {
+        uint64_t tick = std::max(position->when / kTickMicroseconds, current_);
+        size_t level = 0;
+        while (level < kLevels && (tick >> (kSlotBits * (level + 1))) != (current_ >> (kSlotBits * (level + 1)))) {
+            ++level;
+        }
+        position->level = level;
+        if (level == kLevels) {
+            overflow_.splice(overflow_.end(), from, position);
+            return;
+        }
+        position->slot = Digit(tick, level);
+        slots_[level][position->slot].splice(slots_[level][position->slot].end(), from, position);
+        occupancy_[level] |= uint64_t(1) << position->slot;
+    }
+
+    // The first tick after `current_`, when some slot becomes due: either a slot of level 0 to expire,
+    // or a slot of a higher level to move down.
+    uint64_t NextEventTick() const noexcept {
+        // The overflow list is checked when the highest level wraps around.
+        uint64_t result = ((current_ >> (kSlotBits * kLevels)) + 1) << (kSlotBits * kLevels);
+        for (size_t level = 0; level < kLevels; ++level) {
+            uint64_t digit = Digit(current_, level);
+            // Slots before and at the current digit are empty above level 0, and the current slot of level 0 is
+            // handled separately.
+            uint64_t later = digit == kSlotMask ? 0 : occupancy_[level] & (~uint64_t(0) << (digit + 1));
+            if (later == 0) continue;
+            uint64_t shift = kSlotBits * level;
+            uint64_t tick = (((current_ >> shift) & ~kSlotMask) | __builtin_ctzll(later)) << shift;
+            result = std::min(result, tick);
+        }
+        return result;
+    }
+
+    // Moves values from the slots that have just become current down to the lower levels.
+    void Cascade() noexcept {
+        if (current_ % (uint64_t(1) << (kSlotBits * kLevels)) == 0 && !overflow_.empty()) {
+            KStdList<Entry> overflow;
+            overflow.splice(overflow.end(), overflow_);
+            while (!overflow.empty()) {
+                Place(overflow, overflow.begin());
+            }
+        }
+        for (size_t level = kLevels - 1; level > 0; --level) {
+            if (current_ % (uint64_t(1) << (kSlotBits * level)) != 0) continue;
+            uint64_t digit = Digit(current_, level);
+            if ((occupancy_[level] & (uint64_t(1) << digit)) == 0) continue;
+            auto& slot = slots_[level][digit];
+            occupancy_[level] &= ~(uint64_t(1) << digit);
+            while (!slot.empty()) {
+                Place(slot, slot.begin());
+            }
+        }
+    }
+
+    uint64_t current_;
+    size_t size_ = 0;
+    KStdList<Entry> slots_[kLevels][kSlotCount];
+    uint64_t occupancy_[kLevels] = {};
+    KStdList<Entry> overflow_;
+};
+
+} // namespace kotlin
+
+#endif // RUNTIME_TIMER_WHEEL_H
@@ -0,0 +1,172 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "TimerWheel.hpp"
+
+#include <random>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "Types.h"
+
+using namespace kotlin;
+
+using testing::ElementsAre;
+
+namespace {
+
+template <typename T>
+KStdVector<T> Expire(TimerWheel<T>& wheel, uint64_t now) {
+    KStdVector<T> result;
+    wheel.Expire(now, [&result](const T& value) { result.push_back(value); });
+    return result;
+}
+
+constexpr uint64_t kStart = 123456789;
+
+} // namespace
+
+TEST(TimerWheelTest, Empty) {
+    TimerWheel<int> wheel(kStart);
+    EXPECT_TRUE(wheel.Empty());
+    EXPECT_THAT(Expire(wheel, kStart + 1000000), ElementsAre());
+    EXPECT_THAT(wheel.NextExpiration(kStart + 1000000), -1);
+}
+
+TEST(TimerWheelTest, ExpireInOrder) {
+    TimerWheel<int> wheel(kStart);
+    wheel.Insert(kStart + 5000, 3);
+    wheel.Insert(kStart + 10, 1);
+    wheel.Insert(kStart + 300, 2);
+    wheel.Insert(kStart - 10, 0);
+    EXPECT_THAT(wheel.Size(), 4);
+
+    EXPECT_THAT(Expire(wheel, kStart), ElementsAre(0));
+    EXPECT_THAT(Expire(wheel, kStart + 9), ElementsAre());
+    EXPECT_THAT(Expire(wheel, kStart + 300), ElementsAre(1, 2));
+    EXPECT_THAT(Expire(wheel, kStart + 4999), ElementsAre());
+    EXPECT_THAT(Expire(wheel, kStart + 5000), ElementsAre(3));
+    EXPECT_TRUE(wheel.Empty());
+}
+
+TEST(TimerWheelTest, ExpireInOrderWithinTick) {
+    TimerWheel<int> wheel(kStart);
+    // All in the same tick as `kStart + 2000`, inserted out of order.
+    uint64_t tick = (kStart + 2000) / TimerWheel<int>::kTickMicroseconds * TimerWheel<int>::kTickMicroseconds;
+    wheel.Insert(tick + 900, 4);
+    wheel.Insert(tick + 100, 1);
+    wheel.Insert(tick + 500, 2);
+    wheel.Insert(tick + 500, 3);
+    wheel.Insert(tick - 5000, 0);
+
+    // The whole tick is due.
+    EXPECT_THAT(Expire(wheel, tick + 5000), ElementsAre(0, 1, 2, 3, 4));
+    EXPECT_TRUE(wheel.Empty());
+
+    // Only a part of the current tick is due.
+    tick += 10000;
+    wheel.Insert(tick + 900, 4);
+    wheel.Insert(tick + 100, 1);
+    wheel.Insert(tick + 700, 3);
+    wheel.Insert(tick + 300, 2);
+    EXPECT_THAT(Expire(wheel, tick), ElementsAre());
+    EXPECT_THAT(Expire(wheel, tick + 700), ElementsAre(1, 2, 3));
+    EXPECT_THAT(Expire(wheel, tick + 900), ElementsAre(4));
+    EXPECT_TRUE(wheel.Empty());
+}
+
+TEST(TimerWheelTest, NextExpiration) {
+    TimerWheel<int> wheel(kStart);
+    wheel.Insert(kStart + 500, 1);
+    wheel.Insert(kStart + 10000000, 2);
+
+    EXPECT_THAT(Expire(wheel, kStart), ElementsAre());
+    auto next = wheel.NextExpiration(kStart);
+    EXPECT_GT(next, 0);
+    EXPECT_LE(next, 500);
+
+    // Never later than the earliest value, waiting for the returned time always makes progress.
+    uint64_t now = kStart + 500;
+    EXPECT_THAT(Expire(wheel, now), ElementsAre(1));
+    int steps = 0;
+    while (!wheel.Empty()) {
+        next = wheel.NextExpiration(now);
+        EXPECT_GT(next, 0);
+        now += next;
+        EXPECT_LE(now, kStart + 10000000);
+        Expire(wheel, now);
+        ++steps;
+    }
+    EXPECT_THAT(now, kStart + 10000000);
+    // Just a few slots to pass at every level.
+    EXPECT_LT(steps, 10);
+}
+
+TEST(TimerWheelTest, Cancel) {
+    TimerWheel<int> wheel(kStart);
+    auto near = wheel.Insert(kStart + 100, 1);
+    wheel.Insert(kStart + 200, 2);
+    auto far = wheel.Insert(kStart + 100000000, 3);
+    auto veryFar = wheel.Insert(kStart + 100000000000000, 4);
+
+    EXPECT_THAT(wheel.Cancel(near), 1);
+    EXPECT_THAT(wheel.Cancel(far), 3);
+    EXPECT_THAT(wheel.Cancel(veryFar), 4);
+    EXPECT_THAT(wheel.Size(), 1);
+    EXPECT_THAT(Expire(wheel, kStart + 1000000000000000), ElementsAre(2));
+    EXPECT_TRUE(wheel.Empty());
+}
+
+TEST(TimerWheelTest, CancelAfterCascade) {
+    TimerWheel<int> wheel(kStart);
+    auto handle = wheel.Insert(kStart + 70000000, 1);
+    wheel.Insert(kStart + 70000001, 2);
+
+    // Moves both values down to the lower levels.
+    EXPECT_THAT(Expire(wheel, kStart + 69999000), ElementsAre());
+    EXPECT_THAT(wheel.Cancel(handle), 1);
+    EXPECT_THAT(Expire(wheel, kStart + 70000001), ElementsAre(2));
+}
+
+TEST(TimerWheelTest, ForEach) {
+    TimerWheel<int> wheel(kStart);
+    wheel.Insert(kStart, 1);
+    wheel.Insert(kStart + 1000000, 2);
+    wheel.Insert(kStart + 100000000000000, 3);
+
+    KStdVector<int> values;
+    wheel.ForEach([&values](int value) { values.push_back(value); });
+    std::sort(values.begin(), values.end());
+    EXPECT_THAT(values, ElementsAre(1, 2, 3));
+}
+
+TEST(TimerWheelTest, Random) {
+    std::mt19937_64 random(42);
+    TimerWheel<std::pair<uint64_t, int>> wheel(kStart);
+    KStdVector<uint64_t> whens;
+    constexpr int kCount = 10000;
+    for (int i = 0; i < kCount; ++i) {
+        // Spread over all the levels, and some into the overflow.
+        uint64_t delay = random() >> (random() % 64);
+        uint64_t when = kStart + delay % 1000000000000000;
+        wheel.Insert(when, std::make_pair(when, i));
+        whens.push_back(when);
+    }
+    std::sort(whens.begin(), whens.end());
+
+    size_t expired = 0;
+    uint64_t last = 0;
+    for (uint64_t now : whens) {
+        wheel.Expire(now, [&](const std::pair<uint64_t, int>& value) {
+            EXPECT_LE(value.first, now);
+            EXPECT_GE(value.first, last);
+            last = value.first;
+            ++expired;
+        });
+        EXPECT_THAT(expired, static_cast<size_t>(std::upper_bound(whens.begin(), whens.end(), now) - whens.begin()));
+    }
+    EXPECT_TRUE(wheel.Empty());
+}
@@ -18,21 +18,47 @@
 #define WITH_WORKERS 1
 #endif
 
+#if WITH_WORKERS && (KONAN_LINUX || KONAN_ANDROID)
+// Parked workers may wait for file descriptors too.
+#define WITH_EPOLL 1
+#endif
+
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
 #if WITH_WORKERS
+#include <limits.h>
 #include <pthread.h>
 #include "PthreadUtils.h"
+#if !KONAN_WINDOWS
+#include <unistd.h>
+#endif
+#endif
+
+#if WITH_EPOLL
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 #endif
 
 #include "Alloc.h"
 #include "Exceptions.h"
+#include "KString.h"
 #include "KAssert.h"
 #include "Memory.h"
+#include "MPSCQueue.hpp"
+#include "Mutex.hpp"
+#include "Natives.h"
 #include "ObjCMMAPI.h"
 #include "Runtime.h"
+#include "TimerWheel.hpp"
 #include "Types.h"
 #include "Worker.h"
 
@@ -43,6 +69,8 @@ extern "C" {
 RUNTIME_NORETURN void ThrowWorkerInvalidState();
 RUNTIME_NORETURN void ThrowWorkerUnsupported();
 OBJ_GETTER(WorkerLaunchpad, KRef);
+OBJ_GETTER(WorkerBatchLaunchpad, KRef, KInt);
+OBJ_GETTER(WorkerLambdaJobLaunchpad, KRef);
 
 }  // extern "C"
 
@@ -51,6 +79,7 @@ OBJ_GETTER(WorkerLaunchpad, KRef);
 namespace {
 
 class Future;
+class WorkerPool;
 
 enum {
   INVALID = 0,
@@ -72,6 +101,8 @@ enum JobKind {
   // processed for APIs returning request process status.
   JOB_REGULAR = 2,
   JOB_EXECUTE_AFTER = 3,
+  // Same as JOB_REGULAR, but no one waits for the result.
+  JOB_DETACHED = 4,
 };
 
 enum class WorkerKind {
@@ -97,18 +128,139 @@ struct Job {
     struct {
       KNativePtr operation;
       uint64_t whenExecute;
+      // 0 if the job cannot be cancelled.
+      KLong cancellationKey;
     } executeAfter;
+
+    struct {
+      KRef (*function)(KRef, ObjHeader**);
+      KNativePtr argument;
+    } detachedJob;
   };
 };
 
-struct JobCompare {
-  bool operator() (const Job& lhs, const Job& rhs) const {
-    RuntimeAssert(lhs.kind == JOB_EXECUTE_AFTER && rhs.kind == JOB_EXECUTE_AFTER, "Must be delayed jobs");
-    return lhs.executeAfter.whenExecute < rhs.executeAfter.whenExecute;
+typedef TimerWheel<Job> DelayedJobSet;
+
+// Options applied to the thread of a worker when it starts, before the runtime is initialized on it.
+struct WorkerThreadOptions {
+  // 0 means the platform default.
+  size_t stackSize = 0;
+  // Empty means any CPU.
+  KStdVector<int32_t> cpus;
+  bool hasNice = false;
+  int32_t nice = 0;
+  // Empty means the platform default.
+  KStdString threadName;
+};
+
+#if WITH_EPOLL
+
+// File descriptors watched by a parked worker, along with an eventfd to wake it up when a job arrives.
+class FileDescriptorWatcher : private Pinned, public KonanAllocatorAware {
+ public:
+  // Returns `nullptr` if the system is out of file descriptors.
+  static FileDescriptorWatcher* create() {
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) return nullptr;
+    int eventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = eventFd;
+    if (eventFd < 0 || epoll_ctl(epollFd, EPOLL_CTL_ADD, eventFd, &event) != 0) {
+      if (eventFd >= 0) close(eventFd);
+      close(epollFd);
+      return nullptr;
+    }
+    return new FileDescriptorWatcher(epollFd, eventFd);
+  }
+
+  ~FileDescriptorWatcher() {
+    close(epollFd_);
+    close(eventFd_);
+  }
+
+  bool add(int fd, bool readable, bool writable) {
+    if (fd == eventFd_) return false;
+    epoll_event event = {};
+    event.events = (readable ? EPOLLIN : 0) | (writable ? EPOLLOUT : 0);
+    event.data.fd = fd;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) == 0) {
+      ++count_;
+      return true;
+    }
+    // Already watched, just different events.
+    return errno == EEXIST && epoll_ctl(epollFd_, EPOLL_CTL_MOD, fd, &event) == 0;
+  }
+
+  bool remove(int fd) {
+    if (fd == eventFd_ || epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr) != 0) return false;
+    --count_;
+    return true;
+  }
+
+  bool empty() const { return count_ == 0; }
+
+  // Wakes up `wait`. Can be called from any thread.
+  void signal() {
+    uint64_t one = 1;
+    // Cannot fail but on counter overflow, which is a pending wakeup as well.
+    (void)write(eventFd_, &one, sizeof(one));
+  }
+
+  // Waits for readiness of the watched file descriptors or `signal`, negative timeout means forever.
+  // Returns `true` if some file descriptors are ready, these are `ready()` then.
+  bool wait(KLong timeoutMicroseconds) {
+    ready_.clear();
+    int timeoutMilliseconds = timeoutMicroseconds < 0
+        ? -1
+        : static_cast<int>(std::min<KLong>((timeoutMicroseconds + 999) / 1000, INT_MAX));
+    epoll_event events[kMaxEvents];
+    int count = epoll_wait(epollFd_, events, kMaxEvents, timeoutMilliseconds);
+    for (int i = 0; i < count; ++i) {
+      if (events[i].data.fd == eventFd_) {
+        uint64_t value;
+        (void)read(eventFd_, &value, sizeof(value));
+      } else {
+        ready_.push_back(events[i].data.fd);
+      }
+    }
+    return !ready_.empty();
   }
+
+  const KStdVector<KInt>& ready() const { return ready_; }
+
+  void clearReady() { ready_.clear(); }
+
+ private:
+  static constexpr int kMaxEvents = 64;
+
+  FileDescriptorWatcher(int epollFd, int eventFd) : epollFd_(epollFd), eventFd_(eventFd) {}
+
+  int epollFd_;
+  int eventFd_;
+  size_t count_ = 0;
+  KStdVector<KInt> ready_;
+};
+
+#else
+
+// Watching file descriptors is not supported, `create` always fails.
+class FileDescriptorWatcher : private Pinned, public KonanAllocatorAware {
+ public:
+  static FileDescriptorWatcher* create() { return nullptr; }
+  bool add(int fd, bool readable, bool writable) { return false; }
+  bool remove(int fd) { return false; }
+  bool empty() const { return true; }
+  void signal() {}
+  bool wait(KLong timeoutMicroseconds) { return false; }
+  const KStdVector<KInt>& ready() const { return ready_; }
+  void clearReady() {}
+
+ private:
+  KStdVector<KInt> ready_;
 };
 
-typedef KStdOrderedSet<Job, JobCompare> DelayedJobSet;
+#endif  // WITH_EPOLL
 
 }  // namespace
 
@@ -117,6 +269,7 @@ class Worker {
   Worker(KInt id, bool errorReporting, KRef customName, WorkerKind kind)
       : id_(id),
         kind_(kind),
+        delayed_(konan::getTimeMicros()),
         errorReporting_(errorReporting) {
     name_ = customName != nullptr ? CreateStablePointer(customName) : nullptr;
     pthread_mutex_init(&lock_, nullptr);
@@ -128,7 +281,11 @@ class Worker {
   void startEventLoop();
 
   void putJob(Job job, bool toFront);
+  void putJobs(const KStdVector<Job>& jobs);
   void putDelayedJob(Job job);
+  // Returns the operation of the cancelled job, or `nullptr` if there's no delayed job with `key`: it's due
+  // already, or was cancelled before.
+  KNativePtr cancelDelayedJob(KLong key);
 
   bool waitDelayed(bool blocking);
 
@@ -136,12 +293,23 @@ class Worker {
 
   KLong checkDelayedLocked();
 
-  bool waitForQueueLocked(KLong timeoutMicroseconds, KLong* remaining);
+  // With `watchFileDescriptors`, also returns `true` when some of the watched file descriptors are ready.
+  bool waitForQueueLocked(KLong timeoutMicroseconds, KLong* remaining, bool watchFileDescriptors = false);
+
+  bool hasJobs() const;
 
   JobKind processQueueElement(bool blocking);
 
+  JobKind processJob(Job job, bool blocking);
+
   bool park(KLong timeoutMicroseconds, bool process);
 
+  // File descriptors watched by `park`. Only called by the worker itself.
+  bool watchFileDescriptor(KInt fd, bool readable, bool writable);
+  bool unwatchFileDescriptor(KInt fd);
+  // Found ready by the last `park`.
+  const KStdVector<KInt>& readyFileDescriptors() const;
+
   KInt id() const { return id_; }
 
   bool errorReporting() const { return errorReporting_; }
@@ -154,7 +322,30 @@ class Worker {
 
   MemoryState* memoryState() { return memoryState_; }
 
+  WorkerPool* pool() const { return pool_; }
+
+  size_t poolIndex() const { return poolIndex_; }
+
+  void setPool(WorkerPool* pool, size_t index) {
+    pool_ = pool;
+    poolIndex_ = index;
+  }
+
+  const WorkerThreadOptions& threadOptions() const { return threadOptions_; }
+
+  void setThreadOptions(WorkerThreadOptions options) { threadOptions_ = std::move(options); }
+
+  bool isWaiting() const { return waiting_.load(); }
+
+  void wakeUp();
+
  private:
+  // Wakes up the worker waiting for the queue.
+  void signalLocked();
+
+  // Waits for the watched file descriptors or `signalLocked`, with `lock_` released.
+  bool pollLocked(KLong timeoutMicroseconds);
+
   void setThread(pthread_t thread) {
     // For workers started using the Worker API, we set thread_ in startEventLoop when calling pthread_create.
     // But we also set thread_ in WorkerInit to handle the main thread and threads calling Kotlin from native code.
@@ -174,20 +365,38 @@ class Worker {
 
   KInt id_;
   WorkerKind kind_;
-  KStdDeque<Job> queue_;
+  // Regular jobs are put here without taking `lock_`.
+  MPSCQueue<Job> queue_;
+  // Jobs to be processed before anything in `queue_`. Guarded by `lock_`.
+  KStdDeque<Job> frontJobs_;
+  std::atomic<size_t> frontJobsCount_ = 0;
+  // Guarded by `lock_`.
   DelayedJobSet delayed_;
+  // Jobs in `delayed_` that can be cancelled, by their keys. Guarded by `lock_`.
+  KStdUnorderedMap<KLong, DelayedJobSet::Handle> cancellableDelayed_;
   // Stable pointer with worker's name.
   KNativePtr name_;
-  // Lock and condition for waiting on the queue.
+  // Lock and condition for waiting on the queue. Only the worker itself, delayed jobs and front jobs take
+  // the lock, while producers of regular jobs only take it to wake up the worker, if it's waiting on `cond_`.
   pthread_mutex_t lock_;
   pthread_cond_t cond_;
+  std::atomic<bool> waiting_ = false;
   // If errors to be reported on console.
   bool errorReporting_;
   bool terminated_ = false;
   pthread_t thread_ = 0;
+  // Only used by startEventLoop and the worker thread itself.
+  WorkerThreadOptions threadOptions_;
+  // Created on the first watched file descriptor. Guarded by `lock_`.
+  FileDescriptorWatcher* watcher_ = nullptr;
+  // If the worker waits in `watcher_` rather than on `cond_`. Guarded by `lock_`.
+  bool polling_ = false;
   // MemoryState for worker's thread.
   // We set it in WorkerInit and use to correctly switch thread states in woker's destructor.
   MemoryState* memoryState_ = nullptr;
+  // The pool this worker is a member of, if any. Reset when the worker terminates.
+  WorkerPool* pool_ = nullptr;
+  size_t poolIndex_ = 0;
 };
 
 #endif  // WITH_WORKERS
@@ -244,6 +453,55 @@ private:
     pthread_mutex_t* lock_;
 };
 
+// Someone waiting for any of several futures to complete. Registered in each of the futures.
+class FutureWaiter : private Pinned {
+ public:
+  FutureWaiter() {
+    pthread_mutex_init(&lock_, nullptr);
+    pthread_cond_init(&cond_, nullptr);
+  }
+
+  ~FutureWaiter() {
+    pthread_mutex_destroy(&lock_);
+    pthread_cond_destroy(&cond_);
+  }
+
+  void signal(MemoryState* memoryState) {
+    Locker locker(&lock_, memoryState);
+    signaled_ = true;
+    pthread_cond_signal(&cond_);
+  }
+
+  void signal() {
+    Locker locker(&lock_);
+    signaled_ = true;
+    pthread_cond_signal(&cond_);
+  }
+
+  void wait(KInt millis) {
+    Locker locker(&lock_);
+    if (signaled_) return;
+    if (millis < 0) {
+      while (!signaled_) {
+        waitInNativeState(&cond_, &lock_);
+      }
+      return;
+    }
+    // Loop on spurious wakeups until signaled or the deadline passes.
+    uint64_t deadline = konan::getTimeMicros() + millis * 1000LL;
+    while (!signaled_) {
+      uint64_t now = konan::getTimeMicros();
+      if (now >= deadline) return;
+      waitInNativeState(&cond_, &lock_, (deadline - now) * 1000LL);
+    }
+  }
+
+ private:
+  pthread_mutex_t lock_;
+  pthread_cond_t cond_;
+  bool signaled_ = false;
+};
+
 class Future {
  public:
   Future(KInt id) : state_(SCHEDULED), id_(id) {
@@ -283,6 +541,20 @@ class Future {
 
   void cancelUnlocked(MemoryState* memoryState);
 
+  // Returns `false` if the future is already completed, and `waiter` was not added.
+  bool addWaiterUnlocked(FutureWaiter* waiter) {
+    Locker locker(&lock_);
+    if (state_ != SCHEDULED) return false;
+    waiters_.push_back(waiter);
+    return true;
+  }
+
+  void removeWaiterUnlocked(FutureWaiter* waiter) {
+    Locker locker(&lock_);
+    auto it = std::find(waiters_.begin(), waiters_.end(), waiter);
+    if (it != waiters_.end()) waiters_.erase(it);
+  }
+
   // Those are called with the lock taken.
   KInt state() const { return state_; }
   KInt id() const { return id_; }
@@ -297,46 +569,289 @@ class Future {
   // Lock and condition for waiting on the future.
   pthread_mutex_t lock_;
   pthread_cond_t cond_;
+  // Waiters for several futures, including this one. Only they are notified when this future completes.
+  KStdVector<FutureWaiter*> waiters_;
+};
+
+// Fixed set of workers sharing the jobs submitted to the pool. Every member has its own deque of jobs:
+// a member takes jobs from the back of its own deque, and steals from the front of the others' deques
+// when its own one is empty. Jobs submitted by a member go to its own deque, others are spread round-robin.
+class WorkerPool : private Pinned {
+ public:
+  WorkerPool(KInt id, bool errorReporting, KRef customName) : id_(id), errorReporting_(errorReporting) {
+    name_ = customName != nullptr ? CreateStablePointer(customName) : nullptr;
+    pthread_mutex_init(&lock_, nullptr);
+  }
+
+  ~WorkerPool() {
+    for (auto* member : members_) {
+      konanDestructInstance(member);
+    }
+    pthread_mutex_destroy(&lock_);
+  }
+
+  // Must be called before the members are started.
+  void addMember(Worker* worker) {
+    Member* member = konanConstructInstance<Member>();
+    member->worker = worker;
+    worker->setPool(this, members_.size());
+    members_.push_back(member);
+  }
+
+  void putJob(Job job) {
+    Worker* current = ::g_worker;
+    size_t index = current != nullptr && current->pool() == this
+        ? current->poolIndex()
+        : nextMember_++ % members_.size();
+    // Counted before it's pushed: a member may see the job as pending a bit earlier, but never misses it.
+    ++pendingJobs_;
+    {
+      std::lock_guard<SpinLock> guard(members_[index]->lock);
+      members_[index]->jobs.push_back(job);
+    }
+    if (waitingMembers_.load() != 0) wakeUpOne();
+  }
+
+  void putJobs(const KStdVector<Job>& jobs) {
+    Worker* current = ::g_worker;
+    bool fromMember = current != nullptr && current->pool() == this;
+    pendingJobs_ += jobs.size();
+    if (fromMember) {
+      Member* member = members_[current->poolIndex()];
+      std::lock_guard<SpinLock> guard(member->lock);
+      member->jobs.insert(member->jobs.end(), jobs.begin(), jobs.end());
+    } else {
+      // Give every member an even share, so that fewer jobs have to be stolen.
+      size_t count = members_.size();
+      size_t first = nextMember_++;
+      for (size_t i = 0; i < count && i < jobs.size(); ++i) {
+        Member* member = members_[(first + i) % count];
+        std::lock_guard<SpinLock> guard(member->lock);
+        for (size_t j = i; j < jobs.size(); j += count) {
+          member->jobs.push_back(jobs[j]);
+        }
+      }
+    }
+    // Woken members wake up the others while there are jobs left.
+    if (waitingMembers_.load() != 0) wakeUpOne();
+  }
+
+  // Delayed jobs are given to one of the members, as the pool has no thread of its own to wait for them.
+  void putDelayedJob(Job job) {
+    Locker locker(&lock_);
+    for (size_t i = 0; i < members_.size(); ++i) {
+      Member* member = members_[nextMember_++ % members_.size()];
+      if (member->worker != nullptr) {
+        member->worker->putDelayedJob(job);
+        return;
+      }
+    }
+    // All the members are gone, the pool is about to be destroyed.
+    DisposeStablePointer(job.executeAfter.operation);
+  }
+
+  // The job is with one of the members, see `putDelayedJob`.
+  KNativePtr cancelDelayedJob(KLong key) {
+    Locker locker(&lock_);
+    for (auto* member : members_) {
+      if (member->worker == nullptr) continue;
+      if (KNativePtr operation = member->worker->cancelDelayedJob(key)) return operation;
+    }
+    return nullptr;
+  }
+
+  void requestTermination(Future* future, bool processScheduledJobs) {
+    Locker locker(&lock_);
+    terminationFutures_.push_back(future);
+    Job job;
+    job.kind = JOB_TERMINATE;
+    // Only the last terminated member completes the futures.
+    job.terminationRequest.future = nullptr;
+    job.terminationRequest.waitDelayed = processScheduledJobs;
+    for (auto* member : members_) {
+      if (member->worker != nullptr) {
+        member->worker->putJob(job, !processScheduledJobs);
+      }
+    }
+  }
+
+  bool tryGetJob(Worker* worker, Job& job) {
+    if (pendingJobs_.load() == 0) return false;
+    size_t count = members_.size();
+    size_t own = worker->poolIndex();
+    for (size_t i = 0; i < count; ++i) {
+      Member* member = members_[(own + i) % count];
+      {
+        std::lock_guard<SpinLock> guard(member->lock);
+        if (member->jobs.empty()) continue;
+        if (i == 0) {
+          job = member->jobs.back();
+          member->jobs.pop_back();
+        } else {
+          job = member->jobs.front();
+          member->jobs.pop_front();
+        }
+      }
+      // Let someone else help with the rest.
+      if (--pendingJobs_ != 0 && waitingMembers_.load() != 0) wakeUpOne();
+      return true;
+    }
+    return false;
+  }
+
+  bool hasJobs() const { return pendingJobs_.load() != 0; }
+
+  void setMemberWaiting(bool waiting) {
+    if (waiting) {
+      ++waitingMembers_;
+    } else {
+      --waitingMembers_;
+    }
+  }
+
+  // Returns `true` if `worker` was the last member to terminate.
+  bool memberTerminated(Worker* worker) {
+    Locker locker(&lock_);
+    members_[worker->poolIndex()]->worker = nullptr;
+    return --runningMembers_ == 0;
+  }
+
+  // Called by the last terminated member, when the pool can no longer be found by its id.
+  void completeTermination(MemoryState* memoryState) {
+    for (auto* member : members_) {
+      for (auto& job : member->jobs) {
+        switch (job.kind) {
+          case JOB_REGULAR:
+            DisposeStablePointerFor(memoryState, job.regularJob.argument);
+            job.regularJob.future->cancelUnlocked(memoryState);
+            break;
+          case JOB_EXECUTE_AFTER:
+            DisposeStablePointerFor(memoryState, job.executeAfter.operation);
+            break;
+          case JOB_DETACHED:
+            DisposeStablePointerFor(memoryState, job.detachedJob.argument);
+            break;
+          default:
+            RuntimeCheck(false, "Cannot be in the pool");
+        }
+      }
+      member->jobs.clear();
+    }
+    for (auto* future : terminationFutures_) {
+      future->storeResultUnlocked(nullptr, true);
+    }
+    if (name_ != nullptr) {
+      DisposeStablePointerFor(memoryState, name_);
+    }
+  }
+
+  void start() {
+    runningMembers_ = members_.size();
+    for (auto* member : members_) {
+      member->worker->startEventLoop();
+    }
+  }
+
+  KInt id() const { return id_; }
+
+  bool errorReporting() const { return errorReporting_; }
+
+  KNativePtr name() const { return name_; }
+
+ private:
+  struct Member : private Pinned {
+    // Guarded by the pool's `lock_`, reset when the member terminates.
+    Worker* worker = nullptr;
+    SpinLock lock;
+    // Guarded by `lock`.
+    KStdDeque<Job> jobs;
+  };
+
+  void wakeUpOne() {
+    Locker locker(&lock_);
+    for (auto* member : members_) {
+      if (member->worker != nullptr && member->worker->isWaiting()) {
+        member->worker->wakeUp();
+        return;
+      }
+    }
+  }
+
+  KInt id_;
+  bool errorReporting_;
+  KNativePtr name_;
+  KStdVector<Member*> members_;
+  std::atomic<size_t> nextMember_ = 0;
+  std::atomic<size_t> pendingJobs_ = 0;
+  std::atomic<size_t> waitingMembers_ = 0;
+  // Guards the members' `worker`, `runningMembers_` and `terminationFutures_`.
+  pthread_mutex_t lock_;
+  size_t runningMembers_ = 0;
+  KStdVector<Future*> terminationFutures_;
+};
+
+// Table of objects by id, split into shards with separate locks, so that operations on different ids
+// rarely contend with each other.
+template <typename T>
+class ShardedTable : private Pinned {
+ public:
+  struct Shard : private Pinned {
+    Shard() { pthread_mutex_init(&lock, nullptr); }
+    ~Shard() { pthread_mutex_destroy(&lock); }
+
+    pthread_mutex_t lock;
+    KStdUnorderedMap<KInt, T*> items;
+  };
+
+  Shard& shard(KInt id) { return shards_[static_cast<uint32_t>(id) % kShardCount]; }
+
+  Shard* begin() { return shards_; }
+  Shard* end() { return shards_ + kShardCount; }
+
+ private:
+  static constexpr size_t kShardCount = 16;
+
+  Shard shards_[kShardCount];
 };
 
 class State {
  public:
   State() {
     pthread_mutex_init(&lock_, nullptr);
-    pthread_cond_init(&cond_, nullptr);
-
-    currentWorkerId_ = 1;
-    currentFutureId_ = 1;
-    currentVersion_ = 0;
   }
 
   ~State() {
     // TODO: some sanity check here?
     pthread_mutex_destroy(&lock_);
-    pthread_cond_destroy(&cond_);
   }
 
   Worker* addWorkerUnlocked(bool errorReporting, KRef customName, WorkerKind kind) {
-    Worker* worker = nullptr;
+    Worker* worker = konanConstructInstance<Worker>(nextWorkerId(), errorReporting, customName, kind);
+    if (worker == nullptr) return nullptr;
     {
-      Locker locker(&lock_);
-      worker = konanConstructInstance<Worker>(nextWorkerId(), errorReporting, customName, kind);
-      if (worker == nullptr) return nullptr;
-      workers_[worker->id()] = worker;
+      auto& shard = workers_.shard(worker->id());
+      Locker locker(&shard.lock);
+      shard.items[worker->id()] = worker;
     }
     GC_RegisterWorker(worker);
     return worker;
   }
 
   void removeWorkerUnlocked(KInt id) {
-    Locker locker(&lock_);
-    auto it = workers_.find(id);
-    if (it == workers_.end()) return;
-    Worker* worker = it->second;
+    Worker* worker = nullptr;
+    {
+      auto& shard = workers_.shard(id);
+      Locker locker(&shard.lock);
+      auto it = shard.items.find(id);
+      if (it == shard.items.end()) return;
+      worker = it->second;
+      shard.items.erase(it);
+    }
     if (worker->kind() == WorkerKind::kNative) {
+      // `waitNativeWorkersTerminationUnlocked` takes the locks in the opposite order, so do not nest them here.
+      Locker locker(&lock_);
       terminating_native_workers_[id] = worker->thread();
     }
-    workers_.erase(it);
   }
 
   void destroyWorkerUnlocked(Worker* worker) {
@@ -345,86 +860,168 @@ class State {
       // so we have to use the pointer to MemoryState saved in the worker instance.
       RuntimeAssert(pthread_equal(worker->thread(), pthread_self()),
                     "Worker destruction must be executed by the worker thread.");
-      Locker locker(&lock_, worker->memoryState());
       auto id = worker->id();
-      auto it = workers_.find(id);
-      if (it != workers_.end()) {
-        workers_.erase(it);
+      auto& shard = workers_.shard(id);
+      Locker locker(&shard.lock, worker->memoryState());
+      auto it = shard.items.find(id);
+      if (it != shard.items.end()) {
+        shard.items.erase(it);
       }
     }
     GC_UnregisterWorker(worker);
     konanDestructInstance(worker);
   }
 
-  Future* addJobToWorkerUnlocked(
-      KInt id, KNativePtr jobFunction, KNativePtr jobArgument, bool toFront, KInt transferMode) {
-    Future* future = nullptr;
-    Worker* worker = nullptr;
-    Locker locker(&lock_);
-
-    auto it = workers_.find(id);
-    if (it == workers_.end()) return nullptr;
-    worker = it->second;
+  KInt addPoolUnlocked(KInt size, bool errorReporting, KRef customName) {
+    if (size <= 0) {
+      size = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    WorkerPool* pool = konanConstructInstance<WorkerPool>(nextWorkerId(), errorReporting, customName);
+    for (KInt i = 0; i < size; ++i) {
+      Worker* worker = addWorkerUnlocked(errorReporting, customName, WorkerKind::kNative);
+      RuntimeCheck(worker != nullptr, "Cannot create a worker of the pool");
+      pool->addMember(worker);
+    }
+    {
+      auto& shard = pools_.shard(pool->id());
+      Locker locker(&shard.lock);
+      shard.items[pool->id()] = pool;
+    }
+    pool->start();
+    return pool->id();
+  }
 
-    future = konanConstructInstance<Future>(nextFutureId());
-    futures_[future->id()] = future;
+  // Called by the last terminated member of `pool`.
+  void destroyPoolUnlocked(WorkerPool* pool, MemoryState* memoryState) {
+    {
+      // Wait for everyone who has found the pool by its id to finish.
+      auto& shard = pools_.shard(pool->id());
+      Locker locker(&shard.lock, memoryState);
+      shard.items.erase(pool->id());
+    }
+    pool->completeTermination(memoryState);
+    konanDestructInstance(pool);
+  }
 
-    Job job;
-    if (jobFunction == nullptr) {
-      job.kind = JOB_TERMINATE;
-      job.terminationRequest.future = future;
-      job.terminationRequest.waitDelayed = !toFront;
+  Future* addJobToWorkerUnlocked(
+      KInt id, KNativePtr jobFunction, KNativePtr jobArgument, bool toFront, KInt transferMode) {
+    Job job = makeJob(jobFunction, jobArgument, toFront, transferMode);
+    {
+      // The worker cannot be destroyed while its shard is locked.
+      auto& shard = workers_.shard(id);
+      Locker locker(&shard.lock);
+      auto it = shard.items.find(id);
+      if (it != shard.items.end()) {
+        Future* future = addFutureUnlocked(job);
+        it->second->putJob(job, toFront);
+        return future;
+      }
+    }
+    // Same for pools.
+    auto& shard = pools_.shard(id);
+    Locker locker(&shard.lock);
+    auto it = shard.items.find(id);
+    if (it == shard.items.end()) return nullptr;
+    Future* future = addFutureUnlocked(job);
+    if (job.kind == JOB_TERMINATE) {
+      it->second->requestTermination(future, !toFront);
     } else {
-      job.kind = JOB_REGULAR;
-      job.regularJob.function = reinterpret_cast<KRef (*)(KRef, ObjHeader**)>(jobFunction);
-      job.regularJob.argument = jobArgument;
-      job.regularJob.future = future;
-      job.regularJob.transferMode = transferMode;
+      it->second->putJob(job);
     }
-
-    worker->putJob(job, toFront);
-
     return future;
   }
 
-  bool executeJobAfterInWorkerUnlocked(KInt id, KRef operation, KLong afterMicroseconds) {
-    Worker* worker = nullptr;
-    Locker locker(&lock_);
+  // Returns the id of the first future, the rest have consecutive ids, or 0 if there's no worker `id`.
+  KInt addJobsToWorkerUnlocked(KInt id, const KStdVector<KNativePtr>& jobArguments, KNativePtr jobFunction, KInt transferMode) {
+    KStdVector<Job> jobs(jobArguments.size());
+    for (size_t i = 0; i < jobs.size(); ++i) {
+      jobs[i] = makeJob(jobFunction, jobArguments[i], false, transferMode);
+    }
+    {
+      auto& shard = workers_.shard(id);
+      Locker locker(&shard.lock);
+      auto it = shard.items.find(id);
+      if (it != shard.items.end()) {
+        KInt first = addFuturesUnlocked(jobs);
+        it->second->putJobs(jobs);
+        return first;
+      }
+    }
+    auto& shard = pools_.shard(id);
+    Locker locker(&shard.lock);
+    auto it = shard.items.find(id);
+    if (it == shard.items.end()) return 0;
+    KInt first = addFuturesUnlocked(jobs);
+    it->second->putJobs(jobs);
+    return first;
+  }
 
+  bool executeJobAfterInWorkerUnlocked(KInt id, KRef operation, KLong afterMicroseconds, KLong cancellationKey) {
     RuntimeAssert(afterMicroseconds >= 0, "afterMicroseconds cannot be negative");
 
-    auto it = workers_.find(id);
-    if (it == workers_.end()) {
-      return false;
-    }
-    worker = it->second;
     Job job;
     job.kind = JOB_EXECUTE_AFTER;
+    job.executeAfter.operation = nullptr;
+    job.executeAfter.whenExecute = afterMicroseconds == 0 ? 0 : konan::getTimeMicros() + afterMicroseconds;
+    job.executeAfter.cancellationKey = cancellationKey;
+    {
+      auto& shard = workers_.shard(id);
+      Locker locker(&shard.lock);
+      auto it = shard.items.find(id);
+      if (it != shard.items.end()) {
+        job.executeAfter.operation = CreateStablePointer(operation);
+        if (afterMicroseconds == 0) {
+          it->second->putJob(job, false);
+        } else {
+          it->second->putDelayedJob(job);
+        }
+        return true;
+      }
+    }
+    auto& shard = pools_.shard(id);
+    Locker locker(&shard.lock);
+    auto it = shard.items.find(id);
+    if (it == shard.items.end()) {
+      return false;
+    }
     job.executeAfter.operation = CreateStablePointer(operation);
     if (afterMicroseconds == 0) {
-      worker->putJob(job, false);
+      it->second->putJob(job);
     } else {
-      job.executeAfter.whenExecute = konan::getTimeMicros() + afterMicroseconds;
-      worker->putDelayedJob(job);
+      it->second->putDelayedJob(job);
     }
     return true;
   }
 
-  bool scheduleJobInWorkerUnlocked(KInt id, KNativePtr operationStablePtr) {
-      Worker* worker = nullptr;
-      Locker locker(&lock_);
-
-      auto it = workers_.find(id);
-      if (it == workers_.end()) {
-          return false;
-      }
-      worker = it->second;
+  // Returns the operation of the cancelled job, to be disposed by the caller.
+  KNativePtr cancelDelayedJobUnlocked(KInt id, KLong cancellationKey) {
+    {
+      auto& shard = workers_.shard(id);
+      Locker locker(&shard.lock);
+      auto it = shard.items.find(id);
+      if (it != shard.items.end()) return it->second->cancelDelayedJob(cancellationKey);
+    }
+    auto& shard = pools_.shard(id);
+    Locker locker(&shard.lock);
+    auto it = shard.items.find(id);
+    if (it == shard.items.end()) return nullptr;
+    return it->second->cancelDelayedJob(cancellationKey);
+  }
 
+  bool scheduleJobInWorkerUnlocked(KInt id, KNativePtr operationStablePtr) {
       Job job;
       job.kind = JOB_EXECUTE_AFTER;
       job.executeAfter.operation = operationStablePtr;
-      worker->putJob(job, false);
-      return true;
+      job.executeAfter.cancellationKey = 0;
+      return putJobUnlocked(id, job);
+  }
+
+  bool addDetachedJobToWorkerUnlocked(KInt id, KNativePtr jobFunction, KNativePtr jobArgument) {
+      Job job;
+      job.kind = JOB_DETACHED;
+      job.detachedJob.function = reinterpret_cast<KRef (*)(KRef, ObjHeader**)>(jobFunction);
+      job.detachedJob.argument = jobArgument;
+      return putJobUnlocked(id, job);
   }
 
   // Returns `true` if something was indeed processed.
@@ -441,29 +1038,36 @@ class State {
       return ::g_worker->park(timeoutMicroseconds, process);
   }
 
+  Worker* currentWorkerChecked(KInt id) {
+    if (::g_worker == nullptr || id != ::g_worker->id()) ThrowWorkerInvalidState();
+    return ::g_worker;
+  }
+
   KInt stateOfFutureUnlocked(KInt id) {
-    Locker locker(&lock_);
-    auto it = futures_.find(id);
-    if (it == futures_.end()) return INVALID;
+    auto& shard = futures_.shard(id);
+    Locker locker(&shard.lock);
+    auto it = shard.items.find(id);
+    if (it == shard.items.end()) return INVALID;
     return it->second->state();
   }
 
   OBJ_GETTER(consumeFutureUnlocked, KInt id) {
     Future* future = nullptr;
+    auto& shard = futures_.shard(id);
     {
-      Locker locker(&lock_);
-      auto it = futures_.find(id);
-      if (it == futures_.end()) ThrowWorkerInvalidState();
+      Locker locker(&shard.lock);
+      auto it = shard.items.find(id);
+      if (it == shard.items.end()) ThrowWorkerInvalidState();
       future = it->second;
     }
 
     KRef result = future->consumeResultUnlocked(OBJ_RESULT);
 
     {
-       Locker locker(&lock_);
-       auto it = futures_.find(id);
-       if (it != futures_.end()) {
-         futures_.erase(it);
+       Locker locker(&shard.lock);
+       auto it = shard.items.find(id);
+       if (it != shard.items.end()) {
+         shard.items.erase(it);
          konanDestructInstance(future);
        }
     }
@@ -473,55 +1077,43 @@ class State {
 
   OBJ_GETTER(getWorkerNameUnlocked, KInt id) {
     ObjHolder nameHolder;
-    {
-        Locker locker(&lock_);
-        auto it = workers_.find(id);
-        if (it == workers_.end()) {
-            ThrowWorkerInvalidState();
-        }
-        DerefStablePointer(it->second->name(), nameHolder.slot());
+    if (!derefNameUnlocked(workers_, id, nameHolder.slot()) && !derefNameUnlocked(pools_, id, nameHolder.slot())) {
+        ThrowWorkerInvalidState();
     }
     RETURN_OBJ(nameHolder.obj());
   }
 
-  KBoolean waitForAnyFuture(KInt version, KInt millis) {
-    Locker locker(&lock_);
-    if (version != currentVersion_) return false;
-
-    if (millis < 0) {
-      waitInNativeState(&cond_, &lock_);
-      return true;
+  // Waits until any of the futures `ids` is completed, or `millis` pass (if not negative).
+  void waitForFuturesUnlocked(const KStdVector<KInt>& ids, KInt millis) {
+    FutureWaiter waiter;
+    bool completed = false;
+    size_t added = 0;
+    for (; added < ids.size(); ++added) {
+      // A future can only be destroyed with its shard locked.
+      auto& shard = futures_.shard(ids[added]);
+      Locker locker(&shard.lock);
+      auto it = shard.items.find(ids[added]);
+      if (it == shard.items.end() || !it->second->addWaiterUnlocked(&waiter)) {
+        completed = true;
+        break;
+      }
     }
-
-    uint64_t nsDelta = millis * 1000000LL;
-    waitInNativeState(&cond_, &lock_, nsDelta);
-    return true;
-  }
-
-  void signalAnyFuture() {
-    {
-      Locker locker(&lock_);
-      currentVersion_++;
+    if (!completed) {
+      waiter.wait(millis);
     }
-    pthread_cond_broadcast(&cond_);
-  }
-
-  void signalAnyFuture(MemoryState* memoryState) {
-    {
-      Locker locker(&lock_, memoryState);
-      currentVersion_++;
+    for (size_t i = 0; i < added; ++i) {
+      auto& shard = futures_.shard(ids[i]);
+      Locker locker(&shard.lock);
+      auto it = shard.items.find(ids[i]);
+      if (it != shard.items.end()) {
+        it->second->removeWaiterUnlocked(&waiter);
+      }
     }
-    pthread_cond_broadcast(&cond_);
-  }
-
-  KInt versionToken() {
-    Locker locker(&lock_);
-    return currentVersion_;
   }
 
-  // All those called with lock taken.
   KInt nextWorkerId() { return currentWorkerId_++; }
   KInt nextFutureId() { return currentFutureId_++; }
+  KLong nextCancellationKey() { return currentCancellationKey_++; }
 
   void destroyWorkerThreadDataUnlocked(KInt id) {
     // We destroy worker data when its thread is already unresigtered from the memory subsystem,
@@ -563,10 +1155,13 @@ class State {
 
   void checkNativeWorkersLeakLocked() {
     size_t remainingNativeWorkers = 0;
-    for (const auto& kvp : workers_) {
-      Worker* worker = kvp.second;
-      if (worker->kind() == WorkerKind::kNative) {
-        ++remainingNativeWorkers;
+    for (auto& shard : workers_) {
+      Locker locker(&shard.lock);
+      for (const auto& kvp : shard.items) {
+        Worker* worker = kvp.second;
+        if (worker->kind() == WorkerKind::kNative) {
+          ++remainingNativeWorkers;
+        }
       }
     }
 
@@ -581,14 +1176,94 @@ class State {
   }
 
  private:
+  static Job makeJob(KNativePtr jobFunction, KNativePtr jobArgument, bool toFront, KInt transferMode) {
+    Job job;
+    if (jobFunction == nullptr) {
+      job.kind = JOB_TERMINATE;
+      job.terminationRequest.future = nullptr;
+      job.terminationRequest.waitDelayed = !toFront;
+    } else {
+      job.kind = JOB_REGULAR;
+      job.regularJob.function = reinterpret_cast<KRef (*)(KRef, ObjHeader**)>(jobFunction);
+      job.regularJob.argument = jobArgument;
+      job.regularJob.future = nullptr;
+      job.regularJob.transferMode = transferMode;
+    }
+    return job;
+  }
+
+  // Creates the future for `job`.
+  Future* addFutureUnlocked(Job& job) {
+    Future* future = konanConstructInstance<Future>(nextFutureId());
+    {
+      auto& shard = futures_.shard(future->id());
+      Locker locker(&shard.lock);
+      shard.items[future->id()] = future;
+    }
+    if (job.kind == JOB_TERMINATE) {
+      job.terminationRequest.future = future;
+    } else {
+      job.regularJob.future = future;
+    }
+    return future;
+  }
+
+  // Creates futures with consecutive ids for regular `jobs`, locking each shard of futures once.
+  KInt addFuturesUnlocked(KStdVector<Job>& jobs) {
+    KInt first = currentFutureId_.fetch_add(static_cast<KInt>(jobs.size()));
+    for (size_t i = 0; i < jobs.size(); ++i) {
+      jobs[i].regularJob.future = konanConstructInstance<Future>(first + i);
+    }
+    for (auto& shard : futures_) {
+      Locker locker(&shard.lock);
+      for (auto& job : jobs) {
+        Future* future = job.regularJob.future;
+        if (&futures_.shard(future->id()) == &shard) {
+          shard.items[future->id()] = future;
+        }
+      }
+    }
+    return first;
+  }
+
+  // Puts `job` to the back of the queue of worker or pool `id`. Returns `false` if there's none.
+  bool putJobUnlocked(KInt id, Job job) {
+    {
+      auto& shard = workers_.shard(id);
+      Locker locker(&shard.lock);
+      auto it = shard.items.find(id);
+      if (it != shard.items.end()) {
+        it->second->putJob(job, false);
+        return true;
+      }
+    }
+    auto& shard = pools_.shard(id);
+    Locker locker(&shard.lock);
+    auto it = shard.items.find(id);
+    if (it == shard.items.end()) return false;
+    it->second->putJob(job);
+    return true;
+  }
+
+  template <typename T>
+  static bool derefNameUnlocked(ShardedTable<T>& table, KInt id, ObjHeader** name) {
+    auto& shard = table.shard(id);
+    Locker locker(&shard.lock);
+    auto it = shard.items.find(id);
+    if (it == shard.items.end()) return false;
+    DerefStablePointer(it->second->name(), name);
+    return true;
+  }
+
+  // Guards `terminating_native_workers_`.
   pthread_mutex_t lock_;
-  pthread_cond_t cond_;
-  KStdUnorderedMap<KInt, Future*> futures_;
-  KStdUnorderedMap<KInt, Worker*> workers_;
+  ShardedTable<Future> futures_;
+  ShardedTable<Worker> workers_;
+  ShardedTable<WorkerPool> pools_;
   KStdUnorderedMap<KInt, pthread_t> terminating_native_workers_;
-  KInt currentWorkerId_;
-  KInt currentFutureId_;
-  KInt currentVersion_;
+  std::atomic<KInt> currentWorkerId_ = 1;
+  std::atomic<KInt> currentFutureId_ = 1;
+  std::atomic<KLong> currentCancellationKey_ = 1;
 };
 
 State* theState() {
@@ -618,8 +1293,10 @@ void Future::storeResultUnlocked(KNativePtr result, bool ok) {
     // of the taken lock, it's not on macOS (as of 10.13.1). If moved outside of the lock,
     // some notifications are missing.
     pthread_cond_broadcast(&cond_);
+    for (auto* waiter : waiters_) {
+      waiter->signal();
+    }
   }
-  theState()->signalAnyFuture();
 }
 
 void Future::cancelUnlocked(MemoryState* memoryState) {
@@ -628,8 +1305,10 @@ void Future::cancelUnlocked(MemoryState* memoryState) {
     state_ = CANCELLED;
     result_ = nullptr;
     pthread_cond_broadcast(&cond_);
+    for (auto* waiter : waiters_) {
+      waiter->signal(memoryState);
+    }
   }
-  theState()->signalAnyFuture(memoryState);
 }
 
 // Defined in RuntimeUtils.kt.
@@ -642,6 +1321,36 @@ KInt startWorker(KBoolean errorReporting, KRef customName) {
   return worker->id();
 }
 
+KInt startWorkerWithOptions(KBoolean errorReporting, KRef customName, KLong stackSize, KConstRef cpus,
+                           KBoolean hasNice, KInt nice, KRef threadName) {
+  WorkerThreadOptions options;
+  options.stackSize = stackSize > 0 ? static_cast<size_t>(stackSize) : 0;
+  if (cpus != nullptr) {
+    const ArrayHeader* array = cpus->array();
+    for (uint32_t i = 0; i < array->count_; ++i) {
+      options.cpus.push_back(*IntArrayAddressOfElementAt(array, i));
+    }
+  }
+  options.hasNice = hasNice != 0;
+  options.nice = nice;
+  if (threadName == nullptr) threadName = customName;
+  if (threadName != nullptr) {
+    char* cstring = CreateCStringFromString(threadName);
+    options.threadName = cstring;
+    DisposeCString(cstring);
+  }
+
+  Worker* worker = theState()->addWorkerUnlocked(errorReporting != 0, customName, WorkerKind::kNative);
+  if (worker == nullptr) return -1;
+  worker->setThreadOptions(std::move(options));
+  worker->startEventLoop();
+  return worker->id();
+}
+
+KInt startPool(KInt size, KBoolean errorReporting, KRef customName) {
+  return theState()->addPoolUnlocked(size, errorReporting != 0, customName);
+}
+
 KInt currentWorker() {
   if (g_worker == nullptr) ThrowWorkerInvalidState();
   return ::g_worker->id();
@@ -656,9 +1365,61 @@ KInt execute(KInt id, KInt transferMode, KRef producer, KNativePtr jobFunction)
   return future->id();
 }
 
+KInt executeBatch(KInt id, KInt transferMode, KInt count, KRef producer) {
+  KStdVector<KNativePtr> jobArguments;
+  jobArguments.reserve(count);
+  try {
+    for (KInt i = 0; i < count; ++i) {
+      ObjHolder holder;
+      WorkerBatchLaunchpad(producer, i, holder.slot());
+      jobArguments.push_back(transfer(&holder, transferMode));
+    }
+  } catch (...) {
+    for (auto argument : jobArguments) {
+      DisposeStablePointer(argument);
+    }
+    throw;
+  }
+  KInt first = theState()->addJobsToWorkerUnlocked(
+      id, jobArguments, reinterpret_cast<KNativePtr>(WorkerLambdaJobLaunchpad), transferMode);
+  if (first == 0) {
+    for (auto argument : jobArguments) {
+      DisposeStablePointer(argument);
+    }
+    ThrowWorkerInvalidState();
+  }
+  return first;
+}
+
+void executeDetached(KInt id, KInt transferMode, KRef producer) {
+  ObjHolder holder;
+  WorkerLaunchpad(producer, holder.slot());
+  KNativePtr jobArgument = transfer(&holder, transferMode);
+  if (!theState()->addDetachedJobToWorkerUnlocked(
+          id, reinterpret_cast<KNativePtr>(WorkerLambdaJobLaunchpad), jobArgument)) {
+    DisposeStablePointer(jobArgument);
+    ThrowWorkerInvalidState();
+  }
+}
+
 void executeAfter(KInt id, KRef job, KLong afterMicroseconds) {
-  if (!theState()->executeJobAfterInWorkerUnlocked(id, job, afterMicroseconds))
+  if (!theState()->executeJobAfterInWorkerUnlocked(id, job, afterMicroseconds, 0))
+    ThrowWorkerInvalidState();
+}
+
+KLong executeAfterCancellable(KInt id, KRef job, KLong afterMicroseconds) {
+  KLong key = theState()->nextCancellationKey();
+  if (!theState()->executeJobAfterInWorkerUnlocked(id, job, afterMicroseconds, key))
     ThrowWorkerInvalidState();
+  return key;
+}
+
+KBoolean cancelDelayed(KInt id, KLong key) {
+  KNativePtr operation = theState()->cancelDelayedJobUnlocked(id, key);
+  if (operation == nullptr) return false;
+  // The operation is frozen, so any thread can dispose it.
+  DisposeStablePointer(operation);
+  return true;
 }
 
 KBoolean processQueue(KInt id) {
@@ -669,6 +1430,21 @@ KBoolean park(KInt id, KLong timeoutMicroseconds, KBoolean process) {
    return theState()->parkUnlocked(id, timeoutMicroseconds, process);
 }
 
+KBoolean watchFileDescriptor(KInt id, KInt fd, KBoolean readable, KBoolean writable) {
+  return theState()->currentWorkerChecked(id)->watchFileDescriptor(fd, readable, writable);
+}
+
+KBoolean unwatchFileDescriptor(KInt id, KInt fd) {
+  return theState()->currentWorkerChecked(id)->unwatchFileDescriptor(fd);
+}
+
+OBJ_GETTER(readyFileDescriptors, KInt id) {
+  const KStdVector<KInt>& ready = theState()->currentWorkerChecked(id)->readyFileDescriptors();
+  ObjHeader* result = AllocArrayInstance(theIntArrayTypeInfo, ready.size(), OBJ_RESULT);
+  std::copy(ready.begin(), ready.end(), IntArrayAddressOfElementAt(result->array(), 0));
+  RETURN_OBJ(result);
+}
+
 KInt stateOfFuture(KInt id) {
   return theState()->stateOfFutureUnlocked(id);
 }
@@ -688,12 +1464,13 @@ KInt requestTermination(KInt id, KBoolean processScheduledJobs) {
   return future->id();
 }
 
-KBoolean waitForAnyFuture(KInt version, KInt millis) {
-  return theState()->waitForAnyFuture(version, millis);
-}
-
-KInt versionToken() {
-  return theState()->versionToken();
+void waitForFutures(KConstRef ids, KInt millis) {
+  const ArrayHeader* array = ids->array();
+  KStdVector<KInt> copy(array->count_);
+  for (uint32_t i = 0; i < array->count_; ++i) {
+    copy[i] = *IntArrayAddressOfElementAt(array, i);
+  }
+  theState()->waitForFuturesUnlocked(copy, millis);
 }
 
 OBJ_GETTER(attachObjectGraphInternal, KNativePtr stable) {
@@ -716,6 +1493,15 @@ KInt startWorker(KBoolean errorReporting, KRef customName) {
   ThrowWorkerUnsupported();
 }
 
+KInt startWorkerWithOptions(KBoolean errorReporting, KRef customName, KLong stackSize, KConstRef cpus,
+                           KBoolean hasNice, KInt nice, KRef threadName) {
+  ThrowWorkerUnsupported();
+}
+
+KInt startPool(KInt size, KBoolean errorReporting, KRef customName) {
+  ThrowWorkerUnsupported();
+}
+
 KInt stateOfFuture(KInt id) {
   ThrowWorkerUnsupported();
 }
@@ -724,10 +1510,26 @@ KInt execute(KInt id, KInt transferMode, KRef producer, KNativePtr jobFunction)
   ThrowWorkerUnsupported();
 }
 
+KInt executeBatch(KInt id, KInt transferMode, KInt count, KRef producer) {
+  ThrowWorkerUnsupported();
+}
+
+void executeDetached(KInt id, KInt transferMode, KRef producer) {
+  ThrowWorkerUnsupported();
+}
+
 void executeAfter(KInt id, KRef job, KLong afterMicroseconds) {
   ThrowWorkerUnsupported();
 }
 
+KLong executeAfterCancellable(KInt id, KRef job, KLong afterMicroseconds) {
+  ThrowWorkerUnsupported();
+}
+
+KBoolean cancelDelayed(KInt id, KLong key) {
+  ThrowWorkerUnsupported();
+}
+
 KBoolean processQueue(KInt id) {
   ThrowWorkerUnsupported();
 }
@@ -736,6 +1538,18 @@ KBoolean park(KInt id, KLong timeoutMicroseconds, KBoolean process) {
   ThrowWorkerUnsupported();
 }
 
+KBoolean watchFileDescriptor(KInt id, KInt fd, KBoolean readable, KBoolean writable) {
+  ThrowWorkerUnsupported();
+}
+
+KBoolean unwatchFileDescriptor(KInt id, KInt fd) {
+  ThrowWorkerUnsupported();
+}
+
+OBJ_GETTER(readyFileDescriptors, KInt id) {
+  ThrowWorkerUnsupported();
+}
+
 KInt currentWorker() {
   ThrowWorkerUnsupported();
 }
@@ -752,11 +1566,7 @@ KInt requestTermination(KInt id, KBoolean processScheduledJobs) {
   ThrowWorkerUnsupported();
 }
 
-KBoolean waitForAnyFuture(KInt versionToken, KInt millis) {
-  ThrowWorkerUnsupported();
-}
-
-KInt versionToken() {
+void waitForFutures(KConstRef ids, KInt millis) {
   ThrowWorkerUnsupported();
 }
 
@@ -836,7 +1646,12 @@ Worker::~Worker() {
   RuntimeAssert(pthread_equal(thread(), pthread_self()),
                 "Worker destruction must be executed by the worker thread.");
   // Cleanup jobs in the queue.
-  for (auto job : queue_) {
+  Job job;
+  while (!frontJobs_.empty() || queue_.TryPop(job)) {
+      if (!frontJobs_.empty()) {
+          job = frontJobs_.front();
+          frontJobs_.pop_front();
+      }
       switch (job.kind) {
           case JOB_REGULAR:
               DisposeStablePointerFor(memoryState_, job.regularJob.argument);
@@ -847,9 +1662,13 @@ Worker::~Worker() {
               DisposeStablePointerFor(memoryState_, job.executeAfter.operation);
               break;
           }
+          case JOB_DETACHED:
+              DisposeStablePointerFor(memoryState_, job.detachedJob.argument);
+              break;
           case JOB_TERMINATE: {
               // TODO: any more processing here?
-              job.terminationRequest.future->cancelUnlocked(memoryState_);
+              if (job.terminationRequest.future != nullptr)
+                job.terminationRequest.future->cancelUnlocked(memoryState_);
               break;
           }
           case JOB_NONE: {
@@ -859,24 +1678,42 @@ Worker::~Worker() {
       }
   }
 
-  for (auto job : delayed_) {
+  delayed_.ForEach([this](const Job& job) {
       RuntimeAssert(job.kind == JOB_EXECUTE_AFTER, "Must be delayed");
       DisposeStablePointerFor(memoryState_, job.executeAfter.operation);
-  }
+  });
 
   if (name_ != nullptr) {
       DisposeStablePointerFor(memoryState_, name_);
   }
 
+  delete watcher_;
+
   pthread_mutex_destroy(&lock_);
   pthread_cond_destroy(&cond_);
 }
 
 namespace {
 
+void applyThreadOptions(const WorkerThreadOptions& options) {
+  if (!options.threadName.empty()) {
+    konan::setCurrentThreadName(options.threadName.c_str());
+  }
+  // Both are best effort: the worker still runs where the platform doesn't support them, or denies them.
+  if (!options.cpus.empty() && !konan::setCurrentThreadAffinity(options.cpus.data(), options.cpus.size())) {
+    konan::consoleErrorf("Cannot set CPU affinity of the worker thread\n");
+  }
+  if (options.hasNice && !konan::setCurrentThreadNice(options.nice)) {
+    konan::consoleErrorf("Cannot set priority of the worker thread\n");
+  }
+}
+
 void* workerRoutine(void* argument) {
   Worker* worker = reinterpret_cast<Worker*>(argument);
 
+  // Done before anything is allocated on this thread, so that it's allocated on the CPUs requested.
+  applyThreadOptions(worker->threadOptions());
+
   // Kotlin_initRuntimeIfNeeded calls WorkerInit that needs
   // to see there's already a worker created for this thread.
   ::g_worker = worker;
@@ -893,60 +1730,150 @@ void* workerRoutine(void* argument) {
 }  // namespace
 
 void Worker::startEventLoop() {
-  pthread_create(&thread_, nullptr, workerRoutine, this);
+  int result;
+  if (threadOptions_.stackSize == 0) {
+    result = pthread_create(&thread_, nullptr, workerRoutine, this);
+  } else {
+    // Some platforms reject stack sizes which are not a multiple of the page size.
+#if KONAN_WINDOWS
+    size_t pageSize = 4096;
+#else
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    size_t stackSize = std::max(threadOptions_.stackSize, static_cast<size_t>(PTHREAD_STACK_MIN));
+    stackSize = (stackSize + pageSize - 1) / pageSize * pageSize;
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    result = pthread_attr_setstacksize(&attributes, stackSize);
+    if (result != 0) {
+      konan::consoleErrorf("Cannot set the stack size of the worker thread to %zu bytes: error %d\n", stackSize, result);
+      konan::abort();
+    }
+    result = pthread_create(&thread_, &attributes, workerRoutine, this);
+    pthread_attr_destroy(&attributes);
+  }
+  if (result != 0) {
+    konan::consoleErrorf("Cannot create the worker thread: error %d\n", result);
+    konan::abort();
+  }
 }
 
-void Worker::putJob(Job job, bool toFront) {
+void Worker::wakeUp() {
   Locker locker(&lock_);
-  if (toFront)
-    queue_.push_front(job);
-  else
-    queue_.push_back(job);
-  pthread_cond_signal(&cond_);
+  signalLocked();
+}
+
+void Worker::signalLocked() {
+  if (polling_) {
+    watcher_->signal();
+  } else {
+    pthread_cond_signal(&cond_);
+  }
+}
+
+bool Worker::hasJobs() const {
+  return frontJobsCount_.load() != 0 || !queue_.Empty() || (pool_ != nullptr && pool_->hasJobs());
+}
+
+void Worker::putJob(Job job, bool toFront) {
+  if (toFront) {
+    Locker locker(&lock_);
+    frontJobs_.push_front(job);
+    ++frontJobsCount_;
+    signalLocked();
+    return;
+  }
+  queue_.Push(job);
+  // Pairs with `waitForQueueLocked`: either the worker sees the job before waiting, or it's seen waiting here.
+  if (waiting_.load()) {
+    Locker locker(&lock_);
+    signalLocked();
+  }
+}
+
+void Worker::putJobs(const KStdVector<Job>& jobs) {
+  queue_.PushChain(jobs.begin(), jobs.end());
+  // A single wakeup for all of them, see `putJob`.
+  if (waiting_.load()) {
+    Locker locker(&lock_);
+    signalLocked();
+  }
 }
 
 void Worker::putDelayedJob(Job job) {
   Locker locker(&lock_);
-  delayed_.insert(job);
-  pthread_cond_signal(&cond_);
+  auto handle = delayed_.Insert(job.executeAfter.whenExecute, job);
+  if (job.executeAfter.cancellationKey != 0) {
+    cancellableDelayed_.emplace(job.executeAfter.cancellationKey, handle);
+  }
+  signalLocked();
+}
+
+KNativePtr Worker::cancelDelayedJob(KLong key) {
+  Locker locker(&lock_);
+  auto it = cancellableDelayed_.find(key);
+  if (it == cancellableDelayed_.end()) return nullptr;
+  Job job = delayed_.Cancel(it->second);
+  cancellableDelayed_.erase(it);
+  // No need to wake up the worker: it finds out that it has nothing to do when it wakes up on its own.
+  return job.executeAfter.operation;
 }
 
 bool Worker::waitDelayed(bool blocking) {
   Locker locker(&lock_);
-  if (delayed_.size() == 0) return false;
+  if (delayed_.Empty()) return false;
   if (blocking) waitForQueueLocked(-1, nullptr);
   return true;
 }
 
 Job Worker::getJob(bool blocking) {
-  Locker locker(&lock_);
   RuntimeAssert(!terminated_, "Must not be terminated");
-  if (queue_.size() == 0 && !blocking) return Job { .kind = JOB_NONE };
-  waitForQueueLocked(-1, nullptr);
-  auto result = queue_.front();
-  queue_.pop_front();
-  return result;
+  while (true) {
+    if (!hasJobs()) {
+      if (!blocking) return Job { .kind = JOB_NONE };
+      Locker locker(&lock_);
+      waitForQueueLocked(-1, nullptr);
+    }
+    Job result;
+    if (frontJobsCount_.load() != 0) {
+      Locker locker(&lock_);
+      result = frontJobs_.front();
+      frontJobs_.pop_front();
+      --frontJobsCount_;
+      return result;
+    }
+    if (queue_.TryPop(result)) return result;
+    // Other members of the pool may have taken the jobs first.
+    if (pool_ != nullptr && pool_->tryGetJob(this, result)) return result;
+    // Otherwise a `putJob` is still linking its job. The queue looks empty until then, so the next
+    // iteration parks, and that `putJob` wakes the worker up.
+  }
 }
 
 KLong Worker::checkDelayedLocked() {
-  if (delayed_.size() == 0) {
+  if (delayed_.Empty()) {
     return -1;
   }
-  auto it = delayed_.begin();
-  auto job = *it;
-  RuntimeAssert(job.kind == JOB_EXECUTE_AFTER, "Must be delayed job");
   auto now = konan::getTimeMicros();
-  if (job.executeAfter.whenExecute <= now) {
-    delayed_.erase(it);
-    queue_.push_back(job);
-    return 0;
-  } else {
-    return job.executeAfter.whenExecute - now;
-  }
-}
-
-bool Worker::waitForQueueLocked(KLong timeoutMicroseconds, KLong* remaining) {
-  while (queue_.size() == 0) {
+  bool expired = false;
+  delayed_.Expire(now, [this, &expired](const Job& job) {
+    RuntimeAssert(job.kind == JOB_EXECUTE_AFTER, "Must be delayed job");
+    if (job.executeAfter.cancellationKey != 0) {
+      cancellableDelayed_.erase(job.executeAfter.cancellationKey);
+    }
+    queue_.Push(job);
+    expired = true;
+  });
+  return expired ? 0 : delayed_.NextExpiration(now);
+}
+
+bool Worker::waitForQueueLocked(KLong timeoutMicroseconds, KLong* remaining, bool watchFileDescriptors) {
+  // Producers of regular jobs signal `cond_` only while this is set.
+  waiting_.store(true);
+  if (pool_ != nullptr) pool_->setMemberWaiting(true);
+  bool poll = watchFileDescriptors && watcher_ != nullptr && !watcher_->empty();
+  bool result = true;
+  while (!hasJobs()) {
     KLong closestToRunMicroseconds = checkDelayedLocked();
     if (closestToRunMicroseconds == 0) {
         continue;
@@ -956,7 +1883,14 @@ bool Worker::waitForQueueLocked(KLong timeoutMicroseconds, KLong* remaining) {
           ? timeoutMicroseconds
           : closestToRunMicroseconds;
     }
-    if (closestToRunMicroseconds == 0) {
+    if (poll) {
+      uint64_t start = konan::getTimeMicros();
+      bool ready = pollLocked(closestToRunMicroseconds);
+      if (remaining) {
+        *remaining = closestToRunMicroseconds < 0 ? 0 : timeoutMicroseconds - (konan::getTimeMicros() - start);
+      }
+      if (ready) break;
+    } else if (closestToRunMicroseconds == 0) {
       // Just no wait at all here.
     } else if (closestToRunMicroseconds > 0) {
       // Protect from potential overflow, cutting at 10_000_000 seconds, aka 115 days.
@@ -972,21 +1906,28 @@ bool Worker::waitForQueueLocked(KLong timeoutMicroseconds, KLong* remaining) {
       waitInNativeState(&cond_, &lock_);
       if (remaining) *remaining = 0;
     }
-    if (timeoutMicroseconds >= 0) return queue_.size() != 0;
+    if (timeoutMicroseconds >= 0) {
+      result = hasJobs();
+      break;
+    }
   }
-  return true;
+  if (pool_ != nullptr) pool_->setMemberWaiting(false);
+  waiting_.store(false);
+  return result;
 }
 
 bool Worker::park(KLong timeoutMicroseconds, bool process) {
+  bool fileDescriptorsReady = false;
   {
     Locker locker(&lock_);
     if (terminated_) {
       return false;
     }
+    if (watcher_ != nullptr) watcher_->clearReady();
     auto arrived = false;
     KLong remaining = timeoutMicroseconds;
     do {
-      arrived = waitForQueueLocked(remaining, &remaining);
+      arrived = waitForQueueLocked(remaining, &remaining, /* watchFileDescriptors = */ true);
     } while (remaining > 0 && !arrived);
     if (!process) {
       return arrived;
@@ -994,14 +1935,51 @@ bool Worker::park(KLong timeoutMicroseconds, bool process) {
     if (!arrived) {
       return false;
     }
+    fileDescriptorsReady = watcher_ != nullptr && !watcher_->ready().empty();
+  }
+  return processQueueElement(false) >= JOB_REGULAR || fileDescriptorsReady;
+}
+
+bool Worker::pollLocked(KLong timeoutMicroseconds) {
+  polling_ = true;
+  bool ready;
+  {
+    ThreadStateGuard guard(ThreadState::kNative);
+    pthread_mutex_unlock(&lock_);
+    // Jobs put meanwhile signal the eventfd, which keeps the signal until this waits for it.
+    ready = watcher_->wait(timeoutMicroseconds);
+    pthread_mutex_lock(&lock_);
+  }
+  polling_ = false;
+  return ready;
+}
+
+bool Worker::watchFileDescriptor(KInt fd, bool readable, bool writable) {
+  Locker locker(&lock_);
+  if (watcher_ == nullptr) {
+    watcher_ = FileDescriptorWatcher::create();
+    if (watcher_ == nullptr) return false;
   }
-  return processQueueElement(false) >= JOB_REGULAR;
+  return watcher_->add(fd, readable, writable);
+}
+
+bool Worker::unwatchFileDescriptor(KInt fd) {
+  Locker locker(&lock_);
+  return watcher_ != nullptr && watcher_->remove(fd);
+}
+
+const KStdVector<KInt>& Worker::readyFileDescriptors() const {
+  static const KStdVector<KInt> none;
+  return watcher_ != nullptr ? watcher_->ready() : none;
 }
 
 JobKind Worker::processQueueElement(bool blocking) {
   GC_CollectorCallback(this);
   if (terminated_) return JOB_TERMINATE;
-  Job job = getJob(blocking);
+  return processJob(getJob(blocking), blocking);
+}
+
+JobKind Worker::processJob(Job job, bool blocking) {
   switch (job.kind) {
     case JOB_NONE: {
       break;
@@ -1012,11 +1990,23 @@ JobKind Worker::processQueueElement(bool blocking) {
           putJob(job, false);
           return JOB_NONE;
         }
+        Job poolJob;
+        if (pool_ != nullptr && pool_->tryGetJob(this, poolJob)) {
+          // Help the rest of the pool with the scheduled jobs first.
+          putJob(job, false);
+          return processJob(poolJob, blocking);
+        }
       }
       terminated_ = true;
       // Termination request, remove the worker and notify the future.
       theState()->removeWorkerUnlocked(id());
-      job.terminationRequest.future->storeResultUnlocked(nullptr, true);
+      if (job.terminationRequest.future != nullptr)
+        job.terminationRequest.future->storeResultUnlocked(nullptr, true);
+      if (pool_ != nullptr) {
+        WorkerPool* pool = pool_;
+        pool_ = nullptr;
+        if (pool->memberTerminated(this)) theState()->destroyPoolUnlocked(pool, memoryState_);
+      }
       break;
     }
     case JOB_EXECUTE_AFTER: {
@@ -1057,6 +2047,21 @@ JobKind Worker::processQueueElement(bool blocking) {
       job.regularJob.future->storeResultUnlocked(result, ok);
       break;
     }
+    case JOB_DETACHED: {
+      ObjHolder argumentHolder;
+      ObjHolder resultHolder;
+      KRef argument = AdoptStablePointer(job.detachedJob.argument, argumentHolder.slot());
+      try {
+#if KONAN_OBJC_INTEROP
+        konan::AutoreleasePool autoreleasePool;
+#endif
+        job.detachedJob.function(argument, resultHolder.slot());
+      } catch (ExceptionObjHolder& e) {
+        if (errorReporting())
+          ReportUnhandledException(e.GetExceptionObject());
+      }
+      break;
+    }
     default: {
       RuntimeCheck(false, "Must be exhaustive");
     }
@@ -1072,6 +2077,15 @@ KInt Kotlin_Worker_startInternal(KBoolean noErrorReporting, KRef customName) {
   return startWorker(noErrorReporting, customName);
 }
 
+KInt Kotlin_Worker_startWithOptionsInternal(KBoolean errorReporting, KRef customName, KLong stackSize, KConstRef cpus,
+                                           KBoolean hasPriority, KInt priority, KRef threadName) {
+  return startWorkerWithOptions(errorReporting, customName, stackSize, cpus, hasPriority, priority, threadName);
+}
+
+KInt Kotlin_Worker_startPoolInternal(KInt size, KBoolean errorReporting, KRef customName) {
+  return startPool(size, errorReporting, customName);
+}
+
 KInt Kotlin_Worker_currentInternal() {
   return currentWorker();
 }
@@ -1084,10 +2098,26 @@ KInt Kotlin_Worker_executeInternal(KInt id, KInt transferMode, KRef producer, KN
   return execute(id, transferMode, producer, job);
 }
 
+KInt Kotlin_Worker_executeBatchInternal(KInt id, KInt transferMode, KInt count, KRef producer) {
+  return executeBatch(id, transferMode, count, producer);
+}
+
+void Kotlin_Worker_executeDetachedInternal(KInt id, KInt transferMode, KRef producer) {
+  executeDetached(id, transferMode, producer);
+}
+
 void Kotlin_Worker_executeAfterInternal(KInt id, KRef job, KLong afterMicroseconds) {
   executeAfter(id, job, afterMicroseconds);
 }
 
+KLong Kotlin_Worker_executeAfterCancellableInternal(KInt id, KRef job, KLong afterMicroseconds) {
+  return executeAfterCancellable(id, job, afterMicroseconds);
+}
+
+KBoolean Kotlin_Worker_cancelDelayedInternal(KInt id, KLong key) {
+  return cancelDelayed(id, key);
+}
+
 KBoolean Kotlin_Worker_processQueueInternal(KInt id) {
   return processQueue(id);
 }
@@ -1096,6 +2126,18 @@ KBoolean Kotlin_Worker_parkInternal(KInt id, KLong timeoutMicroseconds, KBoolean
   return park(id, timeoutMicroseconds, process);
 }
 
+KBoolean Kotlin_Worker_watchFileDescriptorInternal(KInt id, KInt fd, KBoolean readable, KBoolean writable) {
+  return watchFileDescriptor(id, fd, readable, writable);
+}
+
+KBoolean Kotlin_Worker_unwatchFileDescriptorInternal(KInt id, KInt fd) {
+  return unwatchFileDescriptor(id, fd);
+}
+
+OBJ_GETTER(Kotlin_Worker_readyFileDescriptorsInternal, KInt id) {
+  RETURN_RESULT_OF(readyFileDescriptors, id);
+}
+
 OBJ_GETTER(Kotlin_Worker_getNameInternal, KInt id) {
   RETURN_RESULT_OF(getWorkerName, id);
 }
@@ -1108,12 +2150,8 @@ OBJ_GETTER(Kotlin_Worker_consumeFuture, KInt id) {
   RETURN_RESULT_OF(consumeFuture, id);
 }
 
-KBoolean Kotlin_Worker_waitForAnyFuture(KInt versionToken, KInt millis) {
-  return waitForAnyFuture(versionToken, millis);
-}
-
-KInt Kotlin_Worker_versionToken() {
-  return versionToken();
+void Kotlin_Worker_waitForFutures(KConstRef ids, KInt millis) {
+  waitForFutures(ids, millis);
 }
 
 OBJ_GETTER(Kotlin_Worker_attachObjectGraphInternal, KNativePtr stable) {
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package kotlin.native.concurrent
+
+import kotlin.native.internal.Frozen
+import kotlin.native.internal.GCUnsafeCall
+import kotlin.native.internal.createCleaner
+import kotlinx.cinterop.NativePtr
+
+/**
+ * Bounded channel passing messages between workers, without a job or a [Future] per message.
+ * Any number of workers may send and receive at the same time, every message is received just once,
+ * in the order messages are sent in.
+ *
+ * Messages are object graphs transferred the same way as with [DetachedObjectGraph]: a message is produced
+ * by a producer function, and it must be an isolated object subgraph in [TransferMode.SAFE] mode.
+ *
+ * @param capacity the number of messages the channel holds before senders have to wait for receivers.
+ */
+@Frozen
+@OptIn(ExperimentalStdlibApi::class)
+public class Channel<T : Any>(public val capacity: Int) {
+    init {
+        if (capacity <= 0) throw IllegalArgumentException("Capacity must be positive")
+    }
+
+    private val handle = ChannelHandle(createChannel(capacity))
+
+    // Disposes the messages that were never received.
+    private val cleaner = createCleaner(handle) { destroyChannel(it.pointer) }
+
+    private val pointer: NativePtr
+        get() = handle.pointer
+
+    /**
+     * Sends the message produced by [producer], waiting while the channel is full.
+     *
+     * @return `false` if the channel is closed, the produced message is dropped then.
+     */
+    public fun send(mode: TransferMode = TransferMode.SAFE, producer: () -> T): Boolean =
+            sendToChannel(pointer, detachObjectGraphInternal(mode.value, producer), true)
+
+    /**
+     * Sends the message produced by [producer], if there's space for it in the channel.
+     *
+     * @return `false` if the channel is full or closed, the produced message is dropped then.
+     */
+    public fun trySend(mode: TransferMode = TransferMode.SAFE, producer: () -> T): Boolean =
+            sendToChannel(pointer, detachObjectGraphInternal(mode.value, producer), false)
+
+    /**
+     * Receives the next message, waiting while the channel is empty.
+     *
+     * @throws [IllegalStateException] if the channel is closed, and all its messages are received already.
+     */
+    @Suppress("UNCHECKED_CAST")
+    public fun receive(): T =
+            (receiveFromChannel(pointer, true) ?: throw IllegalStateException("Channel is closed")) as T
+
+    /**
+     * Receives the next message, if there's one.
+     *
+     * @return the message, or `null` if the channel is empty.
+     */
+    @Suppress("UNCHECKED_CAST")
+    public fun tryReceive(): T? = receiveFromChannel(pointer, false) as T?
+
+    /**
+     * Closes the channel: no more messages can be sent, while the messages sent already can still be received.
+     * Wakes up all the senders and receivers waiting for the channel.
+     */
+    public fun close(): Unit = closeChannel(pointer)
+
+    /**
+     * If the channel is closed.
+     */
+    public val isClosed: Boolean
+        get() = isChannelClosed(pointer)
+}
+
+// Cleaners need a frozen argument.
+@Frozen
+private class ChannelHandle(val pointer: NativePtr)
+
+@GCUnsafeCall("Kotlin_Channel_create")
+private external fun createChannel(capacity: Int): NativePtr
+
+@GCUnsafeCall("Kotlin_Channel_destroy")
+private external fun destroyChannel(channel: NativePtr)
+
+@GCUnsafeCall("Kotlin_Channel_send")
+private external fun sendToChannel(channel: NativePtr, message: NativePtr, blocking: Boolean): Boolean
+
+@GCUnsafeCall("Kotlin_Channel_receive")
+private external fun receiveFromChannel(channel: NativePtr, blocking: Boolean): Any?
+
+@GCUnsafeCall("Kotlin_Channel_close")
+private external fun closeChannel(channel: NativePtr)
+
+@GCUnsafeCall("Kotlin_Channel_isClosed")
+private external fun isChannelClosed(channel: NativePtr): Boolean
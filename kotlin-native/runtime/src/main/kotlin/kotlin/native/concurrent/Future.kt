@@ -81,18 +81,19 @@ public fun <T> Collection<Future<T>>.waitForMultipleFutures(millis: Int): Set<Fu
  */
 public fun <T> waitForMultipleFutures(futures: Collection<Future<T>>, timeoutMillis: Int): Set<Future<T>> {
     val result = mutableSetOf<Future<T>>()
+    val scheduled = ArrayList<Int>(futures.size)
 
-    while (true) {
-        val versionToken = versionToken()
-        for (future in futures) {
-            if (future.state == FutureState.COMPUTED) {
-                result += future
-            }
+    for (future in futures) {
+        when (future.state) {
+            FutureState.COMPUTED -> result += future
+            FutureState.SCHEDULED -> scheduled += future.id
+            else -> {}
         }
-        if (result.isNotEmpty()) return result
-
-        if (waitForAnyFuture(versionToken, timeoutMillis)) break
     }
+    if (result.isNotEmpty() || scheduled.isEmpty()) return result
+
+    // Only the futures we wait for wake us up, not every future in the process.
+    waitForFutures(scheduled.toIntArray(), timeoutMillis)
 
     for (future in futures) {
         if (future.state == FutureState.COMPUTED) {
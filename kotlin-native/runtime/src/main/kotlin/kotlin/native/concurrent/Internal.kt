@@ -23,11 +23,9 @@ external internal fun stateOfFuture(id: Int): Int
 @PublishedApi
 external internal fun consumeFuture(id: Int): Any?
 
-@GCUnsafeCall("Kotlin_Worker_waitForAnyFuture")
-external internal fun waitForAnyFuture(versionToken: Int, millis: Int): Boolean
-
-@GCUnsafeCall("Kotlin_Worker_versionToken")
-external internal fun versionToken(): Int
+// Waits until any of the futures [ids] is completed, or [millis] pass. Negative [millis] means no timeout.
+@GCUnsafeCall("Kotlin_Worker_waitForFutures")
+external internal fun waitForFutures(ids: IntArray, millis: Int): Unit
 
 @kotlin.native.internal.ExportForCompiler
 internal fun executeImpl(worker: Worker, mode: TransferMode, producer: () -> Any?,
@@ -37,6 +35,13 @@ internal fun executeImpl(worker: Worker, mode: TransferMode, producer: () -> Any
 @GCUnsafeCall("Kotlin_Worker_startInternal")
 external internal fun startInternal(errorReporting: Boolean, name: String?): Int
 
+@GCUnsafeCall("Kotlin_Worker_startWithOptionsInternal")
+external internal fun startWithOptionsInternal(errorReporting: Boolean, name: String?, stackSize: Long, cpus: IntArray?,
+                                               hasPriority: Boolean, priority: Int, threadName: String?): Int
+
+@GCUnsafeCall("Kotlin_Worker_startPoolInternal")
+external internal fun startPoolInternal(size: Int, errorReporting: Boolean, name: String?): Int
+
 @GCUnsafeCall("Kotlin_Worker_currentInternal")
 external internal fun currentInternal(): Int
 
@@ -47,15 +52,36 @@ external internal fun requestTerminationInternal(id: Int, processScheduledJobs:
 external internal fun executeInternal(
         id: Int, mode: Int, producer: () -> Any?, job: CPointer<CFunction<*>>): Int
 
+@GCUnsafeCall("Kotlin_Worker_executeBatchInternal")
+external internal fun executeBatchInternal(id: Int, mode: Int, count: Int, producer: (Int) -> Any?): Int
+
+@GCUnsafeCall("Kotlin_Worker_executeDetachedInternal")
+external internal fun executeDetachedInternal(id: Int, mode: Int, producer: () -> Any?): Unit
+
 @GCUnsafeCall("Kotlin_Worker_executeAfterInternal")
 external internal fun executeAfterInternal(id: Int, operation: () -> Unit, afterMicroseconds: Long): Unit
 
+@GCUnsafeCall("Kotlin_Worker_executeAfterCancellableInternal")
+external internal fun executeAfterCancellableInternal(id: Int, operation: () -> Unit, afterMicroseconds: Long): Long
+
+@GCUnsafeCall("Kotlin_Worker_cancelDelayedInternal")
+external internal fun cancelDelayedInternal(id: Int, key: Long): Boolean
+
 @GCUnsafeCall("Kotlin_Worker_processQueueInternal")
 external internal fun processQueueInternal(id: Int): Boolean
 
 @GCUnsafeCall("Kotlin_Worker_parkInternal")
 external internal fun parkInternal(id: Int, timeoutMicroseconds: Long, process: Boolean): Boolean
 
+@GCUnsafeCall("Kotlin_Worker_watchFileDescriptorInternal")
+external internal fun watchFileDescriptorInternal(id: Int, fd: Int, readable: Boolean, writable: Boolean): Boolean
+
+@GCUnsafeCall("Kotlin_Worker_unwatchFileDescriptorInternal")
+external internal fun unwatchFileDescriptorInternal(id: Int, fd: Int): Boolean
+
+@GCUnsafeCall("Kotlin_Worker_readyFileDescriptorsInternal")
+external internal fun readyFileDescriptorsInternal(id: Int): IntArray
+
 @GCUnsafeCall("Kotlin_Worker_getNameInternal")
 external internal fun getWorkerNameInternal(id: Int): String?
 
@@ -70,6 +96,17 @@ internal fun ThrowWorkerInvalidState(): Unit =
 @ExportForCppRuntime
 internal fun WorkerLaunchpad(function: () -> Any?) = function()
 
+// Job with the state captured by a frozen lambda, for the jobs submitted without the `execute` intrinsic.
+internal class LambdaJob<T1, T2>(val job: (T1) -> T2, val argument: T1) {
+    fun run(): T2 = job(argument)
+}
+
+@ExportForCppRuntime
+internal fun WorkerBatchLaunchpad(producer: (Int) -> Any?, index: Int) = producer(index)
+
+@ExportForCppRuntime
+internal fun WorkerLambdaJobLaunchpad(lambdaJob: Any?) = (lambdaJob as LambdaJob<*, *>).run()
+
 @PublishedApi
 @GCUnsafeCall("Kotlin_Worker_detachObjectGraphInternal")
 external internal fun detachObjectGraphInternal(mode: Int, producer: () -> Any?): NativePtr
@@ -41,6 +41,36 @@ public inline class Worker @PublishedApi internal constructor(val id: Int) {
         public fun start(errorReporting: Boolean = true, name: String? = null): Worker
                 = Worker(startInternal(errorReporting, name))
 
+        /**
+         * Start new worker like [start] does, with its thread configured by [threadOptions].
+         *
+         * @param errorReporting controls if an uncaught exceptions in the worker will be printed out
+         * @param name defines the optional name of this worker, if none - default naming is used.
+         * @param threadOptions stack size, CPU affinity, priority and name of the worker thread.
+         * @return worker object, usable across multiple concurrent contexts.
+         */
+        public fun start(errorReporting: Boolean = true, name: String? = null, threadOptions: WorkerThreadOptions): Worker
+                = Worker(startWithOptionsInternal(errorReporting, name, threadOptions.stackSize, threadOptions.cpuAffinity,
+                        threadOptions.priority != null, threadOptions.priority ?: 0, threadOptions.threadName))
+
+        /**
+         * Start a pool of workers sharing the jobs submitted to it. The returned worker represents the whole pool:
+         * jobs planned with [execute] and [executeAfter] are run by any idle member of the pool, so that
+         * independent jobs run in parallel, and a slow job only holds up the member running it.
+         * Jobs planned by a member itself are kept by this member, unless an idle member steals them.
+         * Note that jobs of the pool may run in any order.
+         *
+         * [requestTermination] terminates all the members of the pool, the pool cannot be [park]ed
+         * or have its queue processed with [processQueue].
+         *
+         * @param size the number of workers in the pool, if not positive - the number of available processors.
+         * @param errorReporting controls if an uncaught exceptions in the pool will be printed out
+         * @param name defines the optional name of the pool and its members, if none - default naming is used.
+         * @return worker object representing the pool, usable across multiple concurrent contexts.
+         */
+        public fun startPool(size: Int = 0, errorReporting: Boolean = true, name: String? = null): Worker
+                = Worker(startPoolInternal(size, errorReporting, name))
+
         /**
          * Return the current worker. Worker context is accessible to any valid Kotlin context,
          * but only actual active worker produced with [Worker.start] automatically processes execution requests.
@@ -96,6 +126,35 @@ public inline class Worker @PublishedApi internal constructor(val id: Int) {
              */
             throw RuntimeException("Shall not be called directly")
 
+    /**
+     * Plan a batch of [count] jobs for execution in the worker. Works like [execute] called [count] times,
+     * with the index of the job passed to [producer], but all the jobs are added to the queue of the worker
+     * at once, waking it up just once.
+     *
+     * Unlike the job of [execute], [job] may capture state: it gets frozen and is shared by all the jobs of the batch.
+     *
+     * @return futures with the computation results of the jobs, in the order of their indices.
+     * @throws [IllegalArgumentException] on negative [count].
+     */
+    public fun <T1, T2> executeBatch(mode: TransferMode, count: Int, producer: (Int) -> T1, job: (T1) -> T2): List<Future<T2>> {
+        if (count < 0) throw IllegalArgumentException("Count must be non-negative")
+        job.freeze()
+        val first = executeBatchInternal(id, mode.value, count) { index -> LambdaJob(job, producer(index)) }
+        return List(count) { Future<T2>(first + it) }
+    }
+
+    /**
+     * Plan job for execution in the worker, when its result is not needed. Works like [execute], but without
+     * a [Future]: whatever [job] returns is dropped, and so is an exception it throws, after being reported
+     * if the worker does error reporting.
+     *
+     * Like the job of [executeBatch], [job] may capture state, which gets frozen.
+     */
+    public fun <T> executeDetached(mode: TransferMode, producer: () -> T, job: (T) -> Unit): Unit {
+        job.freeze()
+        executeDetachedInternal(id, mode.value) { LambdaJob(job, producer()) }
+    }
+
     /**
      * Plan job for further execution in the worker. [operation] parameter must be either frozen, or execution to be
      * planned on the current worker. Otherwise [IllegalStateException] will be thrown.
@@ -111,6 +170,30 @@ public inline class Worker @PublishedApi internal constructor(val id: Int) {
         executeAfterInternal(id, operation, afterMicroseconds)
     }
 
+    /**
+     * Plan job for further execution in the worker, like [executeAfter], but so that it can be cancelled with
+     * [cancelDelayed] until it's due. Cancelling is cheap, so this fits timeouts that rarely fire.
+     * [operation] parameter must be frozen, as the job may be disposed of by the thread that cancels it.
+     *
+     * @param afterMicroseconds defines after how many microseconds delay execution shall happen, 0 means immediately,
+     * and such a job cannot be cancelled.
+     * @return the key to cancel the job with.
+     * @throws [IllegalArgumentException] on negative values of [afterMicroseconds].
+     * @throws [IllegalStateException] if [operation] parameter is not frozen.
+     */
+    public fun executeAfterCancellable(afterMicroseconds: Long, operation: () -> Unit): Long {
+        if (!operation.isFrozen) throw IllegalStateException("Cancellable job must be frozen")
+        if (afterMicroseconds < 0) throw IllegalArgumentException("Timeout parameter must be non-negative")
+        return executeAfterCancellableInternal(id, operation, afterMicroseconds)
+    }
+
+    /**
+     * Cancel a job planned with [executeAfterCancellable] on this worker, so that it's never executed.
+     *
+     * @return `true` if the job was cancelled, and `false` if it's already due or executed, or was cancelled before.
+     */
+    public fun cancelDelayed(key: Long): Boolean = cancelDelayedInternal(id, key)
+
     /**
      * Process pending job(s) on the queue of this worker.
      * Note that jobs scheduled with [executeAfter] using non-zero timeout are
@@ -126,11 +209,12 @@ public inline class Worker @PublishedApi internal constructor(val id: Int) {
      * Park execution of the current worker until a new request arrives or timeout specified in
      * [timeoutMicroseconds] elapsed. If [process] is true, pending queue elements are processed,
      * including delayed requests. Note that multiple requests could be processed this way.
+     * Park also returns when some of the file descriptors watched with [watchFileDescriptor] are ready.
      *
      * @param timeoutMicroseconds defines how long to park worker if no requests arrive, waits forever if -1.
      * @param process defines if arrived request(s) shall be processed.
-     * @return if [process] is `true`: if request(s) was processed `true` and `false` otherwise.
-     *   if [process] is `false`:` true` if request(s) has arrived and `false` if timeout happens.
+     * @return if [process] is `true`: if request(s) was processed or file descriptors are ready `true` and `false` otherwise.
+     *   if [process] is `false`:` true` if request(s) has arrived or file descriptors are ready and `false` if timeout happens.
      * @throws [IllegalStateException] if this request is executed on non-current [Worker].
      * @throws [IllegalArgumentException] if timeout value is incorrect.
      */
@@ -139,6 +223,35 @@ public inline class Worker @PublishedApi internal constructor(val id: Int) {
         return parkInternal(id, timeoutMicroseconds, process)
     }
 
+    /**
+     * Make [park] of the current worker also return when the file descriptor [fd] becomes ready for reading
+     * if [readable], or for writing if [writable]. Readiness is level-triggered: [park] keeps returning
+     * while the file descriptor stays ready. Watching a watched file descriptor again changes its events.
+     * Only supported on Linux and Android.
+     *
+     * @return `true` if [fd] is watched, `false` if it cannot be, or the platform doesn't support watching.
+     * @throws [IllegalStateException] if this request is executed on non-current [Worker].
+     */
+    public fun watchFileDescriptor(fd: Int, readable: Boolean = true, writable: Boolean = false): Boolean =
+            watchFileDescriptorInternal(id, fd, readable, writable)
+
+    /**
+     * Stop watching the file descriptor [fd] watched with [watchFileDescriptor].
+     * File descriptors must be unwatched before they are closed.
+     *
+     * @return `true` if [fd] was watched.
+     * @throws [IllegalStateException] if this request is executed on non-current [Worker].
+     */
+    public fun unwatchFileDescriptor(fd: Int): Boolean = unwatchFileDescriptorInternal(id, fd)
+
+    /**
+     * File descriptors found ready by the last [park] of the current worker, empty if it returned for other reasons.
+     *
+     * @throws [IllegalStateException] if this request is executed on non-current [Worker].
+     */
+    public val readyFileDescriptors: IntArray
+        get() = readyFileDescriptorsInternal(id)
+
     /**
      * Name of the worker, as specified in [Worker.start] or "worker $id" by default,
      *
@@ -169,6 +282,25 @@ public inline class Worker @PublishedApi internal constructor(val id: Int) {
     public fun asCPointer() : COpaquePointer? = id.toLong().toCPointer()
 }
 
+/**
+ * Options of the thread of a worker started with [Worker.start].
+ * CPU affinity and priority are only supported on Linux and Android; elsewhere, and when the system denies them,
+ * they are ignored with a message on the console.
+ *
+ * @param stackSize stack size of the thread in bytes, if not positive - the platform default.
+ * @param cpuAffinity indices of the CPUs the thread may run on, if `null` - any CPU.
+ * @param priority nice value of the thread, from -20 (highest priority) to 19 (lowest), if `null` - inherited.
+ * Raising the priority usually requires privileges.
+ * @param threadName name of the thread as seen by debuggers and profilers, if `null` - the worker name.
+ * It may be truncated, on Linux to 15 bytes.
+ */
+public class WorkerThreadOptions(
+        public val stackSize: Long = 0,
+        public val cpuAffinity: IntArray? = null,
+        public val priority: Int? = null,
+        public val threadName: String? = null
+)
+
 /**
  * Executes [block] with new [Worker] as resource, by starting the new worker, calling provided [block]
  * (in current context) with newly started worker as [this] and terminating worker after the block completes.
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+package kotlin.native.internal
+
+/**
+ * Runs [block] with all objects it allocates on the current thread placed into a bump-pointer arena,
+ * which is released as a whole when [block] completes. The GC never marks or sweeps arena objects,
+ * so this is useful for short bursts of temporary allocations (parsing, formatting, etc.).
+ *
+ * The result of [block] (or the exception thrown from it) is copied into the heap together with
+ * everything it references in the arena. No other arena object may escape [block]: storing one
+ * into a heap object, a global, a stable reference or an object of an enclosing [withArena] aborts
+ * the program. So a heap object can never reference an arena one, and the copy is complete.
+ *
+ * Objects placed into the arena count towards the GC trigger, just like heap allocations.
+ *
+ * Limitations:
+ * - Objects with finalizers and Obj-C backed objects are always allocated in the heap,
+ *   so they cannot reference arena objects either.
+ * - Arena objects look frozen to the runtime, and cannot be weakly referenced.
+ * - Only supported by the new memory manager. With the legacy one, [block] just runs as is.
+ */
+@InternalForKotlinNative
+public inline fun <R> withArena(block: () -> R): R {
+    Arena_enter()
+    val result = try {
+        block()
+    } catch (e: Throwable) {
+        val promoted = Arena_promote(e) as Throwable
+        Arena_leave()
+        throw promoted
+    }
+    @Suppress("UNCHECKED_CAST")
+    val promoted = Arena_promote(result) as R
+    Arena_leave()
+    return promoted
+}
+
+@PublishedApi
+@GCUnsafeCall("Kotlin_native_internal_Arena_enter")
+internal external fun Arena_enter()
+
+@PublishedApi
+@GCUnsafeCall("Kotlin_native_internal_Arena_leave")
+internal external fun Arena_leave()
+
+@PublishedApi
+@GCUnsafeCall("Kotlin_native_internal_Arena_promote")
+internal external fun Arena_promote(value: Any?): Any?
@@ -14,6 +14,11 @@ public object Debugging {
 
     public val isThreadStateRunnable: Boolean
         get() = Debugging_isThreadStateRunnable()
+
+    // How many subgraphs the current thread has transferred as a single container referenced only by the transfer
+    // itself, without analyzing the heap. Always 0 for the experimental MM.
+    public val exclusiveLeafTransfers: Long
+        get() = Debugging_getExclusiveLeafTransfers()
 }
 
 @GCUnsafeCall("Kotlin_Debugging_isPermanent")
@@ -24,6 +29,11 @@ public external fun Any.isPermanent() : Boolean
 @InternalForKotlinNative
 public external fun Any.isLocal() : Boolean
 
+// Whether the object is stored in a global that the GC scans as a root. Always `false` for the legacy MM.
+@GCUnsafeCall("Kotlin_Debugging_isReferencedByGlobalRoot")
+@InternalForKotlinNative
+public external fun Any.isReferencedByGlobalRoot() : Boolean
+
 @GCUnsafeCall("Kotlin_Debugging_getForceCheckedShutdown")
 private external fun Debugging_getForceCheckedShutdown(): Boolean
 
@@ -32,3 +42,6 @@ private external fun Debugging_setForceCheckedShutdown(value: Boolean): Unit
 
 @GCUnsafeCall("Kotlin_Debugging_isThreadStateRunnable")
 private external fun Debugging_isThreadStateRunnable(): Boolean
+
+@GCUnsafeCall("Kotlin_Debugging_getExclusiveLeafTransfers")
+private external fun Debugging_getExclusiveLeafTransfers(): Long
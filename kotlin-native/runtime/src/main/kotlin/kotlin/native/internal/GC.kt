@@ -93,6 +93,91 @@ object GC {
         set(value) = setTuneThreshold(value)
 
 
+    /**
+     * Heap size in bytes, after which the collector starts clearing soft references
+     * (see [kotlin.native.ref.SoftReference]). Not supported by the legacy memory manager.
+     */
+    var softReferencesThreshold: Long
+        get() = getSoftReferencesThreshold()
+        set(value) = setSoftReferencesThreshold(value)
+
+    /**
+     * How long in milliseconds a soft reference may stay unused, before it can be cleared when the heap
+     * is at [softReferencesThreshold]. Allowed time shrinks as the heap grows further.
+     * Not supported by the legacy memory manager.
+     */
+    var softReferencesMaxIdleMillis: Long
+        get() = getSoftReferencesMaxIdleMillis()
+        set(value) = setSoftReferencesMaxIdleMillis(value)
+
+    /**
+     * Soft limit on the heap size in bytes, including memory reported with [reportExternalAllocation], or 0 if
+     * there is no limit. The closer the heap is to the limit, the more often the collector runs. If collections
+     * cannot get the heap below the limit, the collector returns free memory to the OS and reports thrashing to
+     * stderr. Defaults to 3/4 of the cgroup v2 `memory.max` of the process, if any.
+     * Not supported by the legacy memory manager.
+     */
+    var heapLimit: Long
+        get() = getHeapLimit()
+        set(value) = setHeapLimit(value)
+
+    /**
+     * Minimal time in milliseconds between returning unused memory to the OS after collections.
+     * 0 means after every collection, [Long.MAX_VALUE] disables it.
+     */
+    var scavengingIntervalMillis: Long
+        get() = getScavengingIntervalMillis()
+        set(value) = setScavengingIntervalMillis(value)
+
+    /**
+     * Memory in bytes that the allocator has taken from the OS, or 0 if the allocator cannot tell.
+     * Can be compared with [usedBytes] to see how much memory is kept for future allocations.
+     */
+    val committedBytes: Long
+        get() = getCommittedBytes()
+
+    /**
+     * Estimated memory in bytes taken by Kotlin objects and by memory reported with [reportExternalAllocation].
+     * Not supported by the legacy memory manager.
+     */
+    val usedBytes: Long
+        get() = getUsedBytes()
+
+    /**
+     * Report [bytes] of native memory owned by a Kotlin object, for example a buffer released by a [Cleaner].
+     * Reported memory counts towards [thresholdAllocations], so that small objects holding large native
+     * buffers still trigger collections. Memory allocated with `kotlinx.cinterop.nativeHeap` (and so by `memScoped`)
+     * is reported automatically, and must not be reported again. May perform a collection.
+     */
+    @GCUnsafeCall("Kotlin_native_internal_GC_reportExternalAllocation")
+    external fun reportExternalAllocation(bytes: Long)
+
+    /**
+     * Report that [bytes] of native memory previously reported with [reportExternalAllocation] were freed.
+     * Can be called from any thread, e.g. from a [Cleaner].
+     */
+    @GCUnsafeCall("Kotlin_native_internal_GC_reportExternalFree")
+    external fun reportExternalFree(bytes: Long)
+
+    /**
+     * Native memory reported with [reportExternalAllocation] by all threads and not freed yet.
+     * Reports of other threads may become visible here with a delay, as they are published in batches.
+     */
+    val externalBytes: Long
+        get() = getExternalBytes()
+
+    /**
+     * Total native memory reported with [reportExternalAllocation] by the current thread.
+     */
+    val currentThreadExternalAllocatedBytes: Long
+        get() = getCurrentThreadExternalAllocatedBytes()
+
+    /**
+     * Total native memory reported with [reportExternalFree] by the current thread.
+     */
+    val currentThreadExternalFreedBytes: Long
+        get() = getCurrentThreadExternalFreedBytes()
+
     /**
      * If cyclic collector for atomic references to be deployed.
      */
@@ -138,6 +223,45 @@ object GC {
     @GCUnsafeCall("Kotlin_native_internal_GC_setTuneThreshold")
     private external fun setTuneThreshold(value: Boolean)
 
+    @GCUnsafeCall("Kotlin_native_internal_GC_getSoftReferencesThreshold")
+    private external fun getSoftReferencesThreshold(): Long
+
+    @GCUnsafeCall("Kotlin_native_internal_GC_setSoftReferencesThreshold")
+    private external fun setSoftReferencesThreshold(value: Long)
+
+    @GCUnsafeCall("Kotlin_native_internal_GC_getSoftReferencesMaxIdleMillis")
+    private external fun getSoftReferencesMaxIdleMillis(): Long
+
+    @GCUnsafeCall("Kotlin_native_internal_GC_setSoftReferencesMaxIdleMillis")
+    private external fun setSoftReferencesMaxIdleMillis(value: Long)
+
+    @GCUnsafeCall("Kotlin_native_internal_GC_getHeapLimit")
+    private external fun getHeapLimit(): Long
+
+    @GCUnsafeCall("Kotlin_native_internal_GC_setHeapLimit")
+    private external fun setHeapLimit(value: Long)
+
+    @GCUnsafeCall("Kotlin_native_internal_GC_getScavengingIntervalMillis")
+    private external fun getScavengingIntervalMillis(): Long
+
+    @GCUnsafeCall("Kotlin_native_internal_GC_setScavengingIntervalMillis")
+    private external fun setScavengingIntervalMillis(value: Long)
+
+    @GCUnsafeCall("Kotlin_native_internal_GC_getCommittedBytes")
+    private external fun getCommittedBytes(): Long
+
+    @GCUnsafeCall("Kotlin_native_internal_GC_getUsedBytes")
+    private external fun getUsedBytes(): Long
+
+    @GCUnsafeCall("Kotlin_native_internal_GC_getExternalBytes")
+    private external fun getExternalBytes(): Long
+
+    @GCUnsafeCall("Kotlin_native_internal_GC_getCurrentThreadExternalAllocatedBytes")
+    private external fun getCurrentThreadExternalAllocatedBytes(): Long
+
+    @GCUnsafeCall("Kotlin_native_internal_GC_getCurrentThreadExternalFreedBytes")
+    private external fun getCurrentThreadExternalFreedBytes(): Long
+
     @GCUnsafeCall("Kotlin_native_internal_GC_getCyclicCollector")
     private external fun getCyclicCollectorEnabled(): Boolean
 
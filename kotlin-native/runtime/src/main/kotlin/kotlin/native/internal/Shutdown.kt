@@ -0,0 +1,63 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+package kotlin.native.internal
+
+import kotlin.native.concurrent.AtomicReference
+import kotlin.native.concurrent.freeze
+
+/**
+ * Controls what the runtime does when the program finishes, i.e. when `main` returns.
+ */
+public object Shutdown {
+    /**
+     * If `true`, the runtime doesn't clean up after itself at shutdown: the final garbage collection, finalizers,
+     * cleaners and the memory leak checkers are all skipped. Only the hooks added with [addHook] are run, and
+     * the console output is flushed. Useful for programs with big heaps, which exit right after the shutdown anyway.
+     *
+     * Can also be enabled by setting the `KOTLIN_NATIVE_FAST_SHUTDOWN` environment variable to `1`.
+     * Ignored if [Debugging.forceCheckedShutdown] is set.
+     */
+    public var isFast: Boolean
+        get() = Shutdown_isFast()
+        set(value) = Shutdown_setFast(value)
+
+    /**
+     * Adds [hook] to be run when the runtime shuts down, in any shutdown mode. Hooks run on the thread
+     * calling `main`, in the reverse order of addition. [hook] gets frozen, so that it could be added from any thread.
+     */
+    public fun addHook(hook: () -> Unit) {
+        hook.freeze()
+        while (true) {
+            val hooks = ShutdownHooksHolder.hooks.value
+            if (ShutdownHooksHolder.hooks.compareAndSet(hooks, ShutdownHookNode(hook, hooks).freeze())) return
+        }
+    }
+}
+
+private class ShutdownHookNode(val hook: () -> Unit, val next: ShutdownHookNode?)
+
+// Same as `UnhandledExceptionHookHolder`: makes sure `hooks` is initialized whenever it's needed.
+private object ShutdownHooksHolder {
+    val hooks: AtomicReference<ShutdownHookNode?> = AtomicReference(null)
+}
+
+@ExportForCppRuntime("Kotlin_runShutdownHooks")
+internal fun RunShutdownHooks() {
+    var node = ShutdownHooksHolder.hooks.swap(null)
+    while (node != null) {
+        try {
+            node.hook()
+        } catch (t: Throwable) {
+            ReportUnhandledException(t)
+        }
+        node = node.next
+    }
+}
+
+@GCUnsafeCall("Kotlin_Shutdown_isFast")
+private external fun Shutdown_isFast(): Boolean
+
+@GCUnsafeCall("Kotlin_Shutdown_setFast")
+private external fun Shutdown_setFast(value: Boolean): Unit
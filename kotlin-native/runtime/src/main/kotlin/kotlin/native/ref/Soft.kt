@@ -0,0 +1,52 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package kotlin.native.ref
+
+/**
+ * Class SoftReference encapsulates soft reference to an object. Unlike [WeakReference], a soft reference
+ * keeps the object alive until the memory manager decides that the heap is under pressure, which makes it
+ * suitable for memory-sensitive caches.
+ *
+ * Once the heap grows above [kotlin.native.internal.GC.softReferencesThreshold], softly reachable objects
+ * are cleared in the least recently used order: the longer the object hasn't been retrieved with [get],
+ * the sooner it's collected.
+ *
+ * With the legacy memory manager soft references keep their objects alive until [clear] is called.
+ */
+public class SoftReference<T : Any> {
+    /**
+     * Creates a soft reference object pointing to an object.
+     */
+    constructor(referred: T) {
+        pointer = getSoftReferenceImpl(referred)
+    }
+
+    /**
+     * Backing store for the object pointer, inaccessible directly.
+     */
+    @PublishedApi
+    internal var pointer: SoftReferenceImpl?
+
+    /**
+     * Clears reference to an object.
+     */
+    public fun clear() {
+        pointer = null
+    }
+
+    /**
+     * Returns either reference to an object or null, if it was collected.
+     * Counts as a use of the object for the purpose of choosing which soft references to clear.
+     */
+    @Suppress("UNCHECKED_CAST")
+    public fun get(): T? = pointer?.get() as T?
+
+    /**
+     * Returns either reference to an object or null, if it was collected.
+     */
+    public val value: T?
+        get() = this.get()
+}
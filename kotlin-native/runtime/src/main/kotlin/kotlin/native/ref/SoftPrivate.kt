@@ -0,0 +1,60 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package kotlin.native.ref
+
+import kotlinx.cinterop.COpaquePointer
+import kotlin.native.internal.ExportForCppRuntime
+import kotlin.native.internal.Frozen
+import kotlin.native.internal.GCUnsafeCall
+import kotlin.native.internal.NoReorderFields
+import kotlin.native.internal.Escapes
+
+/**
+ *   Theory of operations:
+ *
+ *  Soft references reuse the scheme of weak references (see WeakPrivate.kt): the metaobject of the referred
+ * object holds a strong reference to a counter object (instance of SoftReferenceCounter class), every soft
+ * reference holds a strong reference to the counter, and the counter refers to the object without keeping it
+ * alive. Additionally, the runtime registers every counter with the GC.
+ *
+ *  After marking, the GC looks at the registered counters that are reachable. If the referred object wasn't
+ * marked, the GC decides whether to retain it based on the heap size and on the time elapsed since the
+ * last dereference (stored in the counter). Retained objects are marked as usual, the others get swept,
+ * and their counters are cleared the same way as weak reference counters.
+ */
+
+// Counter object shared by all soft references to the same object.
+@NoReorderFields
+@Frozen
+internal class SoftReferenceCounter(var referred: COpaquePointer?) : SoftReferenceImpl() {
+    // Time of the last dereference in milliseconds, maintained by the runtime.
+    var lastAccessMillis: Long = 0
+
+    @GCUnsafeCall("Konan_SoftReferenceCounter_get")
+    external override fun get(): Any?
+}
+
+@PublishedApi
+internal abstract class SoftReferenceImpl {
+    abstract fun get(): Any?
+}
+
+// Get a counter from non-null object.
+@GCUnsafeCall("Konan_getSoftReferenceImpl")
+@Escapes(0b01) // referent escapes.
+external internal fun getSoftReferenceImpl(referent: Any): SoftReferenceImpl
+
+// Create a counter object.
+@ExportForCppRuntime
+internal fun makeSoftReferenceCounter(referred: COpaquePointer) = SoftReferenceCounter(referred)
+
+internal class StrongSoftReferenceImpl(val referred: Any) : SoftReferenceImpl() {
+    override fun get(): Any? = referred
+}
+
+// Create a reference that always keeps the object alive: used for permanent objects and by the legacy MM.
+@ExportForCppRuntime
+internal fun makeStrongSoftReferenceImpl(referred: Any) = StrongSoftReferenceImpl(referred)
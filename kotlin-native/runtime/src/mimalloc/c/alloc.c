@@ -459,6 +459,97 @@ void mi_free(void* p) mi_attr_noexcept
   }
 }
 
+#if KONAN_MI_MALLOC
+// Tells the owning heap about `block` through its delayed free list, when the page of the block
+// is in the full queue of the heap (see `_mi_free_block_mt`). Returns false if the page does not
+// need that (anymore), so that `block` should be pushed on the page thread free list instead.
+static bool mi_free_block_delayed_mt(mi_page_t* page, mi_block_t* block)
+{
+  mi_thread_free_t tfreex;
+  mi_thread_free_t tfree = mi_atomic_load_relaxed(&page->xthread_free);
+  do {
+    if (mi_tf_delayed(tfree) != MI_USE_DELAYED_FREE) return false;
+    tfreex = mi_tf_set_delayed(tfree,MI_DELAYED_FREEING);
+  } while (!mi_atomic_cas_weak_release(&page->xthread_free, &tfree, tfreex));
+
+  mi_heap_t* const heap = (mi_heap_t*)(mi_atomic_load_acquire(&page->xheap));
+  mi_assert_internal(heap != NULL);
+  if (heap != NULL) {
+    mi_block_t* dfree = mi_atomic_load_ptr_relaxed(mi_block_t, &heap->thread_delayed_free);
+    do {
+      mi_block_set_nextx(heap,block,dfree, heap->keys);
+    } while (!mi_atomic_cas_ptr_weak_release(mi_block_t,&heap->thread_delayed_free, &dfree, block));
+  }
+
+  tfree = mi_atomic_load_relaxed(&page->xthread_free);
+  do {
+    mi_assert_internal(mi_tf_delayed(tfree) == MI_DELAYED_FREEING);
+    tfreex = mi_tf_set_delayed(tfree,MI_NO_DELAYED_FREE);
+  } while (!mi_atomic_cas_weak_release(&page->xthread_free, &tfree, tfreex));
+  return true;
+}
+
+// Free `count` blocks. Consecutive blocks of a page owned by another thread are linked together
+// and pushed on the page thread free list at once, rather than with an atomic operation per block.
+void mi_free_batch(void** p, size_t count) mi_attr_noexcept
+{
+  const uintptr_t tid = _mi_thread_id();
+  size_t i = 0;
+  while (i < count) {
+    const mi_segment_t* const segment = mi_checked_ptr_segment(p[i],"mi_free_batch");
+    if (mi_unlikely(segment == NULL)) { i++; continue; }
+    mi_page_t* const page = _mi_segment_page_of(segment, p[i]);
+    if (tid == segment->thread_id || segment->page_kind == MI_PAGE_HUGE || mi_page_has_aligned(page)) {
+      // local frees need no atomic operations anyway
+      mi_free(p[i++]);
+      continue;
+    }
+
+    size_t end = i + 1;
+    while (end < count && p[end] != NULL && _mi_ptr_page(p[end]) == page) end++;
+
+    mi_block_t* first = (mi_block_t*)p[i];
+    mi_block_t* last = NULL;
+    for (size_t j = i; j < end; j++) {
+      mi_block_t* const block = (mi_block_t*)p[j];
+      #if (MI_STAT>1)
+      mi_heap_t* const heap = mi_heap_get_default();
+      const size_t bsize = mi_page_usable_block_size(page);
+      mi_heap_stat_decrease(heap, malloc, bsize);
+      if (bsize <= MI_LARGE_OBJ_SIZE_MAX) {
+        mi_heap_stat_decrease(heap, normal[_mi_bin(bsize)], 1);
+      }
+      #endif
+      mi_check_padding(page, block);
+      mi_padding_shrink(page, block, sizeof(mi_block_t));
+      #if (MI_DEBUG!=0)
+      memset(block, MI_DEBUG_FREED, mi_usable_size(block));
+      #endif
+      if (last != NULL) mi_block_set_next(page, last, block);
+      last = block;
+    }
+
+    mi_thread_free_t tfree = mi_atomic_load_relaxed(&page->xthread_free);
+    for (;;) {
+      if (mi_unlikely(mi_tf_delayed(tfree) == MI_USE_DELAYED_FREE)) {
+        // the first block goes to the owning heap, so that it takes the page out of the full queue
+        mi_block_t* const next = (first == last ? NULL : mi_block_next(page, first));
+        if (mi_free_block_delayed_mt(page, first)) {
+          if (next == NULL) break;
+          first = next;
+        }
+        tfree = mi_atomic_load_relaxed(&page->xthread_free);
+        continue;
+      }
+      mi_block_set_next(page, last, mi_tf_block(tfree));
+      mi_thread_free_t tfreex = mi_tf_set_block(tfree, first);
+      if (mi_atomic_cas_weak_release(&page->xthread_free, &tfree, tfreex)) break;
+    }
+    i = end;
+  }
+}
+#endif // KONAN_MI_MALLOC
+
 bool _mi_free_delayed_block(mi_block_t* block) {
   // get segment and page
   const mi_segment_t* const segment = _mi_ptr_segment(block);
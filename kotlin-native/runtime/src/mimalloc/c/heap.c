@@ -150,6 +150,10 @@ static void mi_heap_collect_ex(mi_heap_t* heap, mi_collect_t collect)
   // collect segment caches
   if (collect >= MI_FORCE) {
     _mi_segment_thread_collect(&heap->tld->segments);
+#if KONAN_MI_MALLOC
+    // and reset the freed segments right away, also on threads other than the main one
+    _mi_mem_reset_free(&heap->tld->os);
+#endif // KONAN_MI_MALLOC
   }
 
   // collect regions on program-exit (or shared library unload)
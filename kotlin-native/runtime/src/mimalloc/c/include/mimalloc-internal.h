@@ -76,6 +76,9 @@ bool       _mi_mem_protect(void* addr, size_t size);
 bool       _mi_mem_unprotect(void* addr, size_t size);
 
 void        _mi_mem_collect(mi_os_tld_t* tld);
+#if KONAN_MI_MALLOC
+void        _mi_mem_reset_free(mi_os_tld_t* tld);
+#endif // KONAN_MI_MALLOC
 
 // "segment.c"
 mi_page_t* _mi_segment_page_alloc(mi_heap_t* heap, size_t block_wsize, mi_segments_tld_t* tld, mi_os_tld_t* os_tld);
@@ -444,6 +444,35 @@ void _mi_mem_free(void* p, size_t size, size_t id, bool full_commit, bool any_re
 /* ----------------------------------------------------------------------------
   collection
 -----------------------------------------------------------------------------*/
+
+#if KONAN_MI_MALLOC
+// Reset every free block in the regions that has not been reset yet. Unlike `_mi_mem_collect`
+// this can be called from any thread at any time: blocks are claimed while they are reset.
+void _mi_mem_reset_free(mi_os_tld_t* tld) {
+  if (!mi_option_is_enabled(mi_option_eager_commit) && !mi_option_is_enabled(mi_option_reset_decommits)) return; // cannot reset halfway committed segments
+  uintptr_t rcount = mi_atomic_load_relaxed(&regions_count);
+  for (size_t i = 0; i < rcount; i++) {
+    mem_region_t* region = &regions[i];
+    mi_region_info_t info;
+    info.value = mi_atomic_load_acquire(&region->info);
+    if (info.value == 0 || info.x.is_large) continue;
+    void* start = mi_atomic_load_ptr_acquire(void, &region->start);
+    if (start == NULL) continue;
+    for (size_t bit_idx = 0; bit_idx < MI_BITMAP_FIELD_BITS; bit_idx++) {
+      if (mi_bitmap_is_claimed(&region->reset, 1, 1, bit_idx) || !mi_bitmap_is_claimed(&region->commit, 1, 1, bit_idx)) continue;
+      if (!mi_bitmap_try_claim_field(&region->in_use, 1, 1, bit_idx)) continue;
+      bool any_unreset;
+      mi_bitmap_claim(&region->reset, 1, 1, bit_idx, &any_unreset);
+      if (any_unreset) {
+        _mi_abandoned_await_readers(); // ensure no more pending write (in case reset = decommit)
+        _mi_mem_reset((uint8_t*)start + bit_idx * MI_SEGMENT_SIZE, MI_SEGMENT_SIZE, tld);
+      }
+      mi_bitmap_unclaim(&region->in_use, 1, 1, bit_idx);
+    }
+  }
+}
+#endif // KONAN_MI_MALLOC
+
 void _mi_mem_collect(mi_os_tld_t* tld) {
   // free every region that has no segments in use.
   uintptr_t rcount = mi_atomic_load_relaxed(&regions_count);
@@ -345,13 +345,21 @@ static void mi_pages_reset_remove_all_in_segment(mi_segment_t* segment, bool for
   }
 }
 
+#if KONAN_MI_MALLOC
+static void mi_reset_delayed_ex(mi_segments_tld_t* tld, bool force) {
+#else // KONAN_MI_MALLOC
 static void mi_reset_delayed(mi_segments_tld_t* tld) {
+#endif // KONAN_MI_MALLOC
   if (!mi_option_is_enabled(mi_option_page_reset)) return;
   mi_msecs_t now = _mi_clock_now();
   mi_page_queue_t* pq = &tld->pages_reset;
   // from oldest up to the first that has not expired yet
   mi_page_t* page = pq->last;
+#if KONAN_MI_MALLOC
+  while (page != NULL && (force || mi_page_reset_is_expired(page,now))) {
+#else // KONAN_MI_MALLOC
   while (page != NULL && mi_page_reset_is_expired(page,now)) {
+#endif // KONAN_MI_MALLOC
     mi_page_t* const prev = page->prev; // save previous field
     mi_page_reset(_mi_page_segment(page), page, 0, tld);
     page->used = 0;
@@ -368,6 +376,12 @@ static void mi_reset_delayed(mi_segments_tld_t* tld) {
   }
 }
 
+#if KONAN_MI_MALLOC
+static void mi_reset_delayed(mi_segments_tld_t* tld) {
+  mi_reset_delayed_ex(tld, false);
+}
+#endif // KONAN_MI_MALLOC
+
 
 /* -----------------------------------------------------------
  Segment size calculations
@@ -533,6 +547,10 @@ static bool mi_segment_cache_push(mi_segment_t* segment, mi_segments_tld_t* tld)
 
 // called by threads that are terminating to free cached segments
 void _mi_segment_thread_collect(mi_segments_tld_t* tld) {
+#if KONAN_MI_MALLOC
+  // also called on a forced collection: do not wait for the reset delay of the free pages.
+  mi_reset_delayed_ex(tld, true);
+#endif // KONAN_MI_MALLOC
   mi_segment_t* segment;
   while ((segment = mi_segment_cache_pop(0,tld)) != NULL) {
     mi_segment_os_free(segment, segment->segment_size, tld);
@@ -547,6 +547,15 @@ static void mi_stat_process_info(mi_msecs_t* elapsed, mi_msecs_t* utime, mi_msec
 #endif
 
 
+#if KONAN_MI_MALLOC
+// Committed memory that has not been reset: reset pages stay committed but the OS can take them back.
+size_t mi_committed_unreset(void) mi_attr_noexcept {
+  int64_t committed = mi_atomic_loadi64_relaxed((_Atomic(int64_t)*)&_mi_stats_main.committed.current);
+  int64_t reset = mi_atomic_loadi64_relaxed((_Atomic(int64_t)*)&_mi_stats_main.reset.current);
+  return (committed > reset ? (size_t)(committed - reset) : 0);
+}
+#endif // KONAN_MI_MALLOC
+
 mi_decl_export void mi_process_info(size_t* elapsed_msecs, size_t* user_msecs, size_t* system_msecs, size_t* current_rss, size_t* peak_rss, size_t* current_commit, size_t* peak_commit, size_t* page_faults) mi_attr_noexcept
 {
   mi_msecs_t elapsed = 0;
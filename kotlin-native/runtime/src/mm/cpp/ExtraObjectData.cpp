@@ -7,6 +7,7 @@
 
 #include "ObjectOps.hpp"
 #include "PointerBits.h"
+#include "SoftReferenceRegistry.hpp"
 #include "Weak.h"
 
 #ifdef KONAN_OBJC_INTEROP
@@ -76,8 +77,20 @@ void mm::ExtraObjectData::ClearWeakReferenceCounter() noexcept {
     mm::SetHeapRef(&weakReferenceCounter_, nullptr);
 }
 
+bool mm::ExtraObjectData::HasSoftReferenceCounter() noexcept {
+    return softReferenceCounter_ != nullptr;
+}
+
+void mm::ExtraObjectData::ClearSoftReferenceCounter() noexcept {
+    if (!HasSoftReferenceCounter()) return;
+
+    SoftReferenceCounterClear(softReferenceCounter_);
+    mm::SetHeapRef(&softReferenceCounter_, nullptr);
+}
+
 mm::ExtraObjectData::~ExtraObjectData() {
     RuntimeAssert(!HasWeakReferenceCounter(), "Object must have cleared weak references");
+    RuntimeAssert(!HasSoftReferenceCounter(), "Object must have cleared soft references");
 
 #ifdef KONAN_OBJC_INTEROP
     Kotlin_ObjCExport_releaseAssociatedObject(associatedObject_);
@@ -44,12 +44,16 @@ public:
 #endif
 
     ObjHeader** GetWeakCounterLocation() noexcept { return &weakReferenceCounter_; }
+    ObjHeader** GetSoftCounterLocation() noexcept { return &softReferenceCounter_; }
 
     std::atomic<Flags>& flags() noexcept { return flags_; }
 
     bool HasWeakReferenceCounter() noexcept;
     void ClearWeakReferenceCounter() noexcept;
 
+    bool HasSoftReferenceCounter() noexcept;
+    void ClearSoftReferenceCounter() noexcept;
+
 private:
     explicit ExtraObjectData(const TypeInfo* typeInfo) noexcept : typeInfo_(typeInfo) {}
     ~ExtraObjectData();
@@ -64,6 +68,7 @@ private:
 #endif
 
     ObjHeader* weakReferenceCounter_ = nullptr;
+    ObjHeader* softReferenceCounter_ = nullptr;
 };
 
 } // namespace mm
@@ -9,6 +9,7 @@
 #include "ObjectFactory.hpp"
 #include "GlobalsRegistry.hpp"
 #include "GC.hpp"
+#include "SoftReferenceRegistry.hpp"
 #include "StableRefRegistry.hpp"
 #include "ThreadRegistry.hpp"
 #include "Utils.hpp"
@@ -24,6 +25,7 @@ public:
     ThreadRegistry& threadRegistry() noexcept { return threadRegistry_; }
     GlobalsRegistry& globalsRegistry() noexcept { return globalsRegistry_; }
     StableRefRegistry& stableRefRegistry() noexcept { return stableRefRegistry_; }
+    SoftReferenceRegistry& softReferenceRegistry() noexcept { return softReferenceRegistry_; }
     ObjectFactory<gc::GC>& objectFactory() noexcept { return objectFactory_; }
     gc::GC& gc() noexcept { return gc_; }
 
@@ -37,6 +39,7 @@ private:
     ThreadRegistry threadRegistry_;
     GlobalsRegistry globalsRegistry_;
     StableRefRegistry stableRefRegistry_;
+    SoftReferenceRegistry softReferenceRegistry_;
     ObjectFactory<gc::GC> objectFactory_;
     gc::GC gc_;
 };
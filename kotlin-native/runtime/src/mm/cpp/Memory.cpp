@@ -17,6 +17,8 @@
 #include "ObjectOps.hpp"
 #include "Porting.h"
 #include "Runtime.h"
+#include "Scavenger.hpp"
+#include "SoftReferenceRegistry.hpp"
 #include "StableRefRegistry.hpp"
 #include "ThreadData.hpp"
 #include "ThreadRegistry.hpp"
@@ -46,6 +48,26 @@ ALWAYS_INLINE mm::StableRefRegistry::Node* FromForeignRefManager(ForeignRefManag
     return reinterpret_cast<mm::StableRefRegistry::Node*>(manager);
 }
 
+// Objects that need extra data (finalizers, Obj-C associated objects) must live in the heap.
+ALWAYS_INLINE bool CanPlaceIntoArena(const TypeInfo* typeInfo) {
+    return (typeInfo->flags_ & (TF_HAS_FINALIZER | TF_OBJC_DYNAMIC)) == 0;
+}
+
+// The allocation buffer is suspended while there is an arena, so arena objects always come here.
+NO_INLINE OBJ_GETTER(AllocInstanceSlowPath, mm::ThreadData* threadData, const TypeInfo* typeInfo) {
+    if (auto* arena = threadData->arena(); arena != nullptr && CanPlaceIntoArena(typeInfo)) {
+        RETURN_OBJ(arena->PlaceObject(typeInfo));
+    }
+    RETURN_RESULT_OF(mm::AllocateObject, threadData, typeInfo);
+}
+
+NO_INLINE OBJ_GETTER(AllocArrayInstanceSlowPath, mm::ThreadData* threadData, const TypeInfo* typeInfo, uint32_t elements) {
+    if (auto* arena = threadData->arena(); arena != nullptr) {
+        RETURN_OBJ(arena->PlaceArray(typeInfo, elements)->obj());
+    }
+    RETURN_RESULT_OF(mm::AllocateArray, threadData, typeInfo, elements);
+}
+
 } // namespace
 
 ObjHeader** ObjHeader::GetWeakCounterLocation() {
@@ -91,6 +113,11 @@ ALWAYS_INLINE bool isShareable(const ObjHeader* obj) {
 }
 
 extern "C" MemoryState* InitMemory(bool firstRuntime) {
+    if (firstRuntime) {
+        // Leave a quarter of the container memory to native allocations, thread stacks and the runtime itself.
+        size_t memoryLimit = konan::getMemoryLimitBytes();
+        mm::GlobalData::Instance().gc().SetHeapLimitBytes(memoryLimit / 4 * 3);
+    }
     return mm::ToMemoryState(mm::ThreadRegistry::Instance().RegisterCurrentThread());
 }
 
@@ -111,17 +138,39 @@ extern "C" void ClearMemoryForTests(MemoryState* state) {
     state->GetThreadData()->ClearForTests();
 }
 
-extern "C" RUNTIME_NOTHROW OBJ_GETTER(AllocInstance, const TypeInfo* typeInfo) {
+// `AllocInstance` and `AllocArrayInstance` are inlined into the compiled code. Their fast path only bumps the pointer of
+// the thread's allocation buffer (see `mm::internal::BufferedAllocator`). Refilling the buffer, the GC check, arenas and
+// big objects are left to the out-of-line slow paths.
+extern "C" ALWAYS_INLINE RUNTIME_NOTHROW OBJ_GETTER(AllocInstance, const TypeInfo* typeInfo) {
     auto* threadData = mm::ThreadRegistry::Instance().CurrentThreadData();
-    RETURN_RESULT_OF(mm::AllocateObject, threadData, typeInfo);
+    AssertThreadState(threadData, ThreadState::kRunnable);
+    if (auto* object = threadData->objectFactoryThreadQueue().TryCreateObject(typeInfo)) {
+        RETURN_OBJ(object);
+    }
+    RETURN_RESULT_OF(AllocInstanceSlowPath, threadData, typeInfo);
+}
+
+extern "C" ALWAYS_INLINE OBJ_GETTER(AllocArrayInstance, const TypeInfo* typeInfo, int32_t elements) {
+    if (elements < 0) {
+        ThrowIllegalArgumentException();
+    }
+    auto* threadData = mm::ThreadRegistry::Instance().CurrentThreadData();
+    AssertThreadState(threadData, ThreadState::kRunnable);
+    if (auto* array = threadData->objectFactoryThreadQueue().TryCreateArray(typeInfo, static_cast<uint32_t>(elements))) {
+        RETURN_OBJ(array->obj());
+    }
+    RETURN_RESULT_OF(AllocArrayInstanceSlowPath, threadData, typeInfo, static_cast<uint32_t>(elements));
 }
 
-extern "C" OBJ_GETTER(AllocArrayInstance, const TypeInfo* typeInfo, int32_t elements) {
+extern "C" OBJ_GETTER(AllocArrayInstanceUninitialized, const TypeInfo* typeInfo, int32_t elements) {
     if (elements < 0) {
         ThrowIllegalArgumentException();
     }
     auto* threadData = mm::ThreadRegistry::Instance().CurrentThreadData();
-    RETURN_RESULT_OF(mm::AllocateArray, threadData, typeInfo, static_cast<uint32_t>(elements));
+    if (auto* arena = threadData->arena(); arena != nullptr) {
+        RETURN_OBJ(arena->PlaceArray(typeInfo, static_cast<uint32_t>(elements))->obj());
+    }
+    RETURN_RESULT_OF(mm::AllocateArrayUninitialized, threadData, typeInfo, static_cast<uint32_t>(elements));
 }
 
 extern "C" ALWAYS_INLINE OBJ_GETTER(InitThreadLocalSingleton, ObjHeader** location, const TypeInfo* typeInfo, void (*ctor)(ObjHeader*)) {
@@ -213,16 +262,17 @@ extern "C" OBJ_GETTER(ReadHeapRefNoLock, ObjHeader* object, int32_t index) {
     ThrowNotImplementedError();
 }
 
-extern "C" RUNTIME_NOTHROW void EnterFrame(ObjHeader** start, int parameters, int count) {
+// `EnterFrame` and `LeaveFrame` wrap every Kotlin function with references on the stack. Like the allocation entry
+// points, they are inlined into the compiled code.
+extern "C" ALWAYS_INLINE RUNTIME_NOTHROW void EnterFrame(ObjHeader** start, int parameters, int count) {
     auto* threadData = mm::ThreadRegistry::Instance().CurrentThreadData();
     AssertThreadState(threadData, ThreadState::kRunnable);
     threadData->shadowStack().EnterFrame(start, parameters, count);
 }
 
-extern "C" RUNTIME_NOTHROW void LeaveFrame(ObjHeader** start, int parameters, int count) {
-    auto* threadData = mm::ThreadRegistry::Instance().CurrentThreadData();
-    AssertThreadState(threadData, ThreadState::kRunnable);
-    threadData->shadowStack().LeaveFrame(start, parameters, count);
+extern "C" ALWAYS_INLINE RUNTIME_NOTHROW void LeaveFrame(ObjHeader** start, int parameters, int count) {
+    // The frame knows its stack, so there's no thread lookup. The thread state was checked by `EnterFrame`.
+    mm::ShadowStack::LeaveFrame(start, parameters, count);
 }
 
 extern "C" RUNTIME_NOTHROW void AddTLSRecord(MemoryState* memory, void** key, int size) {
@@ -335,6 +385,100 @@ extern "C" KBoolean Kotlin_native_internal_GC_getTuneThreshold(ObjHeader*) {
     return mm::GlobalData::Instance().gc().GetAutoTune();
 }
 
+namespace {
+
+int64_t ClampToKLong(uint64_t value) noexcept {
+    auto maxValue = std::numeric_limits<int64_t>::max();
+    if (value > static_cast<uint64_t>(maxValue)) {
+        return maxValue;
+    }
+    return static_cast<int64_t>(value);
+}
+
+} // namespace
+
+extern "C" void Kotlin_native_internal_GC_setSoftReferencesThreshold(ObjHeader*, int64_t value) {
+    if (value < 0) {
+        ThrowIllegalArgumentException();
+    }
+    mm::GlobalData::Instance().gc().SetSoftReferencesThresholdBytes(static_cast<size_t>(value));
+}
+
+extern "C" int64_t Kotlin_native_internal_GC_getSoftReferencesThreshold(ObjHeader*) {
+    return ClampToKLong(mm::GlobalData::Instance().gc().GetSoftReferencesThresholdBytes());
+}
+
+extern "C" void Kotlin_native_internal_GC_setSoftReferencesMaxIdleMillis(ObjHeader*, int64_t value) {
+    if (value < 0) {
+        ThrowIllegalArgumentException();
+    }
+    mm::GlobalData::Instance().gc().SetSoftReferencesMaxIdleMillis(static_cast<uint64_t>(value));
+}
+
+extern "C" int64_t Kotlin_native_internal_GC_getSoftReferencesMaxIdleMillis(ObjHeader*) {
+    return ClampToKLong(mm::GlobalData::Instance().gc().GetSoftReferencesMaxIdleMillis());
+}
+
+extern "C" void Kotlin_native_internal_GC_setHeapLimit(ObjHeader*, int64_t value) {
+    if (value < 0) {
+        ThrowIllegalArgumentException();
+    }
+    mm::GlobalData::Instance().gc().SetHeapLimitBytes(static_cast<size_t>(value));
+}
+
+extern "C" int64_t Kotlin_native_internal_GC_getHeapLimit(ObjHeader*) {
+    return ClampToKLong(mm::GlobalData::Instance().gc().GetHeapLimitBytes());
+}
+
+extern "C" void Kotlin_native_internal_GC_setScavengingIntervalMillis(ObjHeader*, int64_t value) {
+    if (value < 0) {
+        ThrowIllegalArgumentException();
+    }
+    SetScavengingIntervalMillis(static_cast<uint64_t>(value));
+}
+
+extern "C" int64_t Kotlin_native_internal_GC_getScavengingIntervalMillis(ObjHeader*) {
+    return ClampToKLong(GetScavengingIntervalMillis());
+}
+
+extern "C" int64_t Kotlin_native_internal_GC_getCommittedBytes(ObjHeader*) {
+    return ClampToKLong(GetCommittedBytes());
+}
+
+extern "C" int64_t Kotlin_native_internal_GC_getUsedBytes(ObjHeader*) {
+    return ClampToKLong(mm::GlobalData::Instance().gc().GetHeapBytesEstimate());
+}
+
+extern "C" void Kotlin_native_internal_GC_reportExternalAllocation(ObjHeader*, int64_t bytes) {
+    if (bytes < 0) {
+        ThrowIllegalArgumentException();
+    }
+    ReportExternalAllocation(static_cast<size_t>(bytes));
+}
+
+extern "C" void Kotlin_native_internal_GC_reportExternalFree(ObjHeader*, int64_t bytes) {
+    if (bytes < 0) {
+        ThrowIllegalArgumentException();
+    }
+    ReportExternalFree(static_cast<size_t>(bytes));
+}
+
+extern "C" int64_t Kotlin_native_internal_GC_getExternalBytes(ObjHeader*) {
+    // At least the reports of the current thread must be visible.
+    mm::ThreadRegistry::Instance().CurrentThreadData()->gc().FlushExternalBytes();
+    return ClampToKLong(mm::GlobalData::Instance().gc().GetExternalBytes());
+}
+
+extern "C" int64_t Kotlin_native_internal_GC_getCurrentThreadExternalAllocatedBytes(ObjHeader*) {
+    auto* threadData = mm::ThreadRegistry::Instance().CurrentThreadData();
+    return ClampToKLong(threadData->gc().externalAllocatedBytes());
+}
+
+extern "C" int64_t Kotlin_native_internal_GC_getCurrentThreadExternalFreedBytes(ObjHeader*) {
+    auto* threadData = mm::ThreadRegistry::Instance().CurrentThreadData();
+    return ClampToKLong(threadData->gc().externalFreedBytes());
+}
+
 extern "C" OBJ_GETTER(Kotlin_native_internal_GC_detectCycles, ObjHeader*) {
     // TODO: Remove when legacy MM is gone.
     RETURN_OBJ(nullptr);
@@ -356,6 +500,19 @@ extern "C" void Kotlin_native_internal_GC_setCyclicCollector(ObjHeader* gc, bool
         ThrowIllegalArgumentException();
 }
 
+extern "C" void Kotlin_native_internal_Arena_enter() {
+    mm::ThreadRegistry::Instance().CurrentThreadData()->EnterArena();
+}
+
+extern "C" void Kotlin_native_internal_Arena_leave() {
+    mm::ThreadRegistry::Instance().CurrentThreadData()->LeaveArena();
+}
+
+extern "C" OBJ_GETTER(Kotlin_native_internal_Arena_promote, ObjHeader* object) {
+    auto* threadData = mm::ThreadRegistry::Instance().CurrentThreadData();
+    RETURN_RESULT_OF(mm::PromoteFromArena, threadData, object);
+}
+
 extern "C" bool Kotlin_Any_isShareable(ObjHeader* thiz) {
     // TODO: Remove when legacy MM is gone.
     return true;
@@ -370,6 +527,18 @@ extern "C" RUNTIME_NOTHROW void PerformFullGC(MemoryState* memory) {
     memory->GetThreadData()->gc().PerformFullGC();
 }
 
+extern "C" RUNTIME_NOTHROW void ReportExternalAllocation(size_t size) {
+    auto* threadData = mm::ThreadRegistry::Instance().CurrentThreadData();
+    // May trigger a collection.
+    AssertThreadState(threadData, ThreadState::kRunnable);
+    threadData->gc().SafePointExternalAllocation(size);
+}
+
+extern "C" RUNTIME_NOTHROW void ReportExternalFree(size_t size) {
+    auto* threadData = mm::ThreadRegistry::Instance().CurrentThreadData();
+    threadData->gc().OnExternalFree(size);
+}
+
 extern "C" RUNTIME_NOTHROW bool ClearSubgraphReferences(ObjHeader* root, bool checked) {
     // TODO: Remove when legacy MM is gone.
     return true;
@@ -379,6 +548,7 @@ extern "C" RUNTIME_NOTHROW void* CreateStablePointer(ObjHeader* object) {
     if (!object)
         return nullptr;
 
+    mm::CheckArenaStore(nullptr, object);
     auto* threadData = mm::ThreadRegistry::Instance().CurrentThreadData();
     return mm::StableRefRegistry::Instance().RegisterStableRef(threadData, object);
 }
@@ -417,6 +587,36 @@ extern "C" RUNTIME_NOTHROW OBJ_GETTER(AdoptStablePointer, void* pointer) {
     return object;
 }
 
+extern "C" OBJ_GETTER(makeSoftReferenceCounter, void*);
+extern "C" OBJ_GETTER(makeStrongSoftReferenceImpl, ObjHeader*);
+
+// See SoftPrivate.kt for implementation details.
+extern "C" OBJ_GETTER(Konan_getSoftReferenceImpl, ObjHeader* referred) {
+    if (referred->permanent()) {
+        RETURN_RESULT_OF(makeStrongSoftReferenceImpl, referred);
+    }
+
+    ObjHeader** softCounterLocation = mm::ExtraObjectData::GetOrInstall(referred).GetSoftCounterLocation();
+    if (*softCounterLocation == nullptr) {
+        ObjHolder counterHolder;
+        // Cast unneeded, just to emphasize we store an object reference as void*.
+        ObjHeader* counter = makeSoftReferenceCounter(reinterpret_cast<void*>(referred), counterHolder.slot());
+        ObjHolder oldHolder;
+        if (mm::CompareAndSwapHeapRef(softCounterLocation, nullptr, counter, oldHolder.slot()) == nullptr) {
+            mm::SoftReferenceRegistry::Instance().RegisterSoftReferenceCounter(counter);
+        }
+    }
+    ObjHeader* counter = *softCounterLocation;
+    // Creating a soft reference counts as an access.
+    mm::SoftReferenceCounterDereference(counter);
+    RETURN_OBJ(counter);
+}
+
+// Materialize a soft reference to either null or the real reference.
+extern "C" OBJ_GETTER(Konan_SoftReferenceCounter_get, ObjHeader* counter) {
+    RETURN_OBJ(mm::SoftReferenceCounterDereference(counter));
+}
+
 extern "C" void MutationCheck(ObjHeader* obj) {
     if (obj->local()) return;
     if (!isPermanentOrFrozen(obj)) return;
@@ -453,6 +653,7 @@ extern "C" ForeignRefContext InitLocalForeignRef(ObjHeader* object) {
 }
 
 extern "C" ForeignRefContext InitForeignRef(ObjHeader* object) {
+    mm::CheckArenaStore(nullptr, object);
     auto* threadData = mm::ThreadRegistry::Instance().CurrentThreadData();
     auto* node = mm::StableRefRegistry::Instance().RegisterStableRef(threadData, object);
     return ToForeignRefManager(node);
@@ -485,18 +686,21 @@ extern "C" RUNTIME_NOTHROW void Kotlin_mm_safePointFunctionEpilogue() {
     auto* threadData = mm::ThreadRegistry::Instance().CurrentThreadData();
     AssertThreadState(threadData, ThreadState::kRunnable);
     threadData->gc().SafePointFunctionEpilogue();
+    threadData->SafePointScavenge();
 }
 
 extern "C" RUNTIME_NOTHROW void Kotlin_mm_safePointWhileLoopBody() {
     auto* threadData = mm::ThreadRegistry::Instance().CurrentThreadData();
     AssertThreadState(threadData, ThreadState::kRunnable);
     threadData->gc().SafePointLoopBody();
+    threadData->SafePointScavenge();
 }
 
 extern "C" RUNTIME_NOTHROW void Kotlin_mm_safePointExceptionUnwind() {
     auto* threadData = mm::ThreadRegistry::Instance().CurrentThreadData();
     AssertThreadState(threadData, ThreadState::kRunnable);
     threadData->gc().SafePointExceptionUnwind();
+    threadData->SafePointScavenge();
 }
 
 extern "C" ALWAYS_INLINE RUNTIME_NOTHROW void Kotlin_mm_switchThreadStateNative() {
@@ -507,6 +711,22 @@ extern "C" ALWAYS_INLINE RUNTIME_NOTHROW void Kotlin_mm_switchThreadStateRunnabl
     SwitchThreadState(mm::ThreadRegistry::Instance().CurrentThreadData(), ThreadState::kRunnable);
 }
 
+extern "C" KLong Kotlin_Debugging_getExclusiveLeafTransfers() {
+    // Transferring object subgraphs between threads is specific to the legacy MM.
+    return 0;
+}
+
+extern "C" RUNTIME_NOTHROW KBoolean Kotlin_Debugging_isReferencedByGlobalRoot(KRef obj) {
+    auto* threadData = mm::ThreadRegistry::Instance().CurrentThreadData();
+    AssertThreadState(threadData, ThreadState::kRunnable);
+    // Globals registered by this thread are not in the registry until its queue is published.
+    mm::GlobalsRegistry::Instance().ProcessThread(threadData);
+    for (auto* location : mm::GlobalsRegistry::Instance().Iter()) {
+        if (*location == obj) return true;
+    }
+    return false;
+}
+
 MemoryState* kotlin::mm::GetMemoryState() {
     return ToMemoryState(ThreadRegistry::Instance().CurrentThreadDataNode());
 }
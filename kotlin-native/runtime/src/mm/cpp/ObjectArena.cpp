@@ -0,0 +1,196 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "ObjectArena.hpp"
+
+#include <cstring>
+
+#include "Alignment.hpp"
+#include "KAssert.h"
+#include "Natives.h"
+#include "ObjectOps.hpp"
+#include "ObjectTraversal.hpp"
+#include "PointerBits.h"
+#include "ThreadData.hpp"
+#include "ThreadRegistry.hpp"
+
+using namespace kotlin;
+
+namespace {
+
+constexpr size_t kChunkSize = 64 * 1024;
+
+size_t ObjectSize(const TypeInfo* typeInfo) noexcept {
+    RuntimeAssert(!typeInfo->IsArray(), "Must not be an array");
+    return AlignUp(static_cast<size_t>(typeInfo->instanceSize_), kObjectAlignment);
+}
+
+size_t ArraySize(const TypeInfo* typeInfo, uint32_t count) noexcept {
+    RuntimeAssert(typeInfo->IsArray(), "Must be an array");
+    return AlignUp(sizeof(ArrayHeader) + static_cast<size_t>(-typeInfo->instanceSize_) * count, kObjectAlignment);
+}
+
+size_t PlacedSize(ObjHeader* object) noexcept {
+    const TypeInfo* typeInfo = object->type_info();
+    return typeInfo->IsArray() ? ArraySize(typeInfo, object->array()->count_) : ObjectSize(typeInfo);
+}
+
+void SetLocalHeader(ObjHeader* object, const TypeInfo* typeInfo) noexcept {
+    object->typeInfoOrMeta_ = setPointerBits(const_cast<TypeInfo*>(typeInfo), OBJECT_TAG_PERMANENT_CONTAINER | OBJECT_TAG_NONTRIVIAL_CONTAINER);
+    RuntimeAssert(object->local(), "Must be local");
+}
+
+} // namespace
+
+uint8_t* mm::ObjectArena::Chunk::begin() noexcept {
+    return reinterpret_cast<uint8_t*>(this) + AlignUp(sizeof(Chunk), kObjectAlignment);
+}
+
+mm::ObjectArena::Iterator::Iterator(ObjectArena* arena) noexcept :
+    arena_(arena), chunk_(arena ? arena->chunks_ : nullptr), object_(chunk_ ? reinterpret_cast<ObjHeader*>(chunk_->begin()) : nullptr) {
+    Init();
+}
+
+mm::ObjectArena::Iterator& mm::ObjectArena::Iterator::operator++() noexcept {
+    object_ = reinterpret_cast<ObjHeader*>(reinterpret_cast<uint8_t*>(object_) + PlacedSize(object_));
+    Init();
+    return *this;
+}
+
+void mm::ObjectArena::Iterator::Init() noexcept {
+    while (arena_ != nullptr) {
+        if (chunk_ != nullptr && reinterpret_cast<uint8_t*>(object_) < chunk_->top) return;
+        if (chunk_ != nullptr && chunk_->next != nullptr) {
+            chunk_ = chunk_->next;
+        } else {
+            arena_ = arena_->parent_;
+            chunk_ = arena_ ? arena_->chunks_ : nullptr;
+        }
+        object_ = chunk_ ? reinterpret_cast<ObjHeader*>(chunk_->begin()) : nullptr;
+    }
+    object_ = nullptr;
+}
+
+std::atomic<size_t> mm::ObjectArena::aliveCount_ = 0;
+
+mm::ObjectArena::ObjectArena(gc::GC::ThreadData& gc, ObjectArena* parent) noexcept : gc_(gc), parent_(parent) {
+    aliveCount_.fetch_add(1, std::memory_order_relaxed);
+}
+
+mm::ObjectArena::~ObjectArena() {
+    // Arena objects cannot have `ExtraObjectData` (it's not installed for tagged objects),
+    // so there is nothing to clean up for them.
+    Chunk* chunk = chunks_;
+    while (chunk != nullptr) {
+        Chunk* next = chunk->next;
+        konanFreeMemory(chunk);
+        chunk = next;
+    }
+    aliveCount_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool mm::ObjectArena::Contains(const void* address) const noexcept {
+    auto* bytes = static_cast<const uint8_t*>(address);
+    // The newest chunk goes first, and most stores are into recently placed objects.
+    for (Chunk* chunk = chunks_; chunk != nullptr; chunk = chunk->next) {
+        if (bytes >= chunk->begin() && bytes < chunk->top) return true;
+    }
+    return false;
+}
+
+ObjHeader* mm::ObjectArena::PlaceObject(const TypeInfo* typeInfo) noexcept {
+    auto* object = static_cast<ObjHeader*>(Place(ObjectSize(typeInfo)));
+    SetLocalHeader(object, typeInfo);
+    return object;
+}
+
+ArrayHeader* mm::ObjectArena::PlaceArray(const TypeInfo* typeInfo, uint32_t count) noexcept {
+    auto* array = static_cast<ArrayHeader*>(Place(ArraySize(typeInfo, count)));
+    array->count_ = count;
+    SetLocalHeader(array->obj(), typeInfo);
+    return array;
+}
+
+void* mm::ObjectArena::Place(size_t size) noexcept {
+    // May trigger a collection, so it goes before the object is placed: the GC iterates arena objects.
+    gc_.SafePointAllocation(size);
+    if (chunks_ == nullptr || static_cast<size_t>(chunks_->end - chunks_->top) < size) {
+        // Objects that do not fit into a regular chunk get a chunk of their own.
+        size_t dataOffset = AlignUp(sizeof(Chunk), kObjectAlignment);
+        size_t chunkSize = std::max(kChunkSize, dataOffset + size);
+        // The memory is zeroed, so objects come out with all fields set to null.
+        auto* chunk = static_cast<Chunk*>(konanAllocMemory(chunkSize));
+        if (chunk == nullptr) {
+            konan::consoleErrorf("Out of memory trying to allocate %zu bytes for an arena. Aborting.\n", chunkSize);
+            konan::abort();
+        }
+        chunk->next = chunks_;
+        chunk->top = chunk->begin();
+        chunk->end = reinterpret_cast<uint8_t*>(chunk) + chunkSize;
+        chunks_ = chunk;
+    }
+    void* result = chunks_->top;
+    chunks_->top += size;
+    return result;
+}
+
+OBJ_GETTER(mm::PromoteFromArena, ThreadData* threadData, ObjHeader* object) noexcept {
+    if (object == nullptr || !object->local()) {
+        RETURN_OBJ(object);
+    }
+    auto* arena = threadData->arena();
+    RuntimeAssert(arena != nullptr, "Local object %p outside of an arena", object);
+
+    // Find everything that has to be copied first: copies are allocated in the heap and may trigger GC,
+    // so they have to be kept in an arena array until the fields are fixed.
+    KStdUnorderedMap<ObjHeader*, uint32_t> indices;
+    KStdVector<ObjHeader*> originals;
+    originals.push_back(object);
+    indices.emplace(object, 0);
+    for (size_t i = 0; i < originals.size(); ++i) {
+        traverseReferredObjects(originals[i], [&](ObjHeader* field) noexcept {
+            if (field->local() && indices.emplace(field, originals.size()).second) {
+                originals.push_back(field);
+            }
+        });
+    }
+
+    ArrayHeader* copies = arena->PlaceArray(theArrayTypeInfo, originals.size());
+    for (size_t i = 0; i < originals.size(); ++i) {
+        ObjHeader* original = originals[i];
+        ObjHeader** slot = ArrayAddressOfElementAt(copies, i);
+        const TypeInfo* typeInfo = original->type_info();
+        if (typeInfo->IsArray()) {
+            uint32_t count = original->array()->count_;
+            ArrayHeader* copy = AllocateArray(threadData, typeInfo, count, slot)->array();
+            std::memcpy(copy + 1, original->array() + 1, static_cast<size_t>(-typeInfo->instanceSize_) * count);
+        } else {
+            ObjHeader* copy = AllocateObject(threadData, typeInfo, slot);
+            std::memcpy(copy + 1, original + 1, typeInfo->instanceSize_ - sizeof(ObjHeader));
+        }
+    }
+
+    for (size_t i = 0; i < originals.size(); ++i) {
+        traverseObjectFields(*ArrayAddressOfElementAt(copies, i), [&](ObjHeader** location) noexcept {
+            ObjHeader* field = *location;
+            if (field != nullptr && field->local()) {
+                SetHeapRef(location, *ArrayAddressOfElementAt(copies, indices[field]));
+            }
+        });
+    }
+
+    RETURN_OBJ(*ArrayAddressOfElementAt(copies, 0));
+}
+
+void mm::CheckArenaStoreSlowPath(ObjHeader** location, ObjHeader* value) noexcept {
+    auto* threadData = ThreadRegistry::Instance().CurrentThreadData();
+    // Arenas are left innermost first, so `location` must be found no later than `value`.
+    for (auto* arena = threadData->arena(); arena != nullptr; arena = arena->parent()) {
+        if (location != nullptr && arena->Contains(location)) return;
+        if (arena->Contains(value)) break;
+    }
+    konan::consoleErrorf("Arena object %p is stored into %p, which outlives the arena. Aborting.\n", value, location);
+    konan::abort();
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#ifndef RUNTIME_MM_OBJECT_ARENA_H
+#define RUNTIME_MM_OBJECT_ARENA_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "Alloc.h"
+#include "GC.hpp"
+#include "Memory.h"
+#include "Types.h"
+#include "Utils.hpp"
+
+namespace kotlin {
+namespace mm {
+
+class ThreadData;
+
+// Bump-pointer region for objects that all die at the same time. Objects placed into the arena are tagged
+// as local (just like stack-allocated objects in the legacy MM): the GC never marks or sweeps them, but treats
+// all of them as roots while the arena is alive. The whole region is released when the arena is destroyed.
+//
+// Arenas of a thread are nested: `parent()` is the enclosing one. Placed objects count towards the GC trigger
+// of the owning thread, even though the GC does not reclaim them.
+class ObjectArena : private Pinned, public KonanAllocatorAware {
+    struct Chunk {
+        Chunk* next;
+        uint8_t* top;
+        uint8_t* end;
+        // Objects follow.
+
+        uint8_t* begin() noexcept;
+    };
+
+public:
+    // Iterates over objects of the arena and all of its parents.
+    class Iterator {
+    public:
+        explicit Iterator(ObjectArena* arena) noexcept;
+
+        // Arena objects are not stored anywhere, so the reference is to a copy, and writing to it does nothing.
+        ObjHeader*& operator*() noexcept { return object_; }
+
+        Iterator& operator++() noexcept;
+
+        bool operator==(const Iterator& rhs) const noexcept { return object_ == rhs.object_; }
+        bool operator!=(const Iterator& rhs) const noexcept { return !(*this == rhs); }
+
+    private:
+        void Init() noexcept;
+
+        ObjectArena* arena_;
+        Chunk* chunk_;
+        ObjHeader* object_;
+    };
+
+    ObjectArena(gc::GC::ThreadData& gc, ObjectArena* parent) noexcept;
+    ~ObjectArena();
+
+    // Whether any thread has an arena at all. Lets stores skip `CheckArenaStore` in the common case.
+    static ALWAYS_INLINE bool AnyAlive() noexcept { return aliveCount_.load(std::memory_order_relaxed) != 0; }
+
+    ObjHeader* PlaceObject(const TypeInfo* typeInfo) noexcept;
+    ArrayHeader* PlaceArray(const TypeInfo* typeInfo, uint32_t count) noexcept;
+
+    ObjectArena* parent() noexcept { return parent_; }
+
+    // Whether `address` is inside one of the chunks of this arena (parents are not checked).
+    bool Contains(const void* address) const noexcept;
+
+    Iterator begin() noexcept { return Iterator(this); }
+    Iterator end() noexcept { return Iterator(nullptr); }
+
+private:
+    void* Place(size_t size) noexcept;
+
+    static std::atomic<size_t> aliveCount_;
+
+    gc::GC::ThreadData& gc_;
+    ObjectArena* parent_;
+    // The newest chunk goes first, objects are placed into it.
+    Chunk* chunks_ = nullptr;
+};
+
+// Copies `object` and all arena objects reachable from it into the heap and returns the copy of `object`.
+// Objects that are not in an arena are returned as is. Must be called while the arenas are still alive.
+OBJ_GETTER(PromoteFromArena, ThreadData* threadData, ObjHeader* object) noexcept;
+
+// Aborts if storing `value` into `location` lets an arena object outlive its arena: `location` must be in the
+// same arena as `value` or in one nested into it. `nullptr` `location` stands for storages outside of the
+// Kotlin heap (e.g. stable pointers).
+void CheckArenaStoreSlowPath(ObjHeader** location, ObjHeader* value) noexcept;
+
+ALWAYS_INLINE inline void CheckArenaStore(ObjHeader** location, ObjHeader* value) noexcept {
+    if (ObjectArena::AnyAlive() && value != nullptr && value->local()) {
+        CheckArenaStoreSlowPath(location, value);
+    }
+}
+
+} // namespace mm
+} // namespace kotlin
+
+#endif // RUNTIME_MM_OBJECT_ARENA_H
@@ -0,0 +1,208 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "ObjectArena.hpp"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "Natives.h"
+#include "ObjectTestSupport.hpp"
+#include "TestSupport.hpp"
+#include "ThreadData.hpp"
+#include "Types.h"
+
+using namespace kotlin;
+
+namespace {
+
+struct Payload {
+    ObjHeader* field1;
+    ObjHeader* field2;
+    KLong value;
+
+    static constexpr std::array kFields{
+            &Payload::field1,
+            &Payload::field2,
+    };
+};
+
+test_support::TypeInfoHolder& payloadType() {
+    static test_support::TypeInfoHolder type{test_support::TypeInfoHolder::ObjectBuilder<Payload>()};
+    return type;
+}
+
+KStdVector<ObjHeader*> Collect(mm::ObjectArena& arena) {
+    KStdVector<ObjHeader*> result;
+    for (auto* object : arena) {
+        result.push_back(object);
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(ObjectArenaTest, Empty) {
+    RunInNewThread([](mm::ThreadData& threadData) {
+        mm::ObjectArena arena(threadData.gc(), nullptr);
+        EXPECT_THAT(Collect(arena), testing::IsEmpty());
+    });
+}
+
+TEST(ObjectArenaTest, PlaceObjectsAndArrays) {
+    RunInNewThread([](mm::ThreadData& threadData) {
+        mm::ObjectArena arena(threadData.gc(), nullptr);
+        auto* object = arena.PlaceObject(payloadType().typeInfo());
+        auto* array = arena.PlaceArray(theCharArrayTypeInfo, 3);
+        auto* objectArray = arena.PlaceArray(theArrayTypeInfo, 2);
+
+        EXPECT_TRUE(object->local());
+        EXPECT_THAT(object->type_info(), payloadType().typeInfo());
+        auto& payload = test_support::Object<Payload>::FromObjHeader(object);
+        EXPECT_THAT(payload->field1, nullptr);
+        EXPECT_THAT(payload->field2, nullptr);
+        EXPECT_THAT(payload->value, 0);
+
+        EXPECT_TRUE(array->obj()->local());
+        EXPECT_THAT(array->type_info(), theCharArrayTypeInfo);
+        EXPECT_THAT(array->count_, 3);
+        EXPECT_TRUE(objectArray->obj()->local());
+        EXPECT_THAT(*ArrayAddressOfElementAt(objectArray, 0), nullptr);
+        EXPECT_THAT(*ArrayAddressOfElementAt(objectArray, 1), nullptr);
+
+        EXPECT_THAT(Collect(arena), testing::ElementsAre(object, array->obj(), objectArray->obj()));
+    });
+}
+
+TEST(ObjectArenaTest, ManyChunks) {
+    RunInNewThread([](mm::ThreadData& threadData) {
+        mm::ObjectArena arena(threadData.gc(), nullptr);
+        KStdVector<ObjHeader*> expected;
+        // Several regular chunks and a few dedicated ones in between.
+        for (int i = 0; i < 10000; ++i) {
+            if (i % 1000 == 0) {
+                expected.push_back(arena.PlaceArray(theByteArrayTypeInfo, 100000)->obj());
+            } else {
+                expected.push_back(arena.PlaceObject(payloadType().typeInfo()));
+            }
+        }
+
+        auto actual = Collect(arena);
+        EXPECT_THAT(actual, testing::UnorderedElementsAreArray(expected));
+    });
+}
+
+TEST(ObjectArenaTest, Nested) {
+    RunInNewThread([](mm::ThreadData& threadData) {
+        mm::ObjectArena parent(threadData.gc(), nullptr);
+        auto* parentObject = parent.PlaceObject(payloadType().typeInfo());
+        mm::ObjectArena emptyChild(threadData.gc(), &parent);
+        mm::ObjectArena child(threadData.gc(), &emptyChild);
+        auto* childObject = child.PlaceObject(payloadType().typeInfo());
+
+        EXPECT_THAT(child.parent(), &emptyChild);
+        EXPECT_THAT(Collect(child), testing::ElementsAre(childObject, parentObject));
+        EXPECT_THAT(Collect(emptyChild), testing::ElementsAre(parentObject));
+        EXPECT_THAT(Collect(parent), testing::ElementsAre(parentObject));
+    });
+}
+
+TEST(ObjectArenaTest, PromoteNonLocal) {
+    RunInNewThread([](mm::ThreadData& threadData) {
+        test_support::Object<Payload> heapObject(payloadType().typeInfo());
+        ObjHeader* result = nullptr;
+        EXPECT_THAT(mm::PromoteFromArena(&threadData, heapObject.header(), &result), heapObject.header());
+        EXPECT_THAT(mm::PromoteFromArena(&threadData, nullptr, &result), nullptr);
+    });
+}
+
+TEST(ObjectArenaTest, Promote) {
+    RunInNewThread([](mm::ThreadData& threadData) {
+        test_support::Object<Payload> heapObject(payloadType().typeInfo());
+
+        threadData.EnterArena();
+        auto* arena = threadData.arena();
+        auto& root = test_support::Object<Payload>::FromObjHeader(arena->PlaceObject(payloadType().typeInfo()));
+        auto& child = test_support::Object<Payload>::FromObjHeader(arena->PlaceObject(payloadType().typeInfo()));
+        auto* array = arena->PlaceArray(theArrayTypeInfo, 2);
+        root->field1 = child.header();
+        root->field2 = heapObject.header();
+        root->value = 42;
+        child->field1 = root.header();
+        child->field2 = array->obj();
+        *ArrayAddressOfElementAt(array, 0) = child.header();
+
+        ObjHeader* result = nullptr;
+        auto* promoted = mm::PromoteFromArena(&threadData, root.header(), &result);
+        EXPECT_THAT(result, promoted);
+        threadData.LeaveArena();
+
+        ASSERT_TRUE(promoted->heap());
+        auto& promotedRoot = test_support::Object<Payload>::FromObjHeader(promoted);
+        EXPECT_THAT(promotedRoot->value, 42);
+        EXPECT_THAT(promotedRoot->field2, heapObject.header());
+        ASSERT_TRUE(promotedRoot->field1->heap());
+        auto& promotedChild = test_support::Object<Payload>::FromObjHeader(promotedRoot->field1);
+        EXPECT_THAT(promotedChild->field1, promoted);
+        ASSERT_TRUE(promotedChild->field2->heap());
+        auto* promotedArray = promotedChild->field2->array();
+        EXPECT_THAT(promotedArray->count_, 2);
+        EXPECT_THAT(*ArrayAddressOfElementAt(promotedArray, 0), promotedChild.header());
+        EXPECT_THAT(*ArrayAddressOfElementAt(promotedArray, 1), nullptr);
+
+        threadData.ClearForTests();
+    });
+}
+
+TEST(ObjectArenaTest, Contains) {
+    RunInNewThread([](mm::ThreadData& threadData) {
+        mm::ObjectArena parent(threadData.gc(), nullptr);
+        mm::ObjectArena child(threadData.gc(), &parent);
+        auto& parentObject = test_support::Object<Payload>::FromObjHeader(parent.PlaceObject(payloadType().typeInfo()));
+        auto* bigArray = child.PlaceArray(theByteArrayTypeInfo, 100000);
+        test_support::Object<Payload> heapObject(payloadType().typeInfo());
+
+        EXPECT_TRUE(parent.Contains(parentObject.header()));
+        EXPECT_TRUE(parent.Contains(&parentObject->field2));
+        EXPECT_FALSE(child.Contains(parentObject.header()));
+        EXPECT_TRUE(child.Contains(ByteArrayAddressOfElementAt(bigArray, 99999)));
+        EXPECT_FALSE(parent.Contains(heapObject.header()));
+        EXPECT_FALSE(child.Contains(heapObject.header()));
+    });
+}
+
+TEST(ObjectArenaTest, StoreIntoArena) {
+    RunInNewThread([](mm::ThreadData& threadData) {
+        threadData.EnterArena();
+        auto& outer = test_support::Object<Payload>::FromObjHeader(threadData.arena()->PlaceObject(payloadType().typeInfo()));
+        threadData.EnterArena();
+        auto& inner = test_support::Object<Payload>::FromObjHeader(threadData.arena()->PlaceObject(payloadType().typeInfo()));
+
+        // Into the same arena and into a nested one.
+        mm::CheckArenaStore(&outer->field1, outer.header());
+        mm::CheckArenaStore(&inner->field1, inner.header());
+        mm::CheckArenaStore(&inner->field2, outer.header());
+
+        threadData.LeaveArena();
+        threadData.LeaveArena();
+    });
+}
+
+TEST(ObjectArenaDeathTest, EscapeFromArena) {
+    RunInNewThread([](mm::ThreadData& threadData) {
+        test_support::Object<Payload> heapObject(payloadType().typeInfo());
+        threadData.EnterArena();
+        auto& outer = test_support::Object<Payload>::FromObjHeader(threadData.arena()->PlaceObject(payloadType().typeInfo()));
+        threadData.EnterArena();
+        auto& inner = test_support::Object<Payload>::FromObjHeader(threadData.arena()->PlaceObject(payloadType().typeInfo()));
+
+        EXPECT_DEATH(mm::CheckArenaStore(&heapObject->field1, outer.header()), "outlives the arena");
+        EXPECT_DEATH(mm::CheckArenaStore(&outer->field1, inner.header()), "outlives the arena");
+        EXPECT_DEATH(mm::CheckArenaStore(nullptr, inner.header()), "outlives the arena");
+
+        threadData.LeaveArena();
+        threadData.LeaveArena();
+    });
+}
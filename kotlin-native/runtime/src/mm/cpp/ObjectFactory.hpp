@@ -7,15 +7,19 @@
 #define RUNTIME_MM_OBJECT_FACTORY_H
 
 #include <algorithm>
+#include <atomic>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <type_traits>
+#include <utility>
 
 #include "Alignment.hpp"
 #include "Alloc.h"
 #include "FinalizerHooks.hpp"
 #include "Memory.h"
 #include "Mutex.hpp"
+#include "Porting.h"
 #include "Types.h"
 #include "Utils.hpp"
 
@@ -79,14 +83,22 @@ public:
 
         Node() noexcept = default;
 
-        static unique_ptr<Node> Create(Allocator& allocator, size_t dataSize) noexcept {
+        static constexpr size_t TotalAlignment() noexcept { return std::max(alignof(Node), DataAlignment); }
+
+        static size_t TotalSize(size_t dataSize) noexcept {
             size_t dataSizeAligned = AlignUp(dataSize, DataAlignment);
-            size_t totalAlignment = std::max(alignof(Node), DataAlignment);
-            size_t totalSize = AlignUp(sizeof(Node) + dataSizeAligned, totalAlignment);
+            size_t totalSize = AlignUp(sizeof(Node) + dataSizeAligned, TotalAlignment());
             RuntimeAssert(
                     DataOffset() + dataSize <= totalSize, "totalSize %zu is not enough to fit data %zu at offset %zu", totalSize, dataSize,
                     DataOffset());
-            void* ptr = allocator.Alloc(totalSize, totalAlignment);
+            return totalSize;
+        }
+
+        // If `zeroed` is false, the data is left uninitialized.
+        static unique_ptr<Node> Create(Allocator& allocator, size_t dataSize, bool zeroed) noexcept {
+            size_t totalAlignment = TotalAlignment();
+            size_t totalSize = TotalSize(dataSize);
+            void* ptr = zeroed ? allocator.Alloc(totalSize, totalAlignment) : allocator.AllocUninitialized(totalSize, totalAlignment);
             if (!ptr) {
                 konan::consoleErrorf("Out of memory trying to allocate %zu bytes. Aborting.\n", totalSize);
                 konan::abort();
@@ -95,6 +107,14 @@ public:
             return unique_ptr<Node>(new (ptr) Node());
         }
 
+        // Only uses the fast path of the allocator (`Allocator::TryAlloc`), and returns `nullptr` if that fails.
+        // The data is zeroed.
+        ALWAYS_INLINE static unique_ptr<Node> TryCreate(Allocator& allocator, size_t dataSize) noexcept {
+            void* ptr = allocator.TryAlloc(TotalSize(dataSize), TotalAlignment());
+            if (!ptr) return nullptr;
+            return unique_ptr<Node>(new (ptr) Node());
+        }
+
         unique_ptr<Node> next_;
         // There's some more data of an unknown (at compile-time) size here, but it cannot be represented
         // with C++ members.
@@ -126,20 +146,16 @@ public:
 
         ~Producer() { Publish(); }
 
-        Node& Insert(size_t dataSize) noexcept {
-            AssertCorrect();
-            auto node = Node::Create(allocator_, dataSize);
-            auto* nodePtr = node.get();
-            if (!root_) {
-                root_ = std::move(node);
-            } else {
-                last_->next_ = std::move(node);
-            }
+        Node& Insert(size_t dataSize) noexcept { return InsertNode(Node::Create(allocator_, dataSize, true)); }
 
-            last_ = nodePtr;
-            RuntimeAssert(root_ != nullptr, "Must not be empty");
-            AssertCorrect();
-            return *nodePtr;
+        // The data of the inserted node is not zeroed.
+        Node& InsertUninitialized(size_t dataSize) noexcept { return InsertNode(Node::Create(allocator_, dataSize, false)); }
+
+        // Like `Insert`, but returns `nullptr` instead of taking the slow path of the allocator.
+        ALWAYS_INLINE Node* TryInsert(size_t dataSize) noexcept {
+            auto node = Node::TryCreate(allocator_, dataSize);
+            if (!node) return nullptr;
+            return &InsertNode(std::move(node));
         }
 
         template <typename T, typename... Args>
@@ -182,6 +198,8 @@ public:
         Iterator begin() noexcept { return Iterator(root_.get()); }
         Iterator end() noexcept { return Iterator(nullptr); }
 
+        Allocator& allocator() noexcept { return allocator_; }
+
         void ClearForTests() noexcept {
             // Since it's only for tests, no need to worry about stack overflows.
             root_.reset();
@@ -191,6 +209,21 @@ public:
     private:
         friend class ObjectFactoryStorage;
 
+        ALWAYS_INLINE Node& InsertNode(unique_ptr<Node> node) noexcept {
+            AssertCorrect();
+            auto* nodePtr = node.get();
+            if (!root_) {
+                root_ = std::move(node);
+            } else {
+                last_->next_ = std::move(node);
+            }
+
+            last_ = nodePtr;
+            RuntimeAssert(root_ != nullptr, "Must not be empty");
+            AssertCorrect();
+            return *nodePtr;
+        }
+
         ALWAYS_INLINE void AssertCorrect() const noexcept {
             if (root_ == nullptr) {
                 RuntimeAssert(last_ == nullptr, "last_ must be null");
@@ -299,12 +332,22 @@ public:
     public:
         explicit Iterable(ObjectFactoryStorage& owner) noexcept : owner_(owner), guard_(owner_.mutex_) {}
 
+        Iterable(Iterable&&) noexcept = default;
+
+        ~Iterable() {
+            if (guard_.owns_lock()) {
+                owner_.FlushPendingFreesUnsafe();
+            }
+        }
+
         Iterator begin() noexcept { return Iterator(nullptr, owner_.root_.get()); }
         Iterator end() noexcept { return Iterator(owner_.last_, nullptr); }
 
+        // The memory of the erased node is freed in batches: either when enough nodes are erased or when `this` is destroyed.
         void EraseAndAdvance(Iterator& iterator) noexcept {
             auto result = owner_.ExtractUnsafe(iterator.previousNode_);
             iterator.node_ = result.second;
+            owner_.FreeLaterUnsafe(std::move(result.first));
         }
 
         void MoveAndAdvance(Consumer& consumer, Iterator& iterator) noexcept {
@@ -319,6 +362,7 @@ public:
     };
 
     ~ObjectFactoryStorage() {
+        RuntimeAssert(pendingFreeCount_ == 0, "All pending frees must have been flushed");
         // Make sure not to blow up the stack by nested `~Node` calls.
         for (auto node = std::move(root_); node != nullptr; node = std::move(node->next_)) {}
     }
@@ -358,6 +402,24 @@ private:
         return {std::move(node), previousNode->next_.get()};
     }
 
+    // Expects `mutex_` to be held by the current thread.
+    void FreeLaterUnsafe(unique_ptr<Node> node) noexcept {
+        Node* nodePtr = node.release();
+        nodePtr->~Node();
+        pendingFree_[pendingFreeCount_++] = nodePtr;
+        if (pendingFreeCount_ == kFreeBatchSize) {
+            FlushPendingFreesUnsafe();
+        }
+    }
+
+    // Expects `mutex_` to be held by the current thread.
+    void FlushPendingFreesUnsafe() noexcept {
+        if (pendingFreeCount_ == 0) return;
+        // Nodes are published by whole per-thread sublists, so consecutive erased nodes mostly come from the same heap.
+        Allocator::FreeBatch(pendingFree_, pendingFreeCount_);
+        pendingFreeCount_ = 0;
+    }
+
     // Expects `mutex_` to be held by the current thread.
     ALWAYS_INLINE void AssertCorrectUnsafe() const noexcept {
         if (root_ == nullptr) {
@@ -368,18 +430,49 @@ private:
         }
     }
 
+    static constexpr size_t kFreeBatchSize = 256;
+
     unique_ptr<Node> root_;
     Node* last_ = nullptr;
     SpinLock mutex_;
+    // Guarded by `mutex_`.
+    void* pendingFree_[kFreeBatchSize];
+    size_t pendingFreeCount_ = 0;
 };
 
 class SimpleAllocator {
 public:
     void* Alloc(size_t size, size_t alignment) noexcept { return konanAllocAlignedMemory(size, alignment); }
 
+    void* AllocUninitialized(size_t size, size_t alignment) noexcept { return konan::malloc_aligned(size, alignment); }
+
+    static void Free(void* instance) noexcept { konanFreeMemory(instance); }
+
+    static void FreeBatch(void** instances, size_t count) noexcept { konan::free_batch(instances, count); }
+};
+
+// Allocates from the allocator heap stored at `heap` (which is usually owned by the allocating thread).
+// The heap is read through the pointer, so that the owner can replace it, e.g. when a pooled `ThreadData`
+// is attached to another thread. Memory can be freed from any thread.
+class HeapAllocator {
+public:
+    explicit HeapAllocator(konan::AllocatorHeap* const* heap) noexcept : heap_(heap) {}
+
+    void* Alloc(size_t size, size_t alignment) noexcept { return konan::heap_calloc_aligned(*heap_, 1, size, alignment); }
+
+    void* AllocUninitialized(size_t size, size_t alignment) noexcept { return konan::heap_malloc_aligned(*heap_, size, alignment); }
+
     static void Free(void* instance) noexcept { konanFreeMemory(instance); }
+
+    static void FreeBatch(void** instances, size_t count) noexcept { konan::free_batch(instances, count); }
+
+private:
+    konan::AllocatorHeap* const* heap_; // weak
 };
 
+// A null heap: `HeapAllocator` falls back to the default allocator heap.
+inline konan::AllocatorHeap* const kNoAllocatorHeap = nullptr;
+
 template <typename BaseAllocator, typename GC>
 class AllocatorWithGC {
 public:
@@ -395,13 +488,200 @@ public:
         return base_.Alloc(size, alignment);
     }
 
+    void* AllocUninitialized(size_t size, size_t alignment) noexcept {
+        gc_.SafePointAllocation(size);
+        if (void* ptr = base_.AllocUninitialized(size, alignment)) {
+            return ptr;
+        }
+        gc_.OnOOM(size);
+        return base_.AllocUninitialized(size, alignment);
+    }
+
     static void Free(void* instance) noexcept { BaseAllocator::Free(instance); }
 
+    static void FreeBatch(void** instances, size_t count) noexcept { BaseAllocator::FreeBatch(instances, count); }
+
 private:
     BaseAllocator base_;
     GC& gc_;
 };
 
+// Bump-allocates small blocks from chunks of `BaseAllocator` memory owned by a single thread. Taking a block is
+// a pointer bump with no synchronization and no GC check: `BaseAllocator` (and so the GC) only sees whole chunks.
+// Blocks are freed one by one from any thread, and a chunk is freed along with its last block once its owner has
+// moved on to another chunk. Bigger blocks are taken from `BaseAllocator` directly.
+//
+// Blocks in chunks are at 8 modulo 16, blocks of `BaseAllocator` are 16-aligned, which tells them apart in `Free`.
+// Chunks are aligned to their size, so that a block finds its chunk. If the platform allocator cannot align
+// (see `konan::aligned_alloc_supported`), nothing is buffered.
+template <typename BaseAllocator>
+class BufferedAllocator : private MoveOnly {
+    static constexpr size_t kChunkSize = 16 * 1024;
+    static constexpr size_t kMaxBufferedSize = 512;
+    static constexpr size_t kBlockAlignment = 16;
+    static constexpr size_t kBufferedOffset = 8;
+
+    // Lives at the start of the chunk memory, the blocks follow.
+    class Chunk : private Pinned {
+    public:
+        static Chunk* Create(BaseAllocator& allocator) noexcept {
+            void* memory = allocator.Alloc(kChunkSize, kChunkSize);
+            if (!memory) return nullptr;
+            RuntimeAssert(IsAligned(memory, kChunkSize), "Allocator returned unaligned to %zu pointer %p", kChunkSize, memory);
+            return new (memory) Chunk();
+        }
+
+        static Chunk& FromBlock(void* block) noexcept {
+            return *reinterpret_cast<Chunk*>(reinterpret_cast<uintptr_t>(block) & ~(kChunkSize - 1));
+        }
+
+        uint8_t* begin() noexcept { return reinterpret_cast<uint8_t*>(this) + kBufferedOffset; }
+        uint8_t* end() noexcept { return reinterpret_cast<uint8_t*>(this) + kChunkSize; }
+
+        void FreeBlock() noexcept {
+            if (balance_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                Destroy();
+            }
+        }
+
+        // Called by the owner when it stops allocating from `this`, with the number of blocks it has allocated.
+        void Retire(size_t allocated) noexcept {
+            // The balance drops from `kOwnerBias - freed` to `allocated - freed`.
+            if (balance_.fetch_add(allocated - kOwnerBias, std::memory_order_acq_rel) == kOwnerBias - allocated) {
+                Destroy();
+            }
+        }
+
+    private:
+        // Keeps the balance positive while the owner may still allocate, without counting each allocation here.
+        static constexpr size_t kOwnerBias = std::numeric_limits<size_t>::max() / 2;
+
+        void Destroy() noexcept {
+            this->~Chunk();
+            BaseAllocator::Free(this);
+        }
+
+        std::atomic<size_t> balance_ = kOwnerBias;
+    };
+
+    static_assert(sizeof(Chunk) <= kBufferedOffset, "Chunk header must fit before the first block");
+
+public:
+    explicit BufferedAllocator(BaseAllocator base) noexcept : base_(std::move(base)) {}
+
+    BufferedAllocator(BufferedAllocator&& rhs) noexcept :
+        base_(std::move(rhs.base_)),
+        chunk_(std::exchange(rhs.chunk_, nullptr)),
+        top_(std::exchange(rhs.top_, nullptr)),
+        end_(std::exchange(rhs.end_, nullptr)),
+        allocated_(std::exchange(rhs.allocated_, 0)),
+        suspendedEnd_(std::exchange(rhs.suspendedEnd_, nullptr)),
+        suspended_(std::exchange(rhs.suspended_, false)) {}
+
+    ~BufferedAllocator() { ReleaseBuffer(); }
+
+    // The fast path: `nullptr` if the block is not buffered or does not fit into the current chunk. The memory is zeroed.
+    ALWAYS_INLINE void* TryAlloc(size_t size, size_t alignment) noexcept {
+        size = AlignUp(size, kBlockAlignment);
+        if (alignment > kBufferedOffset || size > kMaxBufferedSize || size > static_cast<size_t>(end_ - top_)) {
+            return nullptr;
+        }
+        void* ptr = top_;
+        top_ += size;
+        ++allocated_;
+        return ptr;
+    }
+
+    ALWAYS_INLINE void* Alloc(size_t size, size_t alignment) noexcept {
+        if (void* ptr = TryAlloc(size, alignment)) {
+            return ptr;
+        }
+        return AllocSlowPath(size, alignment, true);
+    }
+
+    ALWAYS_INLINE void* AllocUninitialized(size_t size, size_t alignment) noexcept {
+        if (void* ptr = TryAlloc(size, alignment)) {
+            return ptr;
+        }
+        return AllocSlowPath(size, alignment, false);
+    }
+
+    static void Free(void* instance) noexcept {
+        if (IsBuffered(instance)) {
+            Chunk::FromBlock(instance).FreeBlock();
+        } else {
+            BaseAllocator::Free(instance);
+        }
+    }
+
+    static void FreeBatch(void** instances, size_t count) noexcept {
+        size_t unbuffered = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (IsBuffered(instances[i])) {
+                Chunk::FromBlock(instances[i]).FreeBlock();
+            } else {
+                instances[unbuffered++] = instances[i];
+            }
+        }
+        BaseAllocator::FreeBatch(instances, unbuffered);
+    }
+
+    // Until `ResumeBuffer`, `TryAlloc` fails and `Alloc` takes every block from `BaseAllocator`.
+    void SuspendBuffer() noexcept {
+        RuntimeAssert(!suspended_, "Buffer is already suspended");
+        suspended_ = true;
+        suspendedEnd_ = std::exchange(end_, top_);
+    }
+
+    void ResumeBuffer() noexcept {
+        RuntimeAssert(suspended_, "Buffer is not suspended");
+        suspended_ = false;
+        end_ = std::exchange(suspendedEnd_, nullptr);
+    }
+
+    // Gives up the rest of the current chunk.
+    void ReleaseBuffer() noexcept {
+        if (chunk_ == nullptr) return;
+        std::exchange(chunk_, nullptr)->Retire(std::exchange(allocated_, 0));
+        top_ = nullptr;
+        end_ = nullptr;
+        suspendedEnd_ = nullptr;
+    }
+
+private:
+    static bool Enabled() noexcept {
+        static const bool enabled = konan::aligned_alloc_supported();
+        return enabled;
+    }
+
+    static bool IsBuffered(void* instance) noexcept {
+        return Enabled() && (reinterpret_cast<uintptr_t>(instance) & (kBlockAlignment - 1)) == kBufferedOffset;
+    }
+
+    NO_INLINE void* AllocSlowPath(size_t size, size_t alignment, bool zeroed) noexcept {
+        if (suspended_ || !Enabled() || alignment > kBufferedOffset || AlignUp(size, kBlockAlignment) > kMaxBufferedSize) {
+            alignment = std::max(alignment, kBlockAlignment);
+            return zeroed ? base_.Alloc(size, alignment) : base_.AllocUninitialized(size, alignment);
+        }
+        Chunk* chunk = Chunk::Create(base_);
+        if (!chunk) return nullptr;
+        ReleaseBuffer();
+        chunk_ = chunk;
+        top_ = chunk->begin();
+        end_ = chunk->end();
+        return TryAlloc(size, alignment);
+    }
+
+    BaseAllocator base_;
+    Chunk* chunk_ = nullptr;
+    uint8_t* top_ = nullptr;
+    uint8_t* end_ = nullptr;
+    // Blocks allocated from `chunk_`.
+    size_t allocated_ = 0;
+    uint8_t* suspendedEnd_ = nullptr;
+    bool suspended_ = false;
+};
+
 } // namespace internal
 
 template <typename GC>
@@ -409,7 +689,7 @@ class ObjectFactory : private Pinned {
     using GCObjectData = typename GC::ObjectData;
     using GCThreadData = typename GC::ThreadData;
 
-    using Allocator = internal::AllocatorWithGC<internal::SimpleAllocator, GCThreadData>;
+    using Allocator = internal::BufferedAllocator<internal::AllocatorWithGC<internal::HeapAllocator, GCThreadData>>;
 
     struct HeapObjHeader {
         GCObjectData gcData;
@@ -423,6 +703,18 @@ class ObjectFactory : private Pinned {
         alignas(kObjectAlignment) ArrayHeader array;
     };
 
+    static size_t ObjectAllocatedDataSize(const TypeInfo* typeInfo) noexcept {
+        size_t membersSize = typeInfo->instanceSize_ - sizeof(ObjHeader);
+        return AlignUp(sizeof(HeapObjHeader) + membersSize, kObjectAlignment);
+    }
+
+    static size_t ArrayAllocatedDataSize(const TypeInfo* typeInfo, uint32_t count) noexcept {
+        // In `size_t`, so that the allocation fast path cannot be fooled by an overflow.
+        size_t membersSize = static_cast<size_t>(-typeInfo->instanceSize_) * count;
+        // Note: array body is aligned, but for size computation it is enough to align the sum.
+        return AlignUp(sizeof(HeapArrayHeader) + membersSize, kObjectAlignment);
+    }
+
 public:
     using Storage = internal::ObjectFactoryStorage<kObjectAlignment, Allocator>;
 
@@ -473,6 +765,15 @@ public:
             return array;
         }
 
+        // Size of the object data (including GC data), excluding the storage overhead.
+        size_t AllocatedDataSize() noexcept {
+            if (IsArray()) {
+                auto* array = GetArrayHeader();
+                return ArrayAllocatedDataSize(array->type_info(), array->count_);
+            }
+            return ObjectAllocatedDataSize(GetObjHeader()->type_info());
+        }
+
         bool operator==(const NodeRef& rhs) const noexcept { return &node_ == &rhs.node_; }
 
         bool operator!=(const NodeRef& rhs) const noexcept { return !(*this == rhs); }
@@ -504,33 +805,51 @@ public:
             typename Storage::Producer::Iterator iterator_;
         };
 
-        ThreadQueue(ObjectFactory& owner, GCThreadData& gc) noexcept :
-            producer_(owner.storage_, internal::AllocatorWithGC(internal::SimpleAllocator(), gc)) {}
+        // `heap` may be `nullptr` to allocate from the default allocator heap.
+        ThreadQueue(ObjectFactory& owner, GCThreadData& gc, konan::AllocatorHeap* const* heap = &internal::kNoAllocatorHeap) noexcept :
+            producer_(owner.storage_, Allocator(internal::AllocatorWithGC(internal::HeapAllocator(heap), gc))) {}
 
         ObjHeader* CreateObject(const TypeInfo* typeInfo) noexcept {
             RuntimeAssert(!typeInfo->IsArray(), "Must not be an array");
-            size_t membersSize = typeInfo->instanceSize_ - sizeof(ObjHeader);
-            size_t allocSize = AlignUp(sizeof(HeapObjHeader) + membersSize, kObjectAlignment);
-            auto& node = producer_.Insert(allocSize);
-            auto* heapObject = new (node.Data()) HeapObjHeader();
-            auto* object = &heapObject->object;
-            object->typeInfoOrMeta_ = const_cast<TypeInfo*>(typeInfo);
-            return object;
+            return InitObject(producer_.Insert(ObjectAllocatedDataSize(typeInfo)), typeInfo);
         }
 
         ArrayHeader* CreateArray(const TypeInfo* typeInfo, uint32_t count) noexcept {
             RuntimeAssert(typeInfo->IsArray(), "Must be an array");
-            uint32_t membersSize = static_cast<uint32_t>(-typeInfo->instanceSize_) * count;
-            // Note: array body is aligned, but for size computation it is enough to align the sum.
-            size_t allocSize = AlignUp(sizeof(HeapArrayHeader) + membersSize, kObjectAlignment);
-            auto& node = producer_.Insert(allocSize);
-            auto* heapArray = new (node.Data()) HeapArrayHeader();
-            auto* array = &heapArray->array;
-            array->typeInfoOrMeta_ = const_cast<TypeInfo*>(typeInfo);
-            array->count_ = count;
-            return array;
+            return InitArray(producer_.Insert(ArrayAllocatedDataSize(typeInfo, count)), typeInfo, count);
+        }
+
+        // Only for arrays without references: the elements are left uninitialized and must all be
+        // written before anyone else can observe the array.
+        ArrayHeader* CreateArrayUninitialized(const TypeInfo* typeInfo, uint32_t count) noexcept {
+            RuntimeAssert(typeInfo->IsArray(), "Must be an array");
+            RuntimeAssert(typeInfo != theArrayTypeInfo, "Must not contain references");
+            return InitArray(producer_.InsertUninitialized(ArrayAllocatedDataSize(typeInfo, count)), typeInfo, count);
+        }
+
+        // The fast paths of `CreateObject` and `CreateArray`: `nullptr` if the allocation buffer of the thread cannot
+        // take the object, and then neither the allocator nor the GC has been called.
+        ALWAYS_INLINE ObjHeader* TryCreateObject(const TypeInfo* typeInfo) noexcept {
+            RuntimeAssert(!typeInfo->IsArray(), "Must not be an array");
+            auto* node = producer_.TryInsert(ObjectAllocatedDataSize(typeInfo));
+            if (!node) return nullptr;
+            return InitObject(*node, typeInfo);
+        }
+
+        ALWAYS_INLINE ArrayHeader* TryCreateArray(const TypeInfo* typeInfo, uint32_t count) noexcept {
+            RuntimeAssert(typeInfo->IsArray(), "Must be an array");
+            auto* node = producer_.TryInsert(ArrayAllocatedDataSize(typeInfo, count));
+            if (!node) return nullptr;
+            return InitArray(*node, typeInfo, count);
         }
 
+        // While suspended, `TryCreateObject` and `TryCreateArray` fail, and other objects bypass the buffer.
+        void SuspendAllocationBuffer() noexcept { producer_.allocator().SuspendBuffer(); }
+        void ResumeAllocationBuffer() noexcept { producer_.allocator().ResumeBuffer(); }
+
+        // Lets the memory left in the buffer go, e.g. when the thread goes away.
+        void ReleaseAllocationBuffer() noexcept { producer_.allocator().ReleaseBuffer(); }
+
         void Publish() noexcept { producer_.Publish(); }
 
         Iterator begin() noexcept { return Iterator(producer_.begin()); }
@@ -539,6 +858,21 @@ public:
         void ClearForTests() noexcept { producer_.ClearForTests(); }
 
     private:
+        ALWAYS_INLINE static ObjHeader* InitObject(typename Storage::Node& node, const TypeInfo* typeInfo) noexcept {
+            auto* heapObject = new (node.Data()) HeapObjHeader();
+            auto* object = &heapObject->object;
+            object->typeInfoOrMeta_ = const_cast<TypeInfo*>(typeInfo);
+            return object;
+        }
+
+        ALWAYS_INLINE static ArrayHeader* InitArray(typename Storage::Node& node, const TypeInfo* typeInfo, uint32_t count) noexcept {
+            auto* heapArray = new (node.Data()) HeapArrayHeader();
+            auto* array = &heapArray->array;
+            array->typeInfoOrMeta_ = const_cast<TypeInfo*>(typeInfo);
+            array->count_ = count;
+            return array;
+        }
+
         typename Storage::Producer producer_;
     };
 
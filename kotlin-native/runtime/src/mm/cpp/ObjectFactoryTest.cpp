@@ -331,6 +331,37 @@ TEST(ObjectFactoryStorageTest, EraseTheOnlyElement) {
     EXPECT_THAT(actual, testing::IsEmpty());
 }
 
+TEST(ObjectFactoryStorageTest, EraseMoreThanFreeBatch) {
+    ObjectFactoryStorageRegular storage;
+    Producer<ObjectFactoryStorageRegular> producer(storage, SimpleAllocator());
+
+    constexpr int kCount = 1000;
+    KStdVector<int> expected;
+    for (int i = 0; i < kCount; ++i) {
+        producer.Insert<int>(i);
+        if (i % 3 == 0) {
+            expected.push_back(i);
+        }
+    }
+
+    producer.Publish();
+
+    {
+        auto iter = storage.Iter();
+        for (auto it = iter.begin(); it != iter.end();) {
+            if (it->Data<int>() % 3 != 0) {
+                iter.EraseAndAdvance(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    auto actual = Collect<int>(storage);
+
+    EXPECT_THAT(actual, testing::ElementsAreArray(expected));
+}
+
 TEST(ObjectFactoryStorageTest, MoveFirst) {
     ObjectFactoryStorageRegular storage;
     Producer<ObjectFactoryStorageRegular> producer(storage, SimpleAllocator());
@@ -758,6 +789,153 @@ struct Payload {
 
 } // namespace
 
+TEST(HeapAllocatorTest, AllocateAndFree) {
+    auto* heap = konan::heap_new();
+    mm::internal::HeapAllocator allocator(&heap);
+
+    constexpr size_t kCount = 10;
+    void* blocks[kCount];
+    for (size_t i = 0; i < kCount; ++i) {
+        blocks[i] = allocator.Alloc(64, 16);
+        ASSERT_THAT(blocks[i], testing::Ne(nullptr));
+        EXPECT_TRUE(IsAligned(blocks[i], 16));
+        EXPECT_THAT(*static_cast<uint64_t*>(blocks[i]), 0);
+    }
+    // Blocks must outlive the heap.
+    konan::heap_delete(heap);
+    mm::internal::HeapAllocator::Free(blocks[0]);
+    mm::internal::HeapAllocator::FreeBatch(blocks + 1, kCount - 1);
+}
+
+namespace {
+
+// Counts the blocks that it has given out and not got back.
+class CountingAllocator {
+public:
+    void* Alloc(size_t size, size_t alignment) noexcept {
+        ++liveBlocks;
+        return konan::calloc_aligned(1, size, alignment);
+    }
+
+    void* AllocUninitialized(size_t size, size_t alignment) noexcept {
+        ++liveBlocks;
+        return konan::malloc_aligned(size, alignment);
+    }
+
+    static void Free(void* instance) noexcept {
+        --liveBlocks;
+        konan::free(instance);
+    }
+
+    static void FreeBatch(void** instances, size_t count) noexcept {
+        for (size_t i = 0; i < count; ++i) {
+            Free(instances[i]);
+        }
+    }
+
+    static inline std::atomic<int> liveBlocks = 0;
+};
+
+using BufferedAllocator = mm::internal::BufferedAllocator<CountingAllocator>;
+
+} // namespace
+
+TEST(BufferedAllocatorTest, BumpSmallBlocks) {
+    if (!konan::aligned_alloc_supported()) {
+        GTEST_SKIP() << "Nothing is buffered without aligned allocations";
+    }
+    BufferedAllocator allocator{CountingAllocator()};
+    EXPECT_THAT(allocator.TryAlloc(32, 8), nullptr);
+
+    auto* first = static_cast<uint8_t*>(allocator.Alloc(32, 8));
+    auto* second = static_cast<uint8_t*>(allocator.TryAlloc(24, 8));
+    auto* third = static_cast<uint8_t*>(allocator.TryAlloc(32, 8));
+    EXPECT_THAT(CountingAllocator::liveBlocks.load(), 1);
+    EXPECT_THAT(second, first + 32);
+    // Blocks are rounded up to 16 bytes.
+    EXPECT_THAT(third, second + 32);
+    EXPECT_THAT(*reinterpret_cast<uint64_t*>(third), 0);
+
+    void* big = allocator.Alloc(4096, 8);
+    EXPECT_THAT(CountingAllocator::liveBlocks.load(), 2);
+    EXPECT_TRUE(IsAligned(big, 16));
+    BufferedAllocator::Free(big);
+    EXPECT_THAT(CountingAllocator::liveBlocks.load(), 1);
+
+    BufferedAllocator::Free(first);
+    void* rest[] = {second, third};
+    BufferedAllocator::FreeBatch(rest, 2);
+    // The allocator can still bump in the chunk.
+    EXPECT_THAT(CountingAllocator::liveBlocks.load(), 1);
+    allocator.ReleaseBuffer();
+    EXPECT_THAT(CountingAllocator::liveBlocks.load(), 0);
+}
+
+TEST(BufferedAllocatorTest, ChunkOutlivesRelease) {
+    if (!konan::aligned_alloc_supported()) {
+        GTEST_SKIP() << "Nothing is buffered without aligned allocations";
+    }
+    void* first;
+    void* second;
+    {
+        BufferedAllocator allocator{CountingAllocator()};
+        first = allocator.Alloc(64, 8);
+        second = allocator.Alloc(64, 8);
+    }
+    EXPECT_THAT(CountingAllocator::liveBlocks.load(), 1);
+    BufferedAllocator::Free(second);
+    EXPECT_THAT(CountingAllocator::liveBlocks.load(), 1);
+    BufferedAllocator::Free(first);
+    EXPECT_THAT(CountingAllocator::liveBlocks.load(), 0);
+}
+
+TEST(BufferedAllocatorTest, RefillWhenFull) {
+    if (!konan::aligned_alloc_supported()) {
+        GTEST_SKIP() << "Nothing is buffered without aligned allocations";
+    }
+    constexpr size_t kBlockSize = 512;
+    constexpr size_t kCount = 100;
+    KStdVector<void*> blocks;
+    {
+        BufferedAllocator allocator{CountingAllocator()};
+        for (size_t i = 0; i < kCount; ++i) {
+            blocks.push_back(allocator.Alloc(kBlockSize, 8));
+        }
+        EXPECT_THAT(CountingAllocator::liveBlocks.load(), testing::Gt(1));
+        EXPECT_THAT(CountingAllocator::liveBlocks.load(), testing::Lt(static_cast<int>(kCount)));
+        // Free all but the last block: only the current chunk stays.
+        BufferedAllocator::FreeBatch(blocks.data(), kCount - 1);
+        EXPECT_THAT(CountingAllocator::liveBlocks.load(), 1);
+    }
+    EXPECT_THAT(CountingAllocator::liveBlocks.load(), 1);
+    BufferedAllocator::Free(blocks.back());
+    EXPECT_THAT(CountingAllocator::liveBlocks.load(), 0);
+}
+
+TEST(BufferedAllocatorTest, Suspend) {
+    if (!konan::aligned_alloc_supported()) {
+        GTEST_SKIP() << "Nothing is buffered without aligned allocations";
+    }
+    BufferedAllocator allocator{CountingAllocator()};
+    void* buffered = allocator.Alloc(32, 8);
+    EXPECT_THAT(CountingAllocator::liveBlocks.load(), 1);
+
+    allocator.SuspendBuffer();
+    EXPECT_THAT(allocator.TryAlloc(32, 8), nullptr);
+    void* unbuffered = allocator.Alloc(32, 8);
+    EXPECT_THAT(CountingAllocator::liveBlocks.load(), 2);
+    EXPECT_TRUE(IsAligned(unbuffered, 16));
+
+    allocator.ResumeBuffer();
+    void* next = allocator.TryAlloc(32, 8);
+    EXPECT_THAT(next, static_cast<uint8_t*>(buffered) + 32);
+
+    void* blocks[] = {buffered, unbuffered, next};
+    BufferedAllocator::FreeBatch(blocks, 3);
+    allocator.ReleaseBuffer();
+    EXPECT_THAT(CountingAllocator::liveBlocks.load(), 0);
+}
+
 TEST(ObjectFactoryTest, CreateObject) {
     test_support::TypeInfoHolder type{test_support::TypeInfoHolder::ObjectBuilder<Payload>()};
     GC::ThreadData gc;
@@ -779,6 +957,38 @@ TEST(ObjectFactoryTest, CreateObject) {
     EXPECT_THAT(it, iter.end());
 }
 
+TEST(ObjectFactoryTest, TryCreateObject) {
+    if (!konan::aligned_alloc_supported()) {
+        GTEST_SKIP() << "Nothing is buffered without aligned allocations";
+    }
+    test_support::TypeInfoHolder type{test_support::TypeInfoHolder::ObjectBuilder<Payload>()};
+    GC::ThreadData gc;
+    ObjectFactory objectFactory;
+    ObjectFactory::ThreadQueue threadQueue(objectFactory, gc);
+
+    // The allocation buffer is only filled on the slow path.
+    EXPECT_THAT(threadQueue.TryCreateObject(type.typeInfo()), nullptr);
+    auto* object1 = threadQueue.CreateObject(type.typeInfo());
+    auto* object2 = threadQueue.TryCreateObject(type.typeInfo());
+    ASSERT_THAT(object2, testing::Ne(nullptr));
+    EXPECT_THAT(object2->type_info(), type.typeInfo());
+    threadQueue.SuspendAllocationBuffer();
+    EXPECT_THAT(threadQueue.TryCreateObject(type.typeInfo()), nullptr);
+    threadQueue.ResumeAllocationBuffer();
+    threadQueue.Publish();
+
+    auto node1 = ObjectFactory::NodeRef::From(object1);
+    auto node2 = ObjectFactory::NodeRef::From(object2);
+    EXPECT_THAT(node2.GCObjectData().flags, 42);
+    auto iter = objectFactory.Iter();
+    auto it = iter.begin();
+    EXPECT_THAT(*it, node1);
+    ++it;
+    EXPECT_THAT(*it, node2);
+    ++it;
+    EXPECT_THAT(it, iter.end());
+}
+
 TEST(ObjectFactoryTest, CreateObjectArray) {
     GC::ThreadData gc;
     ObjectFactory objectFactory;
@@ -819,6 +1029,27 @@ TEST(ObjectFactoryTest, CreateCharArray) {
     EXPECT_THAT(it, iter.end());
 }
 
+TEST(ObjectFactoryTest, CreateCharArrayUninitialized) {
+    GC::ThreadData gc;
+    ObjectFactory objectFactory;
+    ObjectFactory::ThreadQueue threadQueue(objectFactory, gc);
+
+    auto* array = threadQueue.CreateArrayUninitialized(theCharArrayTypeInfo, 3);
+    threadQueue.Publish();
+
+    auto node = ObjectFactory::NodeRef::From(array);
+    EXPECT_TRUE(node.IsArray());
+    EXPECT_THAT(node.GetArrayHeader(), array);
+    EXPECT_THAT(node.GetArrayHeader()->count_, 3);
+    EXPECT_THAT(node.GCObjectData().flags, 42);
+
+    auto iter = objectFactory.Iter();
+    auto it = iter.begin();
+    EXPECT_THAT(*it, node);
+    ++it;
+    EXPECT_THAT(it, iter.end());
+}
+
 TEST(ObjectFactoryTest, Erase) {
     test_support::TypeInfoHolder objectType{test_support::TypeInfoHolder::ObjectBuilder<Payload>()};
     GC::ThreadData gc;
@@ -6,6 +6,7 @@
 #include "ObjectOps.hpp"
 
 #include "Common.h"
+#include "ObjectArena.hpp"
 #include "ThreadData.hpp"
 #include "ThreadState.hpp"
 
@@ -20,6 +21,7 @@ ALWAYS_INLINE void mm::SetStackRef(ObjHeader** location, ObjHeader* value) noexc
 
 ALWAYS_INLINE void mm::SetHeapRef(ObjHeader** location, ObjHeader* value) noexcept {
     AssertThreadState(ThreadState::kRunnable);
+    CheckArenaStore(location, value);
     *location = value;
 }
 
@@ -31,6 +33,7 @@ ALWAYS_INLINE void mm::SetHeapRef(ObjHeader** location, ObjHeader* value) noexce
 
 ALWAYS_INLINE void mm::SetHeapRefAtomic(ObjHeader** location, ObjHeader* value) noexcept {
     AssertThreadState(ThreadState::kRunnable);
+    CheckArenaStore(location, value);
     __atomic_store_n(location, value, __ATOMIC_RELEASE);
 }
 
@@ -43,6 +46,7 @@ ALWAYS_INLINE OBJ_GETTER(mm::ReadHeapRefAtomic, ObjHeader** location) noexcept {
 
 ALWAYS_INLINE OBJ_GETTER(mm::CompareAndSwapHeapRef, ObjHeader** location, ObjHeader* expected, ObjHeader* value) noexcept {
     AssertThreadState(ThreadState::kRunnable);
+    CheckArenaStore(location, value);
     // TODO: Make this work with GCs that can stop thread at any point.
     ObjHeader* actual = expected;
     // TODO: Do we need this strong memory model? Do we need to use strong CAS?
@@ -69,3 +73,11 @@ OBJ_GETTER(mm::AllocateArray, ThreadData* threadData, const TypeInfo* typeInfo,
     // `ArrayHeader` and `ObjHeader` are expected to be compatible.
     RETURN_OBJ(reinterpret_cast<ObjHeader*>(array));
 }
+
+OBJ_GETTER(mm::AllocateArrayUninitialized, ThreadData* threadData, const TypeInfo* typeInfo, uint32_t elements) noexcept {
+    AssertThreadState(threadData, ThreadState::kRunnable);
+    // TODO: Make this work with GCs that can stop thread at any point.
+    auto* array = threadData->objectFactoryThreadQueue().CreateArrayUninitialized(typeInfo, elements);
+    // `ArrayHeader` and `ObjHeader` are expected to be compatible.
+    RETURN_OBJ(reinterpret_cast<ObjHeader*>(array));
+}
@@ -28,6 +28,7 @@ OBJ_GETTER(ReadHeapRefAtomic, ObjHeader** location) noexcept;
 OBJ_GETTER(CompareAndSwapHeapRef, ObjHeader** location, ObjHeader* expected, ObjHeader* value) noexcept;
 OBJ_GETTER(AllocateObject, ThreadData* threadData, const TypeInfo* typeInfo) noexcept;
 OBJ_GETTER(AllocateArray, ThreadData* threadData, const TypeInfo* typeInfo, uint32_t elements) noexcept;
+OBJ_GETTER(AllocateArrayUninitialized, ThreadData* threadData, const TypeInfo* typeInfo, uint32_t elements) noexcept;
 
 } // namespace mm
 } // namespace kotlin
@@ -24,6 +24,8 @@ ObjHeader*& mm::ThreadRootSet::Iterator::operator*() noexcept {
             return *stackIterator_;
         case Phase::kTLS:
             return **tlsIterator_;
+        case Phase::kArena:
+            return *arenaIterator_;
         case Phase::kDone:
             RuntimeFail("Cannot dereference");
     }
@@ -39,6 +41,10 @@ mm::ThreadRootSet::Iterator& mm::ThreadRootSet::Iterator::operator++() noexcept
             ++tlsIterator_;
             Init();
             return *this;
+        case Phase::kArena:
+            ++arenaIterator_;
+            Init();
+            return *this;
         case Phase::kDone:
             return *this;
     }
@@ -56,6 +62,8 @@ bool mm::ThreadRootSet::Iterator::operator==(const Iterator& rhs) const noexcept
             return stackIterator_ == rhs.stackIterator_;
         case Phase::kTLS:
             return tlsIterator_ == rhs.tlsIterator_;
+        case Phase::kArena:
+            return arenaIterator_ == rhs.arenaIterator_;
     }
 }
 
@@ -69,6 +77,11 @@ void mm::ThreadRootSet::Iterator::Init() noexcept {
                 break;
             case Phase::kTLS:
                 if (tlsIterator_ != owner_.tls_.end()) return;
+                phase_ = Phase::kArena;
+                arenaIterator_ = ObjectArena::Iterator(owner_.arena_);
+                break;
+            case Phase::kArena:
+                if (arenaIterator_ != ObjectArena::Iterator(nullptr)) return;
                 phase_ = Phase::kDone;
                 break;
             case Phase::kDone:
@@ -143,7 +156,7 @@ void mm::GlobalRootSet::Iterator::Init() noexcept {
     }
 }
 
-mm::ThreadRootSet::ThreadRootSet(ThreadData& threadData) noexcept : ThreadRootSet(threadData.shadowStack(), threadData.tls()) {}
+mm::ThreadRootSet::ThreadRootSet(ThreadData& threadData) noexcept : ThreadRootSet(threadData.shadowStack(), threadData.tls(), threadData.arena()) {}
 
 mm::GlobalRootSet::GlobalRootSet() noexcept :
     GlobalRootSet(mm::GlobalData::Instance().globalsRegistry(), mm::GlobalData::Instance().stableRefRegistry()) {}
@@ -7,6 +7,7 @@
 #define RUNTIME_MM_ROOT_SET_H
 
 #include "GlobalsRegistry.hpp"
+#include "ObjectArena.hpp"
 #include "ShadowStack.hpp"
 #include "StableRefRegistry.hpp"
 #include "ThreadLocalStorage.hpp"
@@ -42,6 +43,7 @@ public:
         enum class Phase {
             kStack,
             kTLS,
+            kArena,
             kDone,
         };
 
@@ -52,10 +54,13 @@ public:
         union {
             ShadowStack::Iterator stackIterator_;
             ThreadLocalStorage::Iterator tlsIterator_;
+            ObjectArena::Iterator arenaIterator_;
         };
     };
 
-    ThreadRootSet(ShadowStack& stack, ThreadLocalStorage& tls) noexcept : stack_(stack), tls_(tls) {}
+    // All objects of the `arena` and its parents are roots.
+    ThreadRootSet(ShadowStack& stack, ThreadLocalStorage& tls, ObjectArena* arena = nullptr) noexcept :
+        stack_(stack), tls_(tls), arena_(arena) {}
     explicit ThreadRootSet(ThreadData& threadData) noexcept;
 
     Iterator begin() noexcept { return Iterator(Iterator::begin, *this); }
@@ -64,6 +69,7 @@ public:
 private:
     ShadowStack& stack_;
     ThreadLocalStorage& tls_;
+    ObjectArena* arena_;
 };
 
 class GlobalRootSet {
@@ -21,17 +21,3 @@ void mm::ShadowStack::Iterator::Init() noexcept {
         end_ = end();
     }
 }
-
-void mm::ShadowStack::EnterFrame(ObjHeader** start, int parameters, int count) noexcept {
-    FrameOverlay* frame = reinterpret_cast<FrameOverlay*>(start);
-    frame->previous = currentFrame_;
-    currentFrame_ = frame;
-    // TODO: maybe compress in single value somehow.
-    frame->parameters = parameters;
-    frame->count = count;
-}
-
-void mm::ShadowStack::LeaveFrame(ObjHeader** start, int parameters, int count) noexcept {
-    FrameOverlay* frame = reinterpret_cast<FrameOverlay*>(start);
-    currentFrame_ = frame->previous;
-}
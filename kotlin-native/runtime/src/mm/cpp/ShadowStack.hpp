@@ -6,6 +6,8 @@
 #ifndef RUNTIME_MM_SHADOW_STACK
 #define RUNTIME_MM_SHADOW_STACK
 
+#include "Common.h"
+#include "KAssert.h"
 #include "Memory.h"
 #include "Utils.hpp"
 
@@ -51,8 +53,26 @@ public:
         ObjHeader** end_ = nullptr;
     };
 
-    void EnterFrame(ObjHeader** start, int parameters, int count) noexcept;
-    void LeaveFrame(ObjHeader** start, int parameters, int count) noexcept;
+    // These are called in prologues and epilogues of most Kotlin functions, and are inlined into the compiled code
+    // together with `::EnterFrame` and `::LeaveFrame`, so keep them to a few stores.
+    ALWAYS_INLINE void EnterFrame(ObjHeader** start, int parameters, int count) noexcept {
+        FrameOverlay* frame = reinterpret_cast<FrameOverlay*>(start);
+        // `FrameOverlay::arena` is only used by the legacy MM. Keep the owning stack there instead,
+        // so that `LeaveFrame` does not need to look up the current thread.
+        frame->arena = this;
+        frame->previous = currentFrame_;
+        currentFrame_ = frame;
+        // TODO: maybe compress in single value somehow.
+        frame->parameters = parameters;
+        frame->count = count;
+    }
+
+    static ALWAYS_INLINE void LeaveFrame(ObjHeader** start, int parameters, int count) noexcept {
+        FrameOverlay* frame = reinterpret_cast<FrameOverlay*>(start);
+        auto* stack = static_cast<ShadowStack*>(frame->arena);
+        RuntimeAssert(stack->currentFrame_ == frame, "Leaving frame %p, but the current one is %p", frame, stack->currentFrame_);
+        stack->currentFrame_ = frame->previous;
+    }
 
     Iterator begin() noexcept { return Iterator(currentFrame_); }
     Iterator end() noexcept { return Iterator(nullptr); }
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "SoftReferenceRegistry.hpp"
+
+#include "GlobalData.hpp"
+#include "Porting.h"
+
+using namespace kotlin;
+
+namespace {
+
+// Must match the layout of `kotlin.native.ref.SoftReferenceCounter`.
+struct SoftReferenceCounter {
+    ObjHeader header;
+    ObjHeader* referred;
+    KLong lastAccessMillis;
+};
+
+SoftReferenceCounter* asSoftReferenceCounter(ObjHeader* obj) noexcept {
+    return reinterpret_cast<SoftReferenceCounter*>(obj);
+}
+
+} // namespace
+
+void mm::SoftReferenceCounterClear(ObjHeader* counter) noexcept {
+    // Note, that we don't do `SetHeapRef` here, as the reference is not strong.
+    __atomic_store_n(&asSoftReferenceCounter(counter)->referred, nullptr, __ATOMIC_RELEASE);
+}
+
+ObjHeader* mm::SoftReferenceCounterDereference(ObjHeader* counter) noexcept {
+    auto* softCounter = asSoftReferenceCounter(counter);
+    ObjHeader* referred = __atomic_load_n(&softCounter->referred, __ATOMIC_ACQUIRE);
+    if (referred != nullptr) {
+        __atomic_store_n(&softCounter->lastAccessMillis, static_cast<KLong>(konan::getTimeMillis()), __ATOMIC_RELAXED);
+    }
+    return referred;
+}
+
+ObjHeader* mm::SoftReferenceCounterReferred(ObjHeader* counter) noexcept {
+    return __atomic_load_n(&asSoftReferenceCounter(counter)->referred, __ATOMIC_ACQUIRE);
+}
+
+int64_t mm::SoftReferenceCounterLastAccessMillis(ObjHeader* counter) noexcept {
+    return __atomic_load_n(&asSoftReferenceCounter(counter)->lastAccessMillis, __ATOMIC_RELAXED);
+}
+
+// static
+mm::SoftReferenceRegistry& mm::SoftReferenceRegistry::Instance() noexcept {
+    return GlobalData::Instance().softReferenceRegistry();
+}
+
+void mm::SoftReferenceRegistry::RegisterSoftReferenceCounter(ObjHeader* counter) noexcept {
+    std::lock_guard<SpinLock> guard(mutex_);
+    counters_.push_back(counter);
+}
+
+mm::SoftReferenceRegistry::SoftReferenceRegistry() = default;
+mm::SoftReferenceRegistry::~SoftReferenceRegistry() = default;
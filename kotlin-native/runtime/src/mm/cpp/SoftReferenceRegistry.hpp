@@ -0,0 +1,81 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#ifndef RUNTIME_MM_SOFT_REFERENCE_REGISTRY_H
+#define RUNTIME_MM_SOFT_REFERENCE_REGISTRY_H
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+
+#include "Memory.h"
+#include "Mutex.hpp"
+#include "Types.h"
+#include "Utils.hpp"
+
+namespace kotlin {
+namespace mm {
+
+// Atomically clears counter object reference.
+void SoftReferenceCounterClear(ObjHeader* counter) noexcept;
+
+// Returns the object the counter refers to (or `nullptr` if it was cleared) and records the access time.
+ObjHeader* SoftReferenceCounterDereference(ObjHeader* counter) noexcept;
+
+// Returns the object the counter refers to without recording the access.
+ObjHeader* SoftReferenceCounterReferred(ObjHeader* counter) noexcept;
+
+// Time of the last `SoftReferenceCounterDereference` (or of the counter creation) in milliseconds.
+int64_t SoftReferenceCounterLastAccessMillis(ObjHeader* counter) noexcept;
+
+// Registry for all soft reference counters. Unlike `StableRefRegistry` it does not keep the counters alive:
+// the GC is expected to drop the entries for counters (or referents) that did not survive the collection.
+class SoftReferenceRegistry : private Pinned {
+public:
+    class Iterable : private MoveOnly {
+    public:
+        KStdVector<ObjHeader*>::iterator begin() noexcept { return owner_.counters_.begin(); }
+        KStdVector<ObjHeader*>::iterator end() noexcept { return owner_.counters_.end(); }
+
+        // Remove all counters satisfying `predicate`. Does not change the order of the remaining counters.
+        template <typename Predicate>
+        void EraseIf(Predicate predicate) noexcept {
+            auto& counters = owner_.counters_;
+            counters.erase(std::remove_if(counters.begin(), counters.end(), std::move(predicate)), counters.end());
+        }
+
+    private:
+        friend class SoftReferenceRegistry;
+
+        explicit Iterable(SoftReferenceRegistry& owner) noexcept : owner_(owner), guard_(owner_.mutex_) {}
+
+        SoftReferenceRegistry& owner_; // weak
+        std::unique_lock<SpinLock> guard_;
+    };
+
+    SoftReferenceRegistry();
+    ~SoftReferenceRegistry();
+
+    static SoftReferenceRegistry& Instance() noexcept;
+
+    // `counter` must already be installed into the referent's `ExtraObjectData`.
+    void RegisterSoftReferenceCounter(ObjHeader* counter) noexcept;
+
+    // Lock registry for safe iteration.
+    Iterable Iter() noexcept { return Iterable(*this); }
+
+    void ClearForTests() noexcept { counters_.clear(); }
+
+private:
+    // Soft references are expected to be created rarely compared to objects, so a single vector
+    // guarded by a lock is enough.
+    KStdVector<ObjHeader*> counters_;
+    SpinLock mutex_;
+};
+
+} // namespace mm
+} // namespace kotlin
+
+#endif // RUNTIME_MM_SOFT_REFERENCE_REGISTRY_H
@@ -12,7 +12,11 @@
 #include "GlobalData.hpp"
 #include "GlobalsRegistry.hpp"
 #include "GC.hpp"
+#include "KAssert.h"
+#include "ObjectArena.hpp"
 #include "ObjectFactory.hpp"
+#include "Porting.h"
+#include "Scavenger.hpp"
 #include "ShadowStack.hpp"
 #include "StableRefRegistry.hpp"
 #include "ThreadLocalStorage.hpp"
@@ -34,9 +38,43 @@ public:
         stableRefThreadQueue_(StableRefRegistry::Instance()),
         state_(ThreadState::kRunnable),
         gc_(GlobalData::Instance().gc()),
-        objectFactoryThreadQueue_(GlobalData::Instance().objectFactory(), gc_) {}
+        allocatorHeap_(konan::heap_new()),
+        scavengeEpoch_(GetScavengeEpoch()),
+        objectFactoryThreadQueue_(GlobalData::Instance().objectFactory(), gc_, &allocatorHeap_) {}
+
+    // Must be destroyed on the thread it belongs to (because of `allocatorHeap_`), or be detached.
+    ~ThreadData() {
+        while (arena_ != nullptr) {
+            LeaveArena();
+        }
+        // Objects allocated from the heap stay alive.
+        konan::heap_delete(allocatorHeap_);
+    }
+
+    // Releases everything bound to the current thread, so that `ThreadData` can be pooled and
+    // later attached to another thread. Must be called on the thread it belongs to, after it was
+    // published and removed from `ThreadRegistry`, so that the GC never sees it half-detached.
+    void Detach() noexcept {
+        while (arena_ != nullptr) {
+            LeaveArena();
+        }
+        objectFactoryThreadQueue_.ReleaseAllocationBuffer();
+        initializingSingletons_.clear();
+        // Per-thread GC data (counters, allocation budget) starts afresh for the next thread.
+        gc_.Reset();
+        konan::heap_delete(allocatorHeap_);
+        allocatorHeap_ = nullptr;
+    }
 
-    ~ThreadData() = default;
+    // Prepares a detached `ThreadData` to be used by the current thread.
+    void Attach(pthread_t threadId) noexcept {
+        RuntimeAssert(allocatorHeap_ == nullptr, "ThreadData must be detached");
+        threadId_ = threadId;
+        state_ = ThreadState::kRunnable;
+        tls_.Reset();
+        allocatorHeap_ = konan::heap_new();
+        scavengeEpoch_ = GetScavengeEpoch();
+    }
 
     pthread_t threadId() const noexcept { return threadId_; }
 
@@ -58,8 +96,38 @@ public:
 
     gc::GC::ThreadData& gc() noexcept { return gc_; }
 
+    // The innermost arena, or `nullptr` if objects are allocated in the heap.
+    ObjectArena* arena() noexcept { return arena_; }
+
+    // The allocation fast path does not know about arenas: it is kept off while there are any.
+    void EnterArena() noexcept {
+        if (arena_ == nullptr) {
+            objectFactoryThreadQueue_.SuspendAllocationBuffer();
+        }
+        arena_ = new ObjectArena(gc_, arena_);
+    }
+
+    void LeaveArena() noexcept {
+        RuntimeAssert(arena_ != nullptr, "Not in an arena");
+        ObjectArena* arena = arena_;
+        arena_ = arena->parent();
+        delete arena;
+        if (arena_ == nullptr) {
+            objectFactoryThreadQueue_.ResumeAllocationBuffer();
+        }
+    }
+
+    // The scavenger cannot return the memory of `allocatorHeap_` to the OS by itself: the thread does it
+    // at the first safe point after each scavenge. Must be called on the thread `this` belongs to.
+    ALWAYS_INLINE void SafePointScavenge() noexcept {
+        uint64_t epoch = GetScavengeEpoch();
+        if (epoch == scavengeEpoch_) return;
+        scavengeEpoch_ = epoch;
+        konan::heap_collect(allocatorHeap_, true);
+    }
+
     void Publish() noexcept {
-        // TODO: These use separate locks, which is inefficient.
+        // Each of these only splices lists under a lock, and skips the lock when there's nothing to publish.
         globalsThreadQueue_.Publish();
         stableRefThreadQueue_.Publish();
         objectFactoryThreadQueue_.Publish();
@@ -72,15 +140,20 @@ public:
     }
 
 private:
-    const pthread_t threadId_;
+    pthread_t threadId_;
     GlobalsRegistry::ThreadQueue globalsThreadQueue_;
     ThreadLocalStorage tls_;
     StableRefRegistry::ThreadQueue stableRefThreadQueue_;
     std::atomic<ThreadState> state_;
     ShadowStack shadowStack_;
     gc::GC::ThreadData gc_;
+    // Objects of this thread are allocated from it, so that the allocator does not need synchronization.
+    konan::AllocatorHeap* allocatorHeap_;
+    // The last scavenge that `allocatorHeap_` has taken part in.
+    uint64_t scavengeEpoch_;
     ObjectFactory<gc::GC>::ThreadQueue objectFactoryThreadQueue_;
     KStdVector<std::pair<ObjHeader**, ObjHeader*>> initializingSingletons_;
+    ObjectArena* arena_ = nullptr;
 };
 
 } // namespace mm
@@ -32,6 +32,11 @@ void mm::ThreadLocalStorage::Clear() noexcept {
     state_ = State::kCleared;
 }
 
+void mm::ThreadLocalStorage::Reset() noexcept {
+    storage_.clear();
+    state_ = State::kBuilding;
+}
+
 ObjHeader** mm::ThreadLocalStorage::Lookup(Key key, int index) noexcept {
     RuntimeAssert(state_ == State::kCommitted, "Storage must be in the committed state");
     if (lastKeyAndEntry_.first == key) {
@@ -45,6 +45,9 @@ public:
     void Commit() noexcept;
     // Clear storage. Can only be called after `Commit`.
     void Clear() noexcept;
+    // Go back to the building state, keeping the records, so that the storage can be committed again
+    // for another thread. Every thread adds the same records, so doing that again is cheap.
+    void Reset() noexcept;
     // Lookup value in storage. Can only be called after `Commit`.
     ObjHeader** Lookup(Key key, int index) noexcept;
 
@@ -175,3 +175,28 @@ TEST(ThreadLocalStorageTest, LookupCaching) {
     EXPECT_EQ(location2, tls.Lookup(&key2, 0));
     EXPECT_EQ(location1, tls.Lookup(&key1, 0));
 }
+
+TEST(ThreadLocalStorageTest, Reset) {
+    Key key1;
+    Key key2;
+    mm::ThreadLocalStorage tls;
+
+    tls.AddRecord(&key1, 1);
+    tls.AddRecord(&key2, 2);
+    tls.Commit();
+    *tls.Lookup(&key2, 1) = reinterpret_cast<ObjHeader*>(1);
+    tls.Clear();
+
+    tls.Reset();
+    tls.AddRecord(&key1, 1);
+    tls.AddRecord(&key2, 2);
+    tls.Commit();
+
+    KStdVector<ObjHeader*> actual;
+    for (auto item : tls) {
+        actual.push_back(*item);
+    }
+
+    EXPECT_THAT(actual, testing::ElementsAre(nullptr, nullptr, nullptr));
+    EXPECT_NE(tls.Lookup(&key1, 0), tls.Lookup(&key2, 0));
+}
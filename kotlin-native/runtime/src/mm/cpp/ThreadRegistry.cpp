@@ -16,7 +16,19 @@ mm::ThreadRegistry& mm::ThreadRegistry::Instance() noexcept {
 }
 
 mm::ThreadRegistry::Node* mm::ThreadRegistry::RegisterCurrentThread() noexcept {
-    auto* threadDataNode = list_.Emplace(pthread_self());
+    Node* threadDataNode = nullptr;
+    for (auto& slot : pool_) {
+        // Only the thread that empties a slot gets its node, so the same node cannot be taken twice.
+        if (slot.load(std::memory_order_relaxed) == nullptr) continue;
+        threadDataNode = slot.exchange(nullptr, std::memory_order_acquire);
+        if (threadDataNode != nullptr) break;
+    }
+    if (threadDataNode != nullptr) {
+        threadDataNode->Get()->Attach(pthread_self());
+        list_.Insert(threadDataNode);
+    } else {
+        threadDataNode = list_.Emplace(pthread_self());
+    }
     Node*& currentDataNode = currentThreadDataNode_;
     RuntimeAssert(currentDataNode == nullptr, "This thread already had some data assigned to it.");
     currentDataNode = threadDataNode;
@@ -24,7 +36,22 @@ mm::ThreadRegistry::Node* mm::ThreadRegistry::RegisterCurrentThread() noexcept {
 }
 
 void mm::ThreadRegistry::Unregister(Node* threadDataNode) noexcept {
-    list_.Erase(threadDataNode);
+    auto* threadData = threadDataNode->Get();
+    // Stable references and globals of this thread must reach the GC before the thread disappears from `list_`.
+    threadData->Publish();
+    list_.Extract(threadDataNode);
+    threadData->Detach();
+    for (auto& slot : pool_) {
+        Node* expected = nullptr;
+        if (slot.load(std::memory_order_relaxed) == nullptr &&
+            slot.compare_exchange_strong(expected, threadDataNode, std::memory_order_release, std::memory_order_relaxed)) {
+            threadDataNode = nullptr;
+            break;
+        }
+    }
+    if (threadDataNode != nullptr) {
+        SingleLockList<ThreadData>::Destroy(threadDataNode);
+    }
     // Do not touch `currentThreadData_` as TLS may already have been deallocated.
 }
 
@@ -37,7 +64,13 @@ ALWAYS_INLINE mm::ThreadData* mm::ThreadRegistry::CurrentThreadData() const noex
 }
 
 mm::ThreadRegistry::ThreadRegistry() = default;
-mm::ThreadRegistry::~ThreadRegistry() = default;
+mm::ThreadRegistry::~ThreadRegistry() {
+    for (auto& slot : pool_) {
+        if (auto* threadDataNode = slot.load(std::memory_order_relaxed)) {
+            SingleLockList<ThreadData>::Destroy(threadDataNode);
+        }
+    }
+}
 
 // static
 THREAD_LOCAL_VARIABLE mm::ThreadRegistry::Node* mm::ThreadRegistry::currentThreadDataNode_ = nullptr;
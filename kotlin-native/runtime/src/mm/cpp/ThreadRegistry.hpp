@@ -6,6 +6,8 @@
 #ifndef RUNTIME_MM_THREAD_REGISTRY_H
 #define RUNTIME_MM_THREAD_REGISTRY_H
 
+#include <array>
+#include <atomic>
 #include <pthread.h>
 
 #include "Common.h"
@@ -24,9 +26,11 @@ public:
 
     static ThreadRegistry& Instance() noexcept;
 
+    // Reuses a `ThreadData` of some previously unregistered thread if there is one.
     Node* RegisterCurrentThread() noexcept;
 
     // `ThreadData` associated with `threadDataNode` cannot be used after this call.
+    // Must be called on the thread `threadDataNode` belongs to.
     void Unregister(Node* threadDataNode) noexcept;
 
     // Locks `ThreadRegistry` for safe iteration.
@@ -52,6 +56,12 @@ private:
     static THREAD_LOCAL_VARIABLE Node* currentThreadDataNode_;
 
     SingleLockList<ThreadData> list_;
+
+    // Detached `ThreadData`s that are not in `list_`. Native code often calls into Kotlin from short-lived threads,
+    // and recycling saves setting up the whole `ThreadData` on every attach.
+    // Free slots are `nullptr`. Taking a node is an exchange and putting one back is a CAS, so there's no lock.
+    static constexpr size_t kMaxPooledThreadData = 64;
+    std::array<std::atomic<Node*>, kMaxPooledThreadData> pool_{};
 };
 
 } // namespace mm
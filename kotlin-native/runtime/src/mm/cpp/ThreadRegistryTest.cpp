@@ -5,12 +5,14 @@
 
 #include "ThreadRegistry.hpp"
 
+#include <atomic>
 #include <pthread.h>
 #include <thread>
 
 #include "gtest/gtest.h"
 
 #include "ThreadData.hpp"
+#include "Types.h"
 
 using namespace kotlin;
 
@@ -29,3 +31,55 @@ TEST(ThreadRegistryTest, RegisterCurrentThread) {
     });
     t.join();
 }
+
+TEST(ThreadRegistryTest, ReuseThreadData) {
+    mm::ThreadData* previousThreadData = nullptr;
+    for (int i = 0; i < 2; ++i) {
+        std::thread t([&previousThreadData]() {
+            auto* node = mm::ThreadRegistry::Instance().RegisterCurrentThread();
+            auto* threadData = node->Get();
+            EXPECT_EQ(pthread_self(), threadData->threadId());
+            EXPECT_EQ(ThreadState::kRunnable, threadData->state());
+            if (previousThreadData != nullptr) {
+                EXPECT_EQ(previousThreadData, threadData);
+            }
+            threadData->tls().Commit();
+            threadData->setState(ThreadState::kNative);
+            previousThreadData = threadData;
+            mm::ThreadRegistry::Instance().Unregister(node);
+        });
+        t.join();
+    }
+
+    for (auto& threadData : mm::ThreadRegistry::Instance().Iter()) {
+        EXPECT_NE(&threadData, previousThreadData);
+    }
+}
+
+TEST(ThreadRegistryTest, ConcurrentReuseThreadData) {
+    constexpr int kThreadCount = 8;
+    constexpr int kIterations = 100;
+    std::atomic<bool> canStart(false);
+    KStdVector<std::thread> threads;
+    for (int i = 0; i < kThreadCount; ++i) {
+        threads.emplace_back([&canStart]() {
+            while (!canStart.load()) {
+            }
+            for (int j = 0; j < kIterations; ++j) {
+                auto* node = mm::ThreadRegistry::Instance().RegisterCurrentThread();
+                auto* threadData = node->Get();
+                std::this_thread::yield();
+                // Would be overwritten if another thread got the same `ThreadData` from the pool.
+                EXPECT_EQ(pthread_self(), threadData->threadId());
+                threadData->tls().Commit();
+                threadData->setState(ThreadState::kNative);
+                mm::ThreadRegistry::Instance().Unregister(node);
+                mm::ThreadRegistry::TestSupport::ClearCurrentThreadData();
+            }
+        });
+    }
+    canStart = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
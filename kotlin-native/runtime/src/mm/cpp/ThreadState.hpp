@@ -35,10 +35,15 @@ ALWAYS_INLINE inline ThreadState SwitchThreadState(mm::ThreadData* threadData, T
 
 // Asserts that the given thread is in the given state.
 ALWAYS_INLINE inline void AssertThreadState(mm::ThreadData* threadData, ThreadState expected) noexcept {
+#if KONAN_ENABLE_ASSERT
+    // This is on the hottest paths (e.g. `EnterFrame`), and the optimizer keeps the atomic load of the state
+    // even if the assert itself is dead. So check `KonanNeedDebugInfo` before touching the state.
+    if (!KonanNeedDebugInfo) return;
     auto actual = threadData->state();
     RuntimeAssert(actual == expected,
                   "Unexpected thread state. Expected: %s. Actual: %s.",
                   internal::stateToString(expected), internal::stateToString(actual));
+#endif
 }
 
 } // namespace kotlin
@@ -7,8 +7,20 @@
 
 extern "C" {
 void* mi_calloc(size_t, size_t);
+void* mi_malloc(size_t);
+void* mi_malloc_aligned(size_t size, size_t alignment);
 void mi_free(void*);
+void mi_free_batch(void** p, size_t count);
+size_t mi_usable_size(const void* p);
 void* mi_calloc_aligned(size_t count, size_t size, size_t alignment);
+void mi_collect(bool force);
+struct mi_heap_s;
+mi_heap_s* mi_heap_new();
+void mi_heap_delete(mi_heap_s* heap);
+void* mi_heap_calloc_aligned(mi_heap_s* heap, size_t count, size_t size, size_t alignment);
+void* mi_heap_malloc_aligned(mi_heap_s* heap, size_t size, size_t alignment);
+void mi_heap_collect(mi_heap_s* heap, bool force);
+size_t mi_committed_unreset();
 
 void* konan_calloc_impl(size_t n_elements, size_t elem_size) {
  return mi_calloc(n_elements, elem_size);
@@ -18,7 +30,57 @@ void* konan_calloc_aligned_impl(size_t count, size_t size, size_t alignment) {
   return mi_calloc_aligned(count, size, alignment);
 }
 
+void* konan_malloc_impl(size_t size) {
+  return mi_malloc(size);
+}
+
+void* konan_malloc_aligned_impl(size_t size, size_t alignment) {
+  return mi_malloc_aligned(size, alignment);
+}
+
+bool konan_aligned_alloc_supported_impl() {
+  return true;
+}
+
 void konan_free_impl (void* mem) {
   mi_free(mem);
 }
+
+void konan_free_batch_impl(void** mems, size_t count) {
+  mi_free_batch(mems, count);
+}
+
+size_t konan_malloc_usable_size_impl(void* mem) {
+  return mi_usable_size(mem);
+}
+
+void* konan_heap_new_impl() {
+  return mi_heap_new();
+}
+
+void konan_heap_delete_impl(void* heap) {
+  // Live blocks are moved to the backing heap of the current thread.
+  mi_heap_delete(static_cast<mi_heap_s*>(heap));
+}
+
+void* konan_heap_calloc_aligned_impl(void* heap, size_t count, size_t size, size_t alignment) {
+  return mi_heap_calloc_aligned(static_cast<mi_heap_s*>(heap), count, size, alignment);
+}
+
+void* konan_heap_malloc_aligned_impl(void* heap, size_t size, size_t alignment) {
+  return mi_heap_malloc_aligned(static_cast<mi_heap_s*>(heap), size, alignment);
+}
+
+void konan_heap_collect_impl(void* heap, bool force) {
+  mi_heap_collect(static_cast<mi_heap_s*>(heap), force);
+}
+
+void konan_release_free_memory_impl() {
+  mi_collect(true);
+}
+
+size_t konan_committed_memory_bytes_impl() {
+  // Pages that mimalloc has reset are still committed, but the OS may reclaim them at any time.
+  return mi_committed_unreset();
+}
 }  // extern "C"
@@ -19,6 +19,10 @@ OBJ_GETTER(AllocArrayInstance, const TypeInfo* typeInfo, int32_t elements) {
   RETURN_RESULT_OF(AllocArrayInstanceRelaxed, typeInfo, elements);
 }
 
+OBJ_GETTER(AllocArrayInstanceUninitialized, const TypeInfo* typeInfo, int32_t elements) {
+  RETURN_RESULT_OF(AllocArrayInstanceUninitializedRelaxed, typeInfo, elements);
+}
+
 OBJ_GETTER(InitThreadLocalSingleton, ObjHeader** location, const TypeInfo* typeInfo, void (*ctor)(ObjHeader*)) {
     RETURN_RESULT_OF(InitThreadLocalSingletonRelaxed, location, typeInfo, ctor);
 }
@@ -4,6 +4,42 @@
  */
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#if defined(__GLIBC__) || defined(_WIN32)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#endif
+
+namespace {
+
+// Blocks must be freeable with `free`, which rules out `_aligned_malloc` on Windows.
+#if defined(_WIN32)
+constexpr bool kAlignedAllocSupported = false;
+
+void* mallocAligned(size_t size, size_t alignment) {
+  return malloc(size);
+}
+#else
+constexpr bool kAlignedAllocSupported = true;
+
+void* mallocAligned(size_t size, size_t alignment) {
+  if (alignment < sizeof(void*)) alignment = sizeof(void*);
+  void* result = nullptr;
+  if (posix_memalign(&result, alignment, size) != 0) return nullptr;
+  return result;
+}
+#endif
+
+void* callocAligned(size_t count, size_t size, size_t alignment) {
+  if (!kAlignedAllocSupported) return calloc(count, size);
+  if (size != 0 && count > static_cast<size_t>(-1) / size) return nullptr;
+  void* result = mallocAligned(count * size, alignment);
+  if (result != nullptr) memset(result, 0, count * size);
+  return result;
+}
+
+} // namespace
 
 extern "C" {
 // Memory operations.
@@ -12,12 +48,73 @@ void* konan_calloc_impl(size_t n_elements, size_t elem_size) {
 }
 
 void* konan_calloc_aligned_impl(size_t count, size_t size, size_t alignment) {
-  // alignment is not supported by std alloc - use mimalloc
-  return calloc(count, size);
+  return callocAligned(count, size, alignment);
+}
+
+bool konan_aligned_alloc_supported_impl() {
+  return kAlignedAllocSupported;
+}
+
+void* konan_malloc_impl(size_t size) {
+  return malloc(size);
+}
+
+void* konan_malloc_aligned_impl(size_t size, size_t alignment) {
+  return mallocAligned(size, alignment);
 }
 
 void konan_free_impl (void* mem) {
   free(mem);
 }
+
+void konan_free_batch_impl(void** mems, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    free(mems[i]);
+  }
+}
+
+size_t konan_malloc_usable_size_impl(void* mem) {
+#if defined(__GLIBC__)
+  return malloc_usable_size(mem);
+#elif defined(__APPLE__)
+  return malloc_size(mem);
+#elif defined(_WIN32)
+  return _msize(mem);
+#else
+  return 0;
+#endif
+}
+
+// Heaps are not supported by std alloc: `nullptr` heap makes `konan::heap_calloc_aligned` use `konan::calloc_aligned`.
+void* konan_heap_new_impl() {
+  return nullptr;
+}
+
+void konan_heap_delete_impl(void* heap) {}
+
+void* konan_heap_calloc_aligned_impl(void* heap, size_t count, size_t size, size_t alignment) {
+  return callocAligned(count, size, alignment);
+}
+
+void* konan_heap_malloc_aligned_impl(void* heap, size_t size, size_t alignment) {
+  return mallocAligned(size, alignment);
+}
+
+void konan_heap_collect_impl(void* heap, bool force) {}
+
+void konan_release_free_memory_impl() {
+#if defined(__GLIBC__)
+  malloc_trim(0);
+#endif
+}
+
+size_t konan_committed_memory_bytes_impl() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+  struct mallinfo2 info = mallinfo2();
+  return info.arena + info.hblkhd;
+#else
+  return 0;
+#endif
+}
 }
 
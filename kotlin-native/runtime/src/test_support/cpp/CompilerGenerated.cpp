@@ -97,6 +97,14 @@ RUNTIME_NORETURN OBJ_GETTER(makeObjCWeakReferenceImpl, void*) {
     throw std::runtime_error("Not implemented for tests");
 }
 
+RUNTIME_NORETURN OBJ_GETTER(makeSoftReferenceCounter, void*) {
+    throw std::runtime_error("Not implemented for tests");
+}
+
+RUNTIME_NORETURN OBJ_GETTER(makeStrongSoftReferenceImpl, ObjHeader*) {
+    throw std::runtime_error("Not implemented for tests");
+}
+
 void checkRangeIndexes(KInt from, KInt to, KInt size) {
     if (from < 0 || to > size) {
         throw std::out_of_range("Index out of bounds: from=" + std::to_string(from)
@@ -112,6 +120,14 @@ RUNTIME_NORETURN OBJ_GETTER(WorkerLaunchpad, KRef) {
     throw std::runtime_error("Not implemented for tests");
 }
 
+RUNTIME_NORETURN OBJ_GETTER(WorkerBatchLaunchpad, KRef, KInt) {
+    throw std::runtime_error("Not implemented for tests");
+}
+
+RUNTIME_NORETURN OBJ_GETTER(WorkerLambdaJobLaunchpad, KRef) {
+    throw std::runtime_error("Not implemented for tests");
+}
+
 void RUNTIME_NORETURN ThrowWorkerInvalidState() {
     throw std::runtime_error("Not implemented for tests");
 }
@@ -188,6 +204,8 @@ void Kotlin_WorkerBoundReference_freezeHook(KRef thiz) {
     throw std::runtime_error("Not implemented for tests");
 }
 
+void Kotlin_runShutdownHooks() {}
+
 extern const KBoolean BOOLEAN_RANGE_FROM = false;
 extern const KBoolean BOOLEAN_RANGE_TO = true;
 extern KBox<KBoolean> BOOLEAN_CACHE[] = {